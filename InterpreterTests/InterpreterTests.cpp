@@ -327,5 +327,1266 @@ namespace InterpreterTests
 
 			Assert::IsTrue(outputStream.str() == expectedOutputStream.str());
 		}
+
+		TEST_METHOD(VirtualMachineWholeProgram)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"read b",
+				"c = b - 1",
+				"D[x] = (x + 4) * 2 / b + c",
+				"E[y] = D[y] % 4 - y",
+				"print c",
+				"print D[a + 5]",
+				"print E[D[1]]"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			Bytecode bytecode = BytecodeCompiler::compile(treeRoot);
+
+			Executor::deleteTree(treeRoot);
+
+			std::ostringstream outputStream;
+			std::istringstream inputStream("7");
+
+			VirtualMachine::execute(bytecode, outputStream, inputStream);
+
+			std::ostringstream expectedOutputStream;
+			expectedOutputStream << "6" << std::endl << "9" << std::endl << "-6" << std::endl;
+
+			Assert::IsTrue(outputStream.str() == expectedOutputStream.str());
+		}
+
+		TEST_METHOD(VirtualMachineUndefinedFunction)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"print F[a]",
+				"F[x] = x"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			Bytecode bytecode = BytecodeCompiler::compile(treeRoot);
+
+			Executor::deleteTree(treeRoot);
+
+			std::ostringstream outputStream;
+			std::istringstream inputStream;
+
+			Assert::ExpectException<std::invalid_argument>([&bytecode, &outputStream, &inputStream]
+			{
+				VirtualMachine::execute(bytecode, outputStream, inputStream);
+			});
+		}
+
+		TEST_METHOD(ClosureExecutorWholeProgram)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"read b",
+				"c = b - 1",
+				"D[x] = (x + 4) * 2 / b + c",
+				"E[y] = D[y] % 4 - y",
+				"print c",
+				"print D[a + 5]",
+				"print E[D[1]]"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			ClosureProgram program = ClosureExecutor::compile(treeRoot);
+
+			Executor::deleteTree(treeRoot);
+
+			std::ostringstream outputStream;
+			std::istringstream inputStream("7");
+
+			ClosureExecutor::execute(program, outputStream, inputStream);
+
+			std::ostringstream expectedOutputStream;
+			expectedOutputStream << "6" << std::endl << "9" << std::endl << "-6" << std::endl;
+
+			Assert::IsTrue(outputStream.str() == expectedOutputStream.str());
+		}
+
+		TEST_METHOD(ClosureExecutorUndefinedVariable)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"print a",
+				"print a + b"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			ClosureProgram program = ClosureExecutor::compile(treeRoot);
+
+			Executor::deleteTree(treeRoot);
+
+			std::ostringstream outputStream;
+			std::istringstream inputStream;
+
+			Assert::ExpectException<std::invalid_argument>([&program, &outputStream, &inputStream]
+			{
+				ClosureExecutor::execute(program, outputStream, inputStream);
+			});
+
+			Assert::IsTrue(outputStream.str() == "2\n");
+		}
+
+		TEST_METHOD(JitWholeProgram)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"read b",
+				"c = b - 1",
+				"D[x] = (x + 4) * 2 / b + c",
+				"E[y] = D[y] % 4 - y",
+				"print c",
+				"print D[a + 5]",
+				"print E[D[1]]"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			JitProgram program;
+			bool isCompiled = JitCompiler::compile(treeRoot, program);
+
+			Executor::deleteTree(treeRoot);
+
+			Assert::IsTrue(isCompiled == JitCompiler::isAvailable());
+
+			if (isCompiled)
+			{
+				std::ostringstream outputStream;
+				std::istringstream inputStream("7");
+
+				JitCompiler::execute(program, outputStream, inputStream);
+
+				std::ostringstream expectedOutputStream;
+				expectedOutputStream << "6" << std::endl << "9" << std::endl << "-6" << std::endl;
+
+				Assert::IsTrue(outputStream.str() == expectedOutputStream.str());
+			}
+		}
+
+		TEST_METHOD(JitFallbackOnRuntimeErrors)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"print F[a]",
+				"F[x] = x + b"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			JitProgram program;
+			bool isCompiled = JitCompiler::compile(treeRoot, program);
+
+			Executor::deleteTree(treeRoot);
+
+			Assert::IsFalse(isCompiled);
+		}
+
+		TEST_METHOD(TranspileWholeProgram)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"read b",
+				"D[x] = (x + 4) * 2 / b + a",
+				"print D[a + 5]"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			std::string source = Transpiler::transpile(treeRoot);
+
+			Executor::deleteTree(treeRoot);
+
+			Assert::IsTrue(source.find("static inline long long f_D(long long p, long long v_a, long long v_b)") != std::string::npos);
+			Assert::IsTrue(source.find("return ((((p + 4LL) * 2LL) / v_b) + v_a);") != std::string::npos);
+			Assert::IsTrue(source.find("if (read_number(&v_b)) goto invalid_input;") != std::string::npos);
+			Assert::IsTrue(source.find("printf(\"%lld\\n\", f_D((v_a + 5LL), v_a, v_b));") != std::string::npos);
+		}
+
+		TEST_METHOD(TranspileRejectsRuntimeErrors)
+		{
+			std::vector<std::string> lines
+			{
+				"print a",
+				"a = 1"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			Assert::ExpectException<std::invalid_argument>([&treeRoot]
+			{
+				Transpiler::transpile(treeRoot);
+			});
+
+			Executor::deleteTree(treeRoot);
+		}
+
+		TEST_METHOD(TieredExecutorPromotesHotCode)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"read b",
+				"c = b - 1",
+				"D[x] = (x + 4) * 2 / b + c",
+				"E[y] = D[y] % 4 - y",
+				"print c",
+				"print D[a + 5]",
+				"print E[D[1]] + E[2] + E[3]"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			TieredExecutor executor(treeRoot, 4, 2);
+
+			std::ostringstream expectedOutputStream;
+			expectedOutputStream << "6" << std::endl << "9" << std::endl << "-8" << std::endl;
+
+			for (int run = 0; run < 3; run++)
+			{
+				std::ostringstream outputStream;
+				std::istringstream inputStream("7");
+
+				executor.execute(outputStream, inputStream);
+
+				Assert::IsTrue(outputStream.str() == expectedOutputStream.str());
+			}
+
+			Executor::deleteTree(treeRoot);
+
+			const TieredStats& stats = executor.getStats();
+			Assert::IsTrue(stats.runs == 3);
+			Assert::IsTrue(stats.interpretedStatements == 16);
+			Assert::IsTrue(stats.compiledStatements == 8);
+			Assert::IsTrue(stats.promotions.size() == 10);
+			Assert::IsTrue(stats.promotions[0].name == "function D");
+		}
+
+		TEST_METHOD(ResolverAssignsSlots)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"F[x] = x + a",
+				"b = F[a]",
+				"print b"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			SymbolTable symbols = Resolver::resolve(treeRoot);
+
+			Assert::IsTrue(symbols.globalCount == 2);
+			Assert::IsTrue(symbols.variables[0] == "a");
+			Assert::IsTrue(symbols.variables[1] == "b");
+			Assert::IsTrue(symbols.variables[symbols.getParameterSlot(0)] == "x");
+			Assert::IsTrue(symbols.functions[0] == "F");
+
+			const Node& functionBody = (*(*treeRoot.children)[1].children)[1];
+			Assert::IsTrue((*functionBody.children)[0].slot == symbols.getParameterSlot(0));
+			Assert::IsTrue((*functionBody.children)[1].slot == 0);
+
+			std::ostringstream outputStream;
+			Executor::execute(treeRoot, outputStream, std::cin);
+
+			Assert::IsTrue(outputStream.str() == "4\n");
+		}
+
+		TEST_METHOD(CompilerBuildsArenaAst)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"D[x] = (x + 4) * a",
+				"print D[a] % 5"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Ast ast = Compiler::compileAst(tokens);
+
+			Assert::IsTrue(ast.nodes[ast.root].type == NodeType::root);
+			Assert::IsTrue(ast.nodes[ast.root].childCount == 3);
+			Assert::IsTrue(ast.variables.size() == 2);
+			Assert::IsTrue(ast.functions.size() == 1);
+
+			// Children are stored before their parents
+			for (int i = 0; i < ast.nodes.size(); i++)
+			{
+				for (int j = 0; j < ast.nodes[i].childCount; j++)
+				{
+					Assert::IsTrue(ast.getChild(i, j) < i);
+				}
+			}
+
+			int definition = ast.getChild(ast.root, 1);
+			Assert::IsTrue(ast.nodes[definition].type == NodeType::define_function);
+			Assert::IsTrue(ast.functions[ast.nodes[definition].value] == "D");
+
+			int multiplication = ast.getChild(definition, 1);
+			Assert::IsTrue(ast.nodes[multiplication].type == NodeType::operation_multipy);
+			Assert::IsTrue(ast.nodes[ast.getChild(ast.getChild(multiplication, 0), 1)].type == NodeType::number);
+			Assert::IsTrue(ast.nodes[ast.getChild(ast.getChild(multiplication, 0), 1)].value == 4);
+
+			std::ostringstream outputStream;
+			VirtualMachine::execute(BytecodeCompiler::compile(ast), outputStream, std::cin);
+
+			Assert::IsTrue(outputStream.str() == "2\n");
+		}
+
+		TEST_METHOD(ConstantFolderSimplifiesExpressions)
+		{
+			std::vector<std::string> lines
+			{
+				"read b",
+				"c = b * 1 + 0",
+				"d = (3 + 4) * 2",
+				"e = b - b",
+				"G[x] = (x + 1) + 2",
+				"print G[c] + d + e",
+				"print 7 / 0 + a - a"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Ast ast = Compiler::compileAst(tokens);
+
+			// b * 1 + 0 -> b, (3 + 4) * 2 -> 14, b - b -> 0, (x + 1) + 2 -> x + 3
+			Assert::IsTrue(ConstantFolder::fold(ast) == 12);
+
+			int assignment = ast.getChild(ast.root, 2);
+			Assert::IsTrue(ast.nodes[ast.getChild(assignment, 1)].type == NodeType::number);
+			Assert::IsTrue(ast.nodes[ast.getChild(assignment, 1)].value == 14);
+
+			// The division by zero and the undefined variable are kept, so they still fail when they are reached
+			int lastPrint = ast.getChild(ast.root, 6);
+			Assert::IsTrue(ast.nodes[ast.getChild(lastPrint, 0)].type == NodeType::operation_subtract);
+
+			std::ostringstream outputStream;
+			std::istringstream inputStream("5");
+
+			ClosureProgram program = ClosureExecutor::compile(ast);
+			program.statements.pop_back();
+			ClosureExecutor::execute(program, outputStream, inputStream);
+
+			Assert::IsTrue(outputStream.str() == "22\n");
+		}
+
+		TEST_METHOD(InlinerExpandsNestedCalls)
+		{
+			std::vector<std::string> lines
+			{
+				"y = 10",
+				"F[x] = x + y",
+				"G[y] = F[y * 2]",
+				"H[z] = F[F[z]] * 2",
+				"print H[3]",
+				"print G[1]"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Ast ast = Compiler::compileAst(tokens);
+
+			// F can't be expanded in G, because F reads the global y and G has a parameter y
+			Assert::IsTrue(Inliner::inlineCalls(ast) == 4);
+
+			int functionCalls = 0;
+			for (const AstNode& node : ast.nodes)
+			{
+				functionCalls += node.type == NodeType::function ? 1 : 0;
+			}
+			Assert::IsTrue(functionCalls == 2);
+
+			std::ostringstream outputStream;
+			ClosureExecutor::execute(ClosureExecutor::compile(ast), outputStream, std::cin);
+
+			Assert::IsTrue(outputStream.str() == "46\n12\n");
+		}
+
+		TEST_METHOD(FunctionCacheReusesResults)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 1",
+				"b = 5",
+				"c = 7",
+				"D[x] = a + 2 * b % x",
+				"E[y] = D[y] * 2",
+				"print E[3] + E[3] + D[3]",
+				"c = 8",
+				"print E[3]",
+				"b = 4",
+				"print E[3]"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Node treeRoot = Compiler::compile(tokens);
+
+			FunctionCache cache;
+
+			std::ostringstream outputStream;
+			Executor::execute(treeRoot, outputStream, std::cin, &cache);
+
+			Assert::IsTrue(outputStream.str() == "10\n4\n6\n");
+
+			// c is not read by the functions, so only the assignment of b makes the results invalid
+			Assert::IsTrue(cache.getMisses() == 4);
+			Assert::IsTrue(cache.getHits() == 3);
+
+			Executor::deleteTree(treeRoot);
+		}
+
+		TEST_METHOD(DeadCodeEliminatorRemovesUnusedStatements)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 5",
+				"b = 7",
+				"b = a * 2",
+				"c = 3",
+				"F[x] = x + 1",
+				"G[x] = x * a",
+				"print G[b]",
+				"d = 1 / b"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Ast ast = Compiler::compileAst(tokens);
+
+			// The division by a variable can fail, so only the first store to b, the store to c and F are removed
+			Assert::IsTrue(DeadCodeEliminator::eliminate(ast) == 3);
+			Assert::IsTrue(ast.nodes[ast.root].childCount == 5);
+
+			std::ostringstream outputStream;
+			VirtualMachine::execute(BytecodeCompiler::compile(ast), outputStream, std::cin);
+
+			Assert::IsTrue(outputStream.str() == "50\n");
+		}
+
+		TEST_METHOD(CommonSubexpressionEliminatorSharesRepeatedExpressions)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 2",
+				"b = 3",
+				"print (a + b) * (a - b) + 1",
+				"print (a + b) * (a - b) + 2",
+				"b = 4",
+				"print (a + b) * (a - b)"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Ast ast = Compiler::compileAst(tokens);
+
+			// The product is computed once for the first two prints, the assignment of b starts a new range
+			Assert::IsTrue(CommonSubexpressionEliminator::eliminate(ast) == 1);
+
+			// a, b, + and - are stored once, so each of them has a single node
+			int additions = 0;
+			for (const AstNode& node : ast.nodes)
+			{
+				additions += node.type == NodeType::operation_add && ast.nodes[ast.childIndices[node.firstChild + 1]].type == NodeType::variable ? 1 : 0;
+			}
+			Assert::IsTrue(additions == 1);
+
+			std::ostringstream outputStream;
+			VirtualMachine::execute(BytecodeCompiler::compile(ast), outputStream, std::cin);
+
+			Assert::IsTrue(outputStream.str() == "-4\n-3\n-12\n");
+		}
+
+		TEST_METHOD(DivisionByConstantTruncatesTowardZero)
+		{
+			std::vector<long long> divisors{ 2, 3, 7, 10, 16, -4, -7, 1000000007, 9223372036854775807 };
+			std::vector<long long> dividends{ 0, 1, -1, 13, -13, 100, -100, 9223372036854775807, -9223372036854775807 - 1 };
+
+			for (long long divisor : divisors)
+			{
+				DivisionByConstant division(divisor);
+				for (long long dividend : dividends)
+				{
+					Assert::IsTrue(division.divide(dividend) == dividend / divisor);
+					Assert::IsTrue(division.modulo(dividend) == dividend % divisor);
+				}
+			}
+
+			std::vector<std::string> lines
+			{
+				"read n",
+				"print n / 10",
+				"print n % 7",
+				"print n / 8",
+				"print n % 8"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			std::istringstream inputStream("-125");
+			std::ostringstream outputStream;
+			VirtualMachine::execute(BytecodeCompiler::compile(Compiler::compileAst(tokens)), outputStream, inputStream);
+
+			Assert::IsTrue(outputStream.str() == "-12\n-6\n-15\n-5\n");
+		}
+
+		TEST_METHOD(IrPassesPropagateStoredConstants)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 5",
+				"b = a * 2",
+				"read c",
+				"print b + a + c",
+				"print c + c"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			IrProgram program = IrBuilder::build(Compiler::compileAst(tokens));
+
+			PassManager<IrProgram> passes([](const IrProgram& program) { program.verify(); });
+			passes.addPass("forward", "loads forwarded", IrPasses::forwardStores);
+			passes.addPass("fold", "operations folded", IrPasses::foldConstants);
+			passes.addPass("dce", "values eliminated", IrPasses::eliminateDeadValues);
+			passes.run(program);
+
+			// Every load reads a stored or read value, so a * 2 and b + a become constants
+			Assert::IsTrue(passes.getResults().size() == 3);
+			Assert::IsTrue(passes.getResults()[0].changes == 6);
+			Assert::IsTrue(passes.getResults()[1].changes == 2);
+
+			std::istringstream inputStream("4");
+			std::ostringstream outputStream;
+			VirtualMachine::execute(BytecodeCompiler::compile(IrBuilder::lower(program)), outputStream, inputStream);
+
+			Assert::IsTrue(outputStream.str() == "19\n8\n");
+
+			// A value used before it is defined is reported by the verifier
+			program.main.instructions[0].arguments[0] = 3;
+			program.main.instructions[0].argumentCount = 1;
+			bool isRejected = false;
+			try
+			{
+				program.verify();
+			}
+			catch (const std::invalid_argument&)
+			{
+				isRejected = true;
+			}
+			Assert::IsTrue(isRejected);
+		}
+
+		TEST_METHOD(PartialEvaluatorComputesKnownInputs)
+		{
+			std::vector<std::string> lines
+			{
+				"read n",
+				"read m",
+				"SQ[x] = x * x",
+				"k = SQ[n] + 1",
+				"print k * m",
+				"print SQ[k] / n"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Ast ast = Compiler::compileAst(tokens);
+
+			// n is known, so k, the k in k * m and the whole last print are computed
+			Assert::IsTrue(PartialEvaluator::specialize(ast, { 3 }) == 3);
+
+			int reads = 0;
+			for (const AstNode& node : ast.nodes)
+			{
+				reads += node.type == NodeType::operation_read ? 1 : 0;
+			}
+			Assert::IsTrue(reads == 1);
+
+			// The residual program reads only m and prints the same as the original
+			std::istringstream inputStream("5");
+			std::ostringstream outputStream;
+			VirtualMachine::execute(BytecodeCompiler::compile(ast), outputStream, inputStream);
+
+			Assert::IsTrue(outputStream.str() == "50\n33\n");
+		}
+
+		TEST_METHOD(BatchRunnerComputesInvariantStatementsOnce)
+		{
+			std::vector<std::string> lines
+			{
+				"a = 6 * 7",
+				"read n",
+				"print a + n",
+				"print a"
+			};
+
+			std::vector<Token> tokens = Tokenizer::tokenize(lines);
+
+			Ast ast = Compiler::compileAst(tokens);
+
+			// a doesn't depend on the input, so it is computed before the sets are executed
+			Assert::IsTrue(PartialEvaluator::specialize(ast, {}) == 3);
+
+			// Every set gets its own run, an invalid set ends only its own run
+			std::istringstream inputStream("1\n2\nx\n");
+			std::ostringstream outputStream;
+			Assert::IsTrue(BatchRunner::run(ast, "vm", inputStream, outputStream) == 3);
+
+			Assert::IsTrue(outputStream.str() == "43\n42\n44\n42\nInvalid number is entered\n");
+		}
+
+		TEST_METHOD(TokenizerTokenizesWholeText)
+		{
+			std::vector<std::string> lines
+			{
+				"read  abc",
+				"print FOO[12]%x ",
+				""
+			};
+
+			std::vector<Token> lineTokens = Tokenizer::tokenize(lines);
+			std::vector<Token> textTokens = Tokenizer::tokenizeText("read  abc\nprint FOO[12]%x \n\n");
+
+			Assert::IsTrue(lineTokens.size() == 12);
+			Assert::IsTrue(textTokens.size() == lineTokens.size());
+			for (int i = 0; i < lineTokens.size(); i++)
+			{
+				Assert::IsTrue(textTokens[i].type == lineTokens[i].type);
+				Assert::IsTrue(textTokens[i].value == lineTokens[i].value);
+				Assert::IsTrue(textTokens[i].line == lineTokens[i].line);
+				Assert::IsTrue(textTokens[i].column == lineTokens[i].column);
+			}
+
+			// The positions are the same as when the lines were split by spaces
+			Assert::IsTrue(lineTokens[1].column == 7);
+			Assert::IsTrue(lineTokens[2].type == TokenType::end_of_line && lineTokens[2].column == 11);
+			Assert::IsTrue(lineTokens[7].type == TokenType::right_bracket && lineTokens[7].column == 13);
+			Assert::IsTrue(lineTokens[10].type == TokenType::end_of_line && lineTokens[10].column == 17);
+			Assert::IsTrue(lineTokens[11].line == 3 && lineTokens[11].column == 1);
+		}
+
+		TEST_METHOD(CharacterScannerMatchesScalarTokenizer)
+		{
+			std::string text = "read abcdefghijklmnopqrstuvwxyzabcdefghij\nprint FUNCTIONNAMEFUNCTIONNAMEFUNCTIONNAME[12345678901234567890123456789012345]\n"
+				"x =                                        y%z\n";
+
+			ScanLevel supportedLevel = CharacterScanner::getSupportedLevel();
+
+			CharacterScanner::setLevel(ScanLevel::scalar);
+			std::vector<Token> scalarTokens = Tokenizer::tokenizeText(text);
+			Assert::IsTrue(CharacterScanner::getLevel() == ScanLevel::scalar);
+
+			// Every instruction set the CPU supports gives the same tokens as the scalar scanner
+			for (ScanLevel level : { ScanLevel::sse2, ScanLevel::avx2 })
+			{
+				CharacterScanner::setLevel(level);
+				std::vector<Token> tokens = Tokenizer::tokenizeText(text);
+
+				Assert::IsTrue(tokens.size() == scalarTokens.size());
+				for (int i = 0; i < tokens.size(); i++)
+				{
+					Assert::IsTrue(tokens[i].type == scalarTokens[i].type);
+					Assert::IsTrue(tokens[i].value == scalarTokens[i].value);
+					Assert::IsTrue(tokens[i].column == scalarTokens[i].column);
+				}
+			}
+
+			CharacterScanner::setLevel(supportedLevel);
+
+			Assert::IsTrue(scalarTokens.size() == 15);
+			Assert::IsTrue(scalarTokens[1].value.size() == 36);
+			Assert::IsTrue(scalarTokens[6].value.size() == 35);
+			Assert::IsTrue(scalarTokens[11].type == TokenType::variable && scalarTokens[11].column == 44);
+		}
+
+		TEST_METHOD(TokenBufferInternsNamesAndParsesNumbers)
+		{
+			TokenBuffer tokens = Tokenizer::tokenizeBuffer("F[x] = x + 1\nabc = 12\nprint abc + F[007]\n");
+
+			Assert::IsTrue(tokens.size() == 21);
+			Assert::IsTrue(tokens.names.size() == 3);
+			Assert::IsTrue(tokens.values[9] == tokens.values[14]);
+			Assert::IsTrue(tokens.getName(16) == "F");
+			Assert::IsTrue(tokens.numbers.size() == 3 && tokens.numbers[tokens.values[18]] == 7);
+
+			// The lines and the columns come from the offsets and the line table
+			Assert::IsTrue(tokens.getLine(14) == 3 && tokens.getColumn(14) == 7);
+			Assert::IsTrue(tokens.getValue(18) == "007");
+
+			// The compiler works on the buffer directly and builds the same program as from the token vector
+			std::ostringstream bufferOutput;
+			VirtualMachine::execute(BytecodeCompiler::compile(Compiler::compileAst(tokens)), bufferOutput, std::cin);
+
+			std::ostringstream vectorOutput;
+			VirtualMachine::execute(BytecodeCompiler::compile(Compiler::compileAst(tokens.toTokens())), vectorOutput, std::cin);
+
+			Assert::IsTrue(bufferOutput.str() == "20\n");
+			Assert::IsTrue(vectorOutput.str() == bufferOutput.str());
+		}
+
+		TEST_METHOD(ReaderMapsSourceFile)
+		{
+			{
+				// The file is written as binary, so it has no "\r\n" line endings (those are read as a stream)
+				std::ofstream file("reader_source_test.txt", std::ios::out | std::ios::binary);
+				file << "a = 2\n\nprint a * 3\n";
+			}
+
+			std::shared_ptr<const SourceText> source = Reader::readSource("reader_source_test.txt");
+			std::remove("reader_source_test.txt");
+
+			// A regular file is mapped, a '\n' at the end doesn't start a new line
+			Assert::IsTrue(source->isMapped());
+			Assert::IsTrue(source->size() == 19);
+			Assert::IsTrue(source->getLineStarts() == std::vector<unsigned int>({ 0, 6, 7 }));
+
+			// The tokens point into the mapped text
+			TokenBuffer tokens = Tokenizer::tokenizeBuffer(source);
+			Assert::IsTrue(tokens.source->data() == source->data());
+
+			std::ostringstream outputStream;
+			VirtualMachine::execute(BytecodeCompiler::compile(Compiler::compileAst(tokens)), outputStream, std::cin);
+
+			Assert::IsTrue(outputStream.str() == "6\n");
+		}
+
+		TEST_METHOD(StreamExecutorExecutesLineByLine)
+		{
+			std::istringstream programStream("read a\nF[x] = x * a\nprint F[3]\na = 10\nprint F[a]\n");
+			std::istringstream inputStream("2");
+			std::ostringstream outputStream;
+
+			Assert::IsTrue(StreamExecutor::execute(programStream, outputStream, inputStream) == 5);
+			Assert::IsTrue(outputStream.str() == "6\n100\n");
+
+			// The lines before a syntax error are executed, the error has the line number in the file
+			StreamExecutor executor(outputStream, inputStream);
+			executor.executeLine("b = 4");
+			executor.executeLine("print b");
+
+			bool isRejected = false;
+			try
+			{
+				executor.executeLine("print b +");
+			}
+			catch (const std::invalid_argument& ex)
+			{
+				isRejected = std::string(ex.what()) == "Unexpected token on line: 3, column: 11";
+			}
+			Assert::IsTrue(isRejected);
+			Assert::IsTrue(outputStream.str() == "6\n100\n4\n");
+			Assert::IsTrue(executor.getGlobalCount() == 1);
+		}
+
+		TEST_METHOD(PipelineExecutesLikeStreamingMode)
+		{
+			std::string program = "F[x] = x * 2\nread a\nprint F[a]\na = a + 1\nprint F[a]\nprint a +\nprint 7\n";
+
+			// Small batches and queues, so the stages wait on each other and the error is in the middle of a batch
+			std::istringstream programStream(program);
+			std::istringstream inputStream("5");
+			std::ostringstream outputStream;
+			std::string error;
+			try
+			{
+				Pipeline::execute(programStream, outputStream, inputStream, nullptr, 4, 1);
+			}
+			catch (const std::invalid_argument& ex)
+			{
+				error = ex.what();
+			}
+
+			std::istringstream streamProgram(program);
+			std::istringstream streamInput("5");
+			std::ostringstream streamOutput;
+			std::string streamError;
+			try
+			{
+				StreamExecutor::execute(streamProgram, streamOutput, streamInput);
+			}
+			catch (const std::invalid_argument& ex)
+			{
+				streamError = ex.what();
+			}
+
+			Assert::IsTrue(outputStream.str() == "10\n12\n");
+			Assert::IsTrue(outputStream.str() == streamOutput.str());
+			Assert::IsTrue(!error.empty() && error == streamError);
+
+			std::istringstream validProgram("read a\nprint a * 3\n");
+			std::istringstream validInput("4");
+			std::ostringstream validOutput;
+			Assert::IsTrue(Pipeline::execute(validProgram, validOutput, validInput, nullptr, 1, 1) == 2);
+			Assert::IsTrue(validOutput.str() == "12\n");
+		}
+
+		TEST_METHOD(ParallelCompilerMatchesWholeProgram)
+		{
+			// Chunks of two lines on three threads, the error of the check in a later chunk comes before the error of the build
+			std::string invalidProgram = "a = 1\nF[x] = x * a\nprint (1 + 2\nb = 2\nprint F[b]\nprint a +\nc = 3\n";
+			std::string error;
+			try
+			{
+				ParallelCompiler::compileAst(std::make_shared<const SourceText>(invalidProgram), 3, 2);
+			}
+			catch (const std::invalid_argument& ex)
+			{
+				error = ex.what();
+			}
+			Assert::IsTrue(error == "Unexpected token on line: 6, column: 11");
+
+			std::string program = "a = 1\nF[x] = x * a\nprint F[2]\nb = a + 2\nread c\nG[y] = F[y] + b\nprint G[c]\n";
+			Ast ast = ParallelCompiler::compileAst(std::make_shared<const SourceText>(program), 3, 2);
+			Ast expectedAst = Compiler::compileAst(Tokenizer::tokenizeBuffer(program));
+
+			Assert::IsTrue(ast.nodes.size() == expectedAst.nodes.size() && ast.root == expectedAst.root);
+			for (int i = 0; i < ast.nodes.size(); i++)
+			{
+				Assert::IsTrue(ast.nodes[i].type == expectedAst.nodes[i].type && ast.nodes[i].value == expectedAst.nodes[i].value
+					&& ast.nodes[i].firstChild == expectedAst.nodes[i].firstChild && ast.nodes[i].childCount == expectedAst.nodes[i].childCount);
+			}
+			Assert::IsTrue(ast.childIndices == expectedAst.childIndices);
+			Assert::IsTrue(ast.variables == expectedAst.variables && ast.functions == expectedAst.functions);
+
+			Node treeRoot = ParallelCompiler::compile(std::make_shared<const SourceText>(program), 3, 2);
+			std::istringstream inputStream("4");
+			std::ostringstream outputStream;
+			Executor::execute(treeRoot, outputStream, inputStream);
+			Assert::IsTrue(treeRoot.children->size() == 7);
+			Assert::IsTrue(outputStream.str() == "2\n7\n");
+			Executor::deleteTree(treeRoot);
+		}
+
+		TEST_METHOD(SemanticAnalyzerReportsAllErrors)
+		{
+			std::vector<std::string> lines
+			{
+				"F[x] = G[x] + 1",
+				"G[x] = F[x] * 2",
+				"K[x] = G[x] + L[x]",
+				"print F[1]",
+				"print a",
+				"a = 1",
+				"H[x] = x + b",
+				"print H[a]",
+				"b = 2",
+				"print H[a]",
+				"H[y] = y"
+			};
+
+			// The recursion goes through another function and is found from the function defined first, H is ready only after b is assigned.
+			// K is never called, so its calls of the undefined L and of the recursive G are not errors
+			std::vector<std::string> messages = SemanticAnalyzer::analyze(Compiler::compileAst(Tokenizer::tokenize(lines)));
+			Assert::IsTrue(messages.size() == 4);
+			Assert::IsTrue(messages[0] == "Recursion is not supported! Function 'F' is called again from 'G'");
+			Assert::IsTrue(messages[1] == "Use of undefined variable 'a'");
+			Assert::IsTrue(messages[2] == "Use of undefined variable 'b'");
+			Assert::IsTrue(messages[3] == "Function H already defined!");
+
+			// An analyzed program is executed without the checks of the definitions
+			Ast ast = Compiler::compileAst(Tokenizer::tokenize(std::vector<std::string>{ "b = 2", "H[x] = x + b", "read a", "print H[a]" }));
+			Assert::IsTrue(SemanticAnalyzer::isSafe(ast));
+
+			Bytecode bytecode = BytecodeCompiler::compile(ast);
+			Assert::IsTrue(bytecode.isAnalyzed);
+			for (const Instruction& instruction : bytecode.instructions)
+			{
+				Assert::IsTrue(instruction.code != OpCode::define_function && instruction.code != OpCode::load_global && instruction.code != OpCode::call);
+			}
+
+			std::istringstream inputStream("5");
+			std::ostringstream outputStream;
+			VirtualMachine::execute(bytecode, outputStream, inputStream);
+			Assert::IsTrue(outputStream.str() == "7\n");
+		}
+
+		TEST_METHOD(ExpressionParserKeepsPrecedenceOnLongLines)
+		{
+			// The operators with the same precedence are left associative
+			std::string program = "F[x] = x * x\na = 100 / 10 / 5 - 3 - 2 * 2 % 3\nprint a\n";
+
+			// Long and deep expressions are parsed without recursion
+			program += "print 1";
+			for (int i = 0; i < 100000; i++)
+			{
+				program += " + 1 * 2 - 1";
+			}
+			program += "\nprint " + std::string(50000, '(') + "F[a]" + std::string(50000, ')') + "\n";
+
+			Ast ast = Compiler::compileAst(Tokenizer::tokenizeBuffer(program));
+			std::ostringstream vmOutput;
+			VirtualMachine::execute(BytecodeCompiler::compile(ast), vmOutput, std::cin);
+			Assert::IsTrue(vmOutput.str() == "-2\n100001\n4\n");
+
+			Node treeRoot = Compiler::compile(Tokenizer::tokenizeBuffer(program));
+			Assert::IsTrue(Ast(treeRoot).nodes.size() == ast.nodes.size());
+			std::ostringstream treeOutput;
+			Executor::execute(treeRoot, treeOutput, std::cin);
+			Assert::IsTrue(treeOutput.str() == vmOutput.str());
+			Executor::deleteTree(treeRoot);
+
+			// The errors of the brackets have the column of the bracket
+			std::vector<std::pair<std::string, std::string>> errors
+			{
+				{ "a = 1\nprint (a + 1\n", "Missmatched parenthesis on line: 2, column: 7" },
+				{ "a = 1\nF[x] = x\nprint F[a)\n", "Missmatched parenthesis on line: 3, column: 10" },
+				{ "a = 1\nF[x] = x\nprint a + F[a] = 2\n", "Unexpected token on line: 3, column: 16" }
+			};
+			for (const std::pair<std::string, std::string>& error : errors)
+			{
+				std::string treeError;
+				std::string arenaError;
+				try
+				{
+					Compiler::compile(Tokenizer::tokenizeBuffer(error.first));
+				}
+				catch (const std::invalid_argument& ex)
+				{
+					treeError = ex.what();
+				}
+				try
+				{
+					Compiler::compileAst(Tokenizer::tokenizeBuffer(error.first));
+				}
+				catch (const std::invalid_argument& ex)
+				{
+					arenaError = ex.what();
+				}
+				Assert::IsTrue(treeError == error.second && arenaError == error.second);
+			}
+		}
+
+		TEST_METHOD(OptimizerKeepsResultsInAnyPassOrder)
+		{
+			// The passes that rewrite nodes in place run after the passes that share nodes
+			std::vector<std::pair<std::string, std::vector<std::string>>> programs
+			{
+				{ "a = 18\ny = 24\nread d\nx = d+y*4+a\nread b\na = b\nprint a*6+18/(1+a*0)\n", { "ssa", "fold" } },
+				{ "x = 5\nF[a] = a + x\nG[x] = F[1] * 2\nprint F[1] * 2\nprint G[100]\n", { "cse", "inline" } },
+				{ "x = 5\nF[a] = a + x\nG[x] = F[1] * 2\nprint F[1] * 2\nprint G[100]\n", { "cse", "fold", "inline", "ssa", "fold" } }
+			};
+
+			for (const std::pair<std::string, std::vector<std::string>>& program : programs)
+			{
+				Ast ast = Compiler::compileAst(Tokenizer::tokenizeBuffer(program.first));
+
+				std::istringstream expectedInput("-2 49");
+				std::ostringstream expectedOutput;
+				VirtualMachine::execute(BytecodeCompiler::compile(ast), expectedOutput, expectedInput);
+
+				Optimizer optimizer;
+				optimizer.setPipeline(program.second);
+				optimizer.optimize(ast);
+
+				std::istringstream inputStream("-2 49");
+				std::ostringstream outputStream;
+				VirtualMachine::execute(BytecodeCompiler::compile(ast), outputStream, inputStream);
+				Assert::IsTrue(outputStream.str() == expectedOutput.str());
+			}
+
+			// The IR passes run inside the "ssa" pass, so a list without it is rejected
+			Optimizer irOptimizer;
+			Assert::ExpectException<std::invalid_argument>([&irOptimizer]
+			{
+				irOptimizer.setPipeline({ "ssa-fold", "gvn" });
+			});
+			irOptimizer.setPipeline({ "ssa", "ssa-fold", "gvn" });
+
+			// A node with two parents is rejected unless the AST is shared
+			Ast ast;
+			int number = ast.addNode(NodeType::number, 2);
+			int sum = ast.addNode(NodeType::operation_add, 0, { number, number });
+			ast.root = ast.addNode(NodeType::root, 0, { ast.addNode(NodeType::operation_print, 0, { sum }) });
+
+			bool isRejected = false;
+			try
+			{
+				ast.verify();
+			}
+			catch (const std::invalid_argument&)
+			{
+				isRejected = true;
+			}
+			Assert::IsTrue(isRejected);
+
+			ast.isShared = true;
+			ast.verify();
+			Assert::IsTrue(ast.unshare() == 1 && !ast.isShared && ast.nodes.size() == 5);
+			ast.verify();
+		}
+
+		TEST_METHOD(CommonSubexpressionEliminatorHandlesLongLines)
+		{
+			// Every subexpression is analyzed once, so long and deep lines take linear time
+			std::string program = "read a\nread b\nprint a * b";
+			for (int i = 1; i < 40000; i++)
+			{
+				program += " + a * b";
+			}
+			program += "\nprint " + std::string(20000, '(') + "a * b";
+			for (int i = 0; i < 20000; i++)
+			{
+				program += ") * a";
+			}
+			program += "\n";
+
+			Ast ast = Compiler::compileAst(Tokenizer::tokenizeBuffer(program));
+			Assert::IsTrue(CommonSubexpressionEliminator::eliminate(ast) == 1);
+			ast.verify();
+
+			std::istringstream inputStream("1 3");
+			std::ostringstream outputStream;
+			VirtualMachine::execute(BytecodeCompiler::compile(ast), outputStream, inputStream);
+			Assert::IsTrue(outputStream.str() == "120000\n3\n");
+		}
+
+		TEST_METHOD(InlinerHandlesLongCallChains)
+		{
+			// The sizes and errors of the arguments are computed once, so long chains of calls take linear time
+			std::string call = "a";
+			for (int i = 0; i < 20000; i++)
+			{
+				call = std::string(i % 2 == 0 ? "F[" : "G[") + call + "]";
+			}
+			std::string program = "read a\nF[x] = x + 1\nG[y] = y * 2\nprint " + call + "\nprint F[b]\n";
+
+			Ast ast = Compiler::compileAst(Tokenizer::tokenizeBuffer(program));
+			std::istringstream expectedInput("3");
+			std::ostringstream expectedOutput;
+			bool isExpectedFailed = false;
+			try
+			{
+				VirtualMachine::execute(BytecodeCompiler::compile(ast), expectedOutput, expectedInput);
+			}
+			catch (const std::exception&)
+			{
+				isExpectedFailed = true;
+			}
+
+			// The call with a failing argument is not expanded
+			int inlinedCalls = Inliner::inlineCalls(ast);
+			Assert::IsTrue(inlinedCalls > 0 && inlinedCalls < 20000);
+			ast.verify();
+
+			std::istringstream inputStream("3");
+			std::ostringstream outputStream;
+			bool isFailed = false;
+			try
+			{
+				VirtualMachine::execute(BytecodeCompiler::compile(ast), outputStream, inputStream);
+			}
+			catch (const std::exception&)
+			{
+				isFailed = true;
+			}
+			Assert::IsTrue(isExpectedFailed && isFailed && outputStream.str() == expectedOutput.str());
+		}
+
+		TEST_METHOD(PartialEvaluatorHandlesDeepExpressions)
+		{
+			// The expressions and the calls are computed with explicit stacks, once per node
+			std::string sum = "a";
+			std::string call = "a";
+			for (int i = 0; i < 100000; i++)
+			{
+				sum = "(b+" + sum + ")";
+				call = "F[" + call + "]";
+			}
+			std::string program = "F[x] = x + 1\nread a\nprint " + call + "\nread b\nprint " + sum + "\n";
+
+			Ast ast = Compiler::compileAst(Tokenizer::tokenizeBuffer(program));
+
+			// The call chain and the known global in the sum are computed, the rest of the sum depends on the unknown input
+			Assert::IsTrue(PartialEvaluator::specialize(ast, { 3 }) == 2);
+			ast.verify();
+
+			std::istringstream inputStream("2");
+			std::ostringstream outputStream;
+			VirtualMachine::execute(BytecodeCompiler::compile(ast), outputStream, inputStream);
+			Assert::IsTrue(outputStream.str() == "100003\n200003\n");
+		}
+
+		TEST_METHOD(ClosureExecutorHandlesDeepExpressions)
+		{
+			// The closures are nested only a few hundred levels, the deeper subexpressions are computed first
+			std::string sum = "v";
+			std::string call = "a";
+			for (int i = 0; i < 100000; i++)
+			{
+				sum = "(a+" + sum + ")";
+				call = "F[" + call + "]";
+			}
+			std::string program = "F[x] = x + 1\nread a\nprint " + call + "\nprint u + " + sum + "\n";
+
+			ClosureProgram closureProgram = ClosureExecutor::compile(Compiler::compileAst(Tokenizer::tokenizeBuffer(program)));
+
+			std::istringstream inputStream("3");
+			std::ostringstream outputStream;
+			std::string error;
+			try
+			{
+				ClosureExecutor::execute(closureProgram, outputStream, inputStream);
+			}
+			catch (const std::invalid_argument& ex)
+			{
+				error = ex.what();
+			}
+
+			// The undefined variable on the left is still reported before the one at the bottom of the sum
+			Assert::IsTrue(outputStream.str() == "100003\n");
+			Assert::IsTrue(error == "Use of undefined variable 'u'");
+		}
+
+		TEST_METHOD(TieredExecutorHandlesDeepExpressions)
+		{
+			// The interpreter keeps the operands on explicit stacks and the promoted code is built without recursion
+			std::string sum = "x";
+			std::string call = "a";
+			for (int i = 0; i < 100000; i++)
+			{
+				sum = "(1+" + sum + ")";
+				call = "F[" + call + "]";
+			}
+			std::string program = "F[x] = x + 1\nG[x] = " + sum + "\nread a\nprint " + call + "\nprint G[a] - G[1]\n";
+
+			TieredExecutor executor(Compiler::compileAst(Tokenizer::tokenizeBuffer(program)), 4, 2);
+
+			for (int run = 0; run < 3; run++)
+			{
+				std::ostringstream outputStream;
+				std::istringstream inputStream("3");
+
+				executor.execute(outputStream, inputStream);
+
+				Assert::IsTrue(outputStream.str() == "100003\n2\n");
+			}
+
+			const TieredStats& stats = executor.getStats();
+			Assert::IsTrue(stats.compiledStatements == 5);
+			Assert::IsTrue(stats.promotions[0].name == "function F");
+			Assert::IsTrue(stats.promotions[5].name == "function G");
+		}
+
+		TEST_METHOD(BatchRunnerExecutesPrefixOnce)
+		{
+			std::vector<std::string> lines
+			{
+				"F[x] = x * 3",
+				"a = F[7] - 30",
+				"read k",
+				"print a",
+				"read n",
+				"print a * n + k"
+			};
+
+			// The statements before the read of n use only the known input, every set starts with their output and the value of a
+			Node treeRoot = Compiler::compile(Tokenizer::tokenize(lines));
+			std::istringstream treeInputStream("1\n4\nx\n");
+			std::ostringstream treeOutputStream;
+			Assert::IsTrue(BatchRunner::run(treeRoot, { 2 }, treeInputStream, treeOutputStream) == 3);
+			Executor::deleteTree(treeRoot);
+
+			Assert::IsTrue(treeOutputStream.str() == "-9\n-7\n-9\n-34\n-9\nInvalid number is entered\n");
+
+			Ast ast = Compiler::compileAst(Tokenizer::tokenize(lines));
+			std::istringstream inputStream("2 1\n2 4\n");
+			std::ostringstream outputStream;
+			Assert::IsTrue(BatchRunner::run(ast, "closure", inputStream, outputStream) == 2);
+
+			Assert::IsTrue(outputStream.str() == "-9\n-7\n-9\n-34\n");
+
+			// A failing prefix prints the same output and error for every set
+			Node failingRoot = Compiler::compile(Tokenizer::tokenize(std::vector<std::string>{ "print 5", "print b", "read n" }));
+			std::istringstream failingInputStream("1\n2\n");
+			std::ostringstream failingOutputStream;
+			Assert::IsTrue(BatchRunner::run(failingRoot, {}, failingInputStream, failingOutputStream) == 2);
+			Executor::deleteTree(failingRoot);
+
+			Assert::IsTrue(failingOutputStream.str() == "5\nUse of undefined variable 'b'\n5\nUse of undefined variable 'b'\n");
+		}
+
+		TEST_METHOD(StreamingModesReportRecursionThroughOtherFunctions)
+		{
+			std::string program = "F[x] = G[x]\nG[x] = F[x] + 1\nprint 5\nprint F[1]\n";
+			std::string expectedError = "Recursion is not supported! Function 'F' is called again from 'G'";
+
+			std::istringstream streamProgram(program);
+			std::istringstream streamInput;
+			std::ostringstream streamOutput;
+			std::string streamError;
+			try
+			{
+				StreamExecutor::execute(streamProgram, streamOutput, streamInput);
+			}
+			catch (const std::invalid_argument& ex)
+			{
+				streamError = ex.what();
+			}
+			Assert::IsTrue(streamOutput.str() == "5\n" && streamError == expectedError);
+
+			std::istringstream pipelineProgram(program);
+			std::istringstream pipelineInput;
+			std::ostringstream pipelineOutput;
+			std::string pipelineError;
+			try
+			{
+				Pipeline::execute(pipelineProgram, pipelineOutput, pipelineInput, nullptr, 1, 1);
+			}
+			catch (const std::invalid_argument& ex)
+			{
+				pipelineError = ex.what();
+			}
+			Assert::IsTrue(pipelineOutput.str() == "5\n" && pipelineError == expectedError);
+
+			// The functions of the failed call are not left marked, so the executor can still call them
+			StreamExecutor executor(streamOutput, streamInput);
+			executor.executeLine("H[x] = x * q");
+			executor.executeLine("K[x] = H[x] + 1");
+			Assert::ExpectException<std::invalid_argument>([&executor]
+			{
+				executor.executeLine("print K[3]");
+			});
+			executor.executeLine("q = 2");
+			executor.executeLine("print K[3]");
+			Assert::IsTrue(streamOutput.str() == "5\n7\n");
+		}
 	};
 }
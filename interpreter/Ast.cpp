@@ -0,0 +1,331 @@
+#include "Ast.h"
+#include "Executor.h"
+
+#include <stdexcept>
+
+Ast::Ast(const Node& treeRoot)
+{
+    // Convert the nodes in post order with an iterative dfs, so the children get their indexes before the parent
+    // The flag shows whether the children of the node are already converted
+    std::vector<std::pair<const Node*, bool>> convertStack{ std::pair<const Node*, bool>(&treeRoot, false) };
+    std::vector<int> convertedNodes;
+
+    while (!convertStack.empty())
+    {
+        const Node* currNode = convertStack.back().first;
+        bool childrenConverted = convertStack.back().second;
+
+        if (!childrenConverted && !currNode->children->empty())
+        {
+            convertStack.back().second = true;
+            for (auto child = currNode->children->rbegin(); child != currNode->children->rend(); child++)
+            {
+                convertStack.push_back(std::pair<const Node*, bool>(&(*child), false));
+            }
+            continue;
+        }
+        convertStack.pop_back();
+
+        long long value = 0;
+        switch (currNode->type)
+        {
+        case NodeType::number:
+            value = Executor::parseNumber(currNode->value);
+            break;
+        case NodeType::variable:
+            value = getVariableId(currNode->value);
+            break;
+        case NodeType::function:
+        case NodeType::define_function:
+            value = getFunctionId(currNode->value);
+            break;
+        default:
+            break;
+        }
+
+        // The converted children are the last ones on the stack of converted nodes
+        std::vector<int> children(convertedNodes.end() - currNode->children->size(), convertedNodes.end());
+        convertedNodes.resize(convertedNodes.size() - children.size());
+
+        convertedNodes.push_back(addNode(currNode->type, value, children));
+    }
+
+    root = convertedNodes.back();
+}
+
+int Ast::addNode(NodeType type, long long value, std::initializer_list<int> children)
+{
+    nodes.push_back(AstNode(type, value, (int)childIndices.size(), (int)children.size()));
+    childIndices.insert(childIndices.end(), children);
+
+    return (int)nodes.size() - 1;
+}
+
+int Ast::addNode(NodeType type, long long value, const std::vector<int>& children)
+{
+    nodes.push_back(AstNode(type, value, (int)childIndices.size(), (int)children.size()));
+    childIndices.insert(childIndices.end(), children.begin(), children.end());
+
+    return (int)nodes.size() - 1;
+}
+
+std::vector<int> Ast::getPostOrder(int node) const
+{
+    // Iterative dfs, the flag shows whether the children of the node are already added
+    std::vector<int> postOrder;
+    std::vector<std::pair<int, bool>> visitStack{ std::pair<int, bool>(node, false) };
+
+    while (!visitStack.empty())
+    {
+        int currNode = visitStack.back().first;
+        bool childrenAdded = visitStack.back().second;
+
+        if (!childrenAdded && nodes[currNode].childCount > 0)
+        {
+            visitStack.back().second = true;
+            for (int i = nodes[currNode].childCount - 1; i >= 0; i--)
+            {
+                visitStack.push_back(std::pair<int, bool>(getChild(currNode, i), false));
+            }
+            continue;
+        }
+        visitStack.pop_back();
+
+        postOrder.push_back(currNode);
+    }
+
+    return postOrder;
+}
+
+int Ast::compact()
+{
+    if (root < 0)
+    {
+        return 0;
+    }
+
+    std::vector<int> postOrder = getPostOrder(root);
+
+    std::vector<AstNode> oldNodes;
+    std::vector<int> oldChildIndices;
+    oldNodes.swap(nodes);
+    oldChildIndices.swap(childIndices);
+
+    nodes.reserve(postOrder.size());
+    childIndices.reserve(postOrder.size());
+
+    // The nodes are added in post order, so the new indexes of the children are known when their parent is added
+    std::vector<int> newIndexes(oldNodes.size(), -1);
+    for (int oldIndex : postOrder)
+    {
+        // A shared node is reached once for every parent, but it is copied only once, so it stays shared
+        if (newIndexes[oldIndex] >= 0)
+        {
+            continue;
+        }
+
+        const AstNode& oldNode = oldNodes[oldIndex];
+
+        nodes.push_back(AstNode(oldNode.type, oldNode.value, (int)childIndices.size(), oldNode.childCount));
+        for (int i = 0; i < oldNode.childCount; i++)
+        {
+            childIndices.push_back(newIndexes[oldChildIndices[oldNode.firstChild + i]]);
+        }
+
+        newIndexes[oldIndex] = (int)nodes.size() - 1;
+    }
+
+    root = newIndexes[root];
+
+    return (int)(oldNodes.size() - nodes.size());
+}
+
+int Ast::unshare()
+{
+    isShared = false;
+    if (root < 0)
+    {
+        return 0;
+    }
+
+    // A shared node is reached once for every parent, so it is copied for every parent
+    std::vector<int> postOrder = getPostOrder(root);
+
+    std::vector<AstNode> oldNodes;
+    std::vector<int> oldChildIndices;
+    oldNodes.swap(nodes);
+    oldChildIndices.swap(childIndices);
+
+    nodes.reserve(postOrder.size());
+    childIndices.reserve(postOrder.size());
+
+    // The copies of the children are the last ones on the stack of copies when their parent is copied
+    std::vector<int> copies;
+    std::vector<char> isCopied(oldNodes.size(), 0);
+    int addedCopies = 0;
+    for (int oldIndex : postOrder)
+    {
+        const AstNode& oldNode = oldNodes[oldIndex];
+
+        nodes.push_back(AstNode(oldNode.type, oldNode.value, (int)childIndices.size(), oldNode.childCount));
+        childIndices.insert(childIndices.end(), copies.end() - oldNode.childCount, copies.end());
+        copies.resize(copies.size() - oldNode.childCount);
+        copies.push_back((int)nodes.size() - 1);
+
+        addedCopies += isCopied[oldIndex];
+        isCopied[oldIndex] = 1;
+    }
+
+    root = copies.back();
+
+    return addedCopies;
+}
+
+void Ast::verify() const
+{
+    if (root < 0)
+    {
+        return;
+    }
+
+    auto fail = [](int node, const std::string& message)
+    {
+        throw std::invalid_argument("Invalid AST at node " + std::to_string(node) + ": " + message);
+    };
+
+    if (root >= nodes.size() || nodes[root].type != NodeType::root)
+    {
+        fail(root, "the root is not a root node");
+    }
+
+    // Iterative dfs where the state shows whether the node is not visited (0), on the current path (1) or checked (2),
+    // a node can be reached from more than one parent only in a shared AST, but never from itself
+    std::vector<char> states(nodes.size(), 0);
+    std::vector<std::pair<int, bool>> visitStack{ std::pair<int, bool>(root, false) };
+
+    while (!visitStack.empty())
+    {
+        int currIndex = visitStack.back().first;
+        bool childrenVisited = visitStack.back().second;
+
+        if (childrenVisited)
+        {
+            states[currIndex] = 2;
+            visitStack.pop_back();
+            continue;
+        }
+        if (states[currIndex] == 2)
+        {
+            if (!isShared)
+            {
+                fail(currIndex, "node with more than one parent in a tree");
+            }
+            visitStack.pop_back();
+            continue;
+        }
+        states[currIndex] = 1;
+        visitStack.back().second = true;
+
+        const AstNode& currNode = nodes[currIndex];
+        if (currNode.firstChild < 0 || currNode.childCount < 0 || currNode.firstChild + currNode.childCount > childIndices.size())
+        {
+            fail(currIndex, "invalid child range");
+        }
+
+        bool isStatement = currNode.type == NodeType::operation_assign || currNode.type == NodeType::operation_print
+            || currNode.type == NodeType::operation_read || currNode.type == NodeType::define_function;
+
+        int expectedChildren = -1;
+        switch (currNode.type)
+        {
+        case NodeType::number:
+        case NodeType::variable:
+            expectedChildren = 0;
+            break;
+        case NodeType::function:
+        case NodeType::operation_print:
+        case NodeType::operation_read:
+            expectedChildren = 1;
+            break;
+        case NodeType::root:
+            break;
+        case NodeType::undefined:
+            fail(currIndex, "undefined node");
+            break;
+        default:
+            expectedChildren = 2;
+            break;
+        }
+        if (expectedChildren >= 0 && currNode.childCount != expectedChildren)
+        {
+            fail(currIndex, "wrong number of children");
+        }
+
+        if (currNode.type == NodeType::variable && (currNode.value < 0 || currNode.value >= (long long)variables.size()))
+        {
+            fail(currIndex, "unknown variable");
+        }
+        if ((currNode.type == NodeType::function || currNode.type == NodeType::define_function)
+            && (currNode.value < 0 || currNode.value >= (long long)functions.size()))
+        {
+            fail(currIndex, "unknown function");
+        }
+
+        for (int i = 0; i < currNode.childCount; i++)
+        {
+            int child = getChild(currIndex, i);
+            if (child < 0 || child >= nodes.size())
+            {
+                fail(currIndex, "invalid child index");
+            }
+            if (states[child] == 1)
+            {
+                fail(currIndex, "cycle");
+            }
+
+            const AstNode& childNode = nodes[child];
+            bool isChildStatement = childNode.type == NodeType::operation_assign || childNode.type == NodeType::operation_print
+                || childNode.type == NodeType::operation_read || childNode.type == NodeType::define_function;
+
+            // The statements are the children of the root, the assigned, read and parameter variables are the first children of their statement
+            if (isChildStatement != (currNode.type == NodeType::root) || childNode.type == NodeType::root)
+            {
+                fail(child, "node in a wrong position");
+            }
+            if (i == 0 && isStatement && currNode.type != NodeType::operation_print && childNode.type != NodeType::variable)
+            {
+                fail(child, "the statement doesn't start with a variable");
+            }
+
+            visitStack.push_back(std::pair<int, bool>(child, false));
+        }
+    }
+}
+
+int Ast::getVariableId(const std::string& name)
+{
+    auto id = variableIds.find(name);
+    if (id != variableIds.end())
+    {
+        return id->second;
+    }
+
+    variables.push_back(name);
+    variableIds.insert(std::pair<std::string, int>(name, (int)variables.size() - 1));
+
+    return (int)variables.size() - 1;
+}
+
+int Ast::getFunctionId(const std::string& name)
+{
+    auto id = functionIds.find(name);
+    if (id != functionIds.end())
+    {
+        return id->second;
+    }
+
+    functions.push_back(name);
+    functionIds.insert(std::pair<std::string, int>(name, (int)functions.size() - 1));
+
+    return (int)functions.size() - 1;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "AstNode.h"
+#include "Node.h"
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief AST stored in one contiguous arena, the nodes refer to each other by index,
+/// the numbers are parsed and the names are interned to symbol ids.
+/// A node can have more than one parent only after the common subexpression elimination (the AST becomes a DAG)
+class Ast
+{
+public:
+    /// @brief The nodes (children are always stored before their parent)
+    std::vector<AstNode> nodes;
+    /// @brief The child indexes of all nodes, the children of a node are a contiguous range
+    std::vector<int> childIndices;
+    /// @brief Names of the variables by symbol id
+    std::vector<std::string> variables;
+    /// @brief Names of the functions by symbol id
+    std::vector<std::string> functions;
+    /// @brief Index of the root node (-1 for an empty AST)
+    int root = -1;
+    /// @brief True if a node can have more than one parent (set by the passes that share nodes),
+    /// the passes that rewrite the nodes in place unshare the AST first
+    bool isShared = false;
+
+    /// @brief Base constructor for an empty AST
+    Ast() {}
+
+    /// @brief Constructor for converting a tree of Nodes to an arena AST
+    /// @param treeRoot The root node of the tree
+    explicit Ast(const Node& treeRoot);
+
+    /// @brief Adds a node with its children
+    /// @param type The node type
+    /// @param value The node value
+    /// @param children Indexes of the children
+    /// @return The index of the new node
+    int addNode(NodeType type, long long value, std::initializer_list<int> children = {});
+
+    /// @brief Adds a node with its children
+    /// @param type The node type
+    /// @param value The node value
+    /// @param children Indexes of the children
+    /// @return The index of the new node
+    int addNode(NodeType type, long long value, const std::vector<int>& children);
+
+    /// @brief Gets the index of a child of a node
+    /// @param node The node index
+    /// @param childNumber The position of the child
+    /// @return The index of the child
+    int getChild(int node, int childNumber) const { return childIndices[nodes[node].firstChild + childNumber]; }
+
+    /// @brief Gets the nodes of a subtree in post order (the children of every node come before it)
+    /// @param node The index of the root of the subtree
+    /// @return The node indexes in post order
+    std::vector<int> getPostOrder(int node) const;
+
+    /// @brief Removes the nodes that are not reachable from the root (the symbol ids are kept and the shared nodes stay shared)
+    /// @return The number of removed nodes
+    int compact();
+
+    /// @brief Copies the nodes that have more than one parent, so every node has one parent (the unreachable nodes are removed)
+    /// @return The number of added copies
+    int unshare();
+
+    /// @brief Checks the structure of the AST (the child counts and kinds of every node, the symbol ids, that there are no cycles
+    /// and that every node has one parent if the AST isn't shared)
+    /// @throws std::invalid_argument If the AST is broken
+    void verify() const;
+
+    /// @brief Gets the symbol id of a variable (creates it if needed)
+    /// @param name The variable name
+    /// @return The symbol id
+    int getVariableId(const std::string& name);
+
+    /// @brief Gets the symbol id of a function (creates it if needed)
+    /// @param name The function name
+    /// @return The symbol id
+    int getFunctionId(const std::string& name);
+
+private:
+    /// @brief Map with the variable symbol ids by name
+    std::unordered_map<std::string, int> variableIds;
+    /// @brief Map with the function symbol ids by name
+    std::unordered_map<std::string, int> functionIds;
+};
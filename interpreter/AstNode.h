@@ -0,0 +1,22 @@
+#pragma once
+#include "NodeType.h"
+
+/// @brief Node of the arena AST (it is stored by value in the node array of the AST)
+class AstNode
+{
+public:
+    /// @brief The type of the node
+    NodeType type;
+    /// @brief The value of a number, the symbol id of a variable or a function (0 for the other nodes)
+    long long value;
+    /// @brief Position of the first child index in the child index array of the AST
+    int firstChild;
+    /// @brief Number of children
+    int childCount;
+    /// @brief Constructor for creating a node by type, value and child range
+    /// @param type The node type
+    /// @param value The node value
+    /// @param firstChild Position of the first child index
+    /// @param childCount Number of children
+    AstNode(NodeType type, long long value, int firstChild, int childCount) : type(type), value(value), firstChild(firstChild), childCount(childCount) {}
+};
@@ -0,0 +1,360 @@
+#include "BatchRunner.h"
+#include "Executor.h"
+#include "BytecodeCompiler.h"
+#include "VirtualMachine.h"
+#include "ClosureExecutor.h"
+#include "JitCompiler.h"
+#include "TieredExecutor.h"
+
+#include <functional>
+#include <sstream>
+#include <unordered_set>
+
+namespace
+{
+    /// @brief Executes the program for every line of the input
+    /// @param execute Function that executes the program with the given streams
+    /// @param prefix The text given in front of every input set
+    /// @param inputSets The stream with one input set per line
+    /// @param out The output stream
+    /// @return The number of executed input sets
+    int runSets(std::function<void(std::ostream&, std::istream&)> execute, const std::string& prefix, std::istream& inputSets, std::ostream& out)
+    {
+        int sets = 0;
+        std::string line;
+        while (std::getline(inputSets, line))
+        {
+            std::istringstream in(prefix + line);
+
+            // An error ends only the run of its input set, like it ends the run of a single program
+            try
+            {
+                execute(out, in);
+            }
+            catch (const std::exception& ex)
+            {
+                out << ex.what() << std::endl;
+            }
+
+            sets++;
+        }
+
+        return sets;
+    }
+
+    /// @brief The result of the statements that don't depend on the input sets
+    class PrefixResult
+    {
+    public:
+        /// @brief The values printed by the statements
+        std::vector<long long> printedValues;
+        /// @brief The values of the globals assigned by the statements
+        std::vector<long long> globalValues;
+        /// @brief True if the statements failed, every set then prints the same values and the same error
+        bool isFailed = false;
+        /// @brief The message of the error
+        std::string error;
+    };
+
+    /// @brief Executes the statements that don't depend on the input sets once
+    /// @param execute Function that executes the statements with the given output stream, they are followed by prints of the assigned globals
+    /// @param globalCount The number of the assigned globals
+    /// @return The printed values and the values of the globals
+    PrefixResult runPrefix(std::function<void(std::ostream&)> execute, size_t globalCount)
+    {
+        PrefixResult result;
+        std::ostringstream out;
+
+        try
+        {
+            execute(out);
+        }
+        catch (const std::exception& ex)
+        {
+            result.isFailed = true;
+            result.error = ex.what();
+        }
+
+        // Every print writes one number on its own line
+        std::istringstream printed(out.str());
+        long long value;
+        while (printed >> value)
+        {
+            result.printedValues.push_back(value);
+        }
+
+        if (!result.isFailed)
+        {
+            result.globalValues.assign(result.printedValues.end() - globalCount, result.printedValues.end());
+            result.printedValues.resize(result.printedValues.size() - globalCount);
+        }
+
+        return result;
+    }
+
+    /// @brief Writes the output of the failed statements for every input set
+    /// @param prefix The result of the statements
+    /// @param inputSets The stream with one input set per line
+    /// @param out The output stream
+    /// @return The number of input sets
+    int replayFailedPrefix(const PrefixResult& prefix, std::istream& inputSets, std::ostream& out)
+    {
+        return runSets([&prefix](std::ostream& out, std::istream&)
+        {
+            for (long long value : prefix.printedValues)
+            {
+                out << value << '\n';
+            }
+            out << prefix.error << std::endl;
+        }, "", inputSets, out);
+    }
+
+    /// @brief Creates a number node of the tree AST
+    /// @param value The value of the number
+    /// @return The number node
+    Node makeNumber(long long value)
+    {
+        // The numbers are parsed as unsigned and converted back, so a negative value is written as its unsigned bit pattern
+        return Node(NodeType::number, std::to_string((unsigned long long)value));
+    }
+
+    /// @brief Compiles the program once and executes it once for every input set
+    /// @param ast The arena AST
+    /// @param engine The name of the execution engine (vm, closure, jit or tiered)
+    /// @param inputSets The stream with one input set per line
+    /// @param out The output stream
+    /// @return The number of executed input sets
+    int runProgram(const Ast& ast, const std::string& engine, std::istream& inputSets, std::ostream& out)
+    {
+        if (engine == "vm")
+        {
+            Bytecode bytecode = BytecodeCompiler::compile(ast);
+
+            return runSets([&bytecode](std::ostream& out, std::istream& in)
+            {
+                VirtualMachine::execute(bytecode, out, in);
+            }, "", inputSets, out);
+        }
+        else if (engine == "closure")
+        {
+            ClosureProgram program = ClosureExecutor::compile(ast);
+
+            return runSets([&program](std::ostream& out, std::istream& in)
+            {
+                ClosureExecutor::execute(program, out, in);
+            }, "", inputSets, out);
+        }
+        else if (engine == "jit")
+        {
+            // Programs the JIT can't compile are executed by the virtual machine
+            JitProgram program;
+            if (JitCompiler::compile(ast, program))
+            {
+                return runSets([&program](std::ostream& out, std::istream& in)
+                {
+                    JitCompiler::execute(program, out, in);
+                }, "", inputSets, out);
+            }
+
+            return runProgram(ast, "vm", inputSets, out);
+        }
+        else if (engine == "tiered")
+        {
+            // The counters are kept between the input sets, so the code that is hot in every run is promoted once
+            TieredExecutor executor(ast);
+
+            return runSets([&executor](std::ostream& out, std::istream& in)
+            {
+                executor.execute(out, in);
+            }, "", inputSets, out);
+        }
+
+        throw std::invalid_argument("Unknown execution engine '" + engine + "'");
+    }
+}
+
+int BatchRunner::run(const Node& treeRoot, const std::vector<long long>& knownInputs, std::istream& inputSets, std::ostream& out)
+{
+    std::string prefix;
+    for (long long value : knownInputs)
+    {
+        prefix += std::to_string(value) + " ";
+    }
+
+    // The statements before the first read of a value from the input set are the same for every set
+    const std::vector<Node>& statements = *treeRoot.children;
+    size_t prefixLength = 0;
+    size_t reads = 0;
+    std::vector<std::string> globals;
+    std::unordered_set<std::string> seenGlobals;
+    for (; prefixLength < statements.size(); prefixLength++)
+    {
+        const Node& statement = statements[prefixLength];
+        if (statement.type == NodeType::operation_read && reads++ == knownInputs.size())
+        {
+            break;
+        }
+
+        if ((statement.type == NodeType::operation_assign || statement.type == NodeType::operation_read)
+            && seenGlobals.insert((*statement.children)[0].value).second)
+        {
+            globals.push_back((*statement.children)[0].value);
+        }
+    }
+
+    if (prefixLength == 0)
+    {
+        return runSets([&treeRoot](std::ostream& out, std::istream& in)
+        {
+            Executor::execute(treeRoot, out, in);
+        }, prefix, inputSets, out);
+    }
+
+    // The statements are executed once with the known inputs, the values of the globals are printed after them
+    Node prefixRoot(NodeType::root);
+    prefixRoot.children->assign(statements.begin(), statements.begin() + prefixLength);
+    for (const std::string& global : globals)
+    {
+        Node printNode(NodeType::operation_print);
+        printNode.children->push_back(Node(NodeType::variable, global));
+        prefixRoot.children->push_back(printNode);
+    }
+
+    std::istringstream knownInputStream(prefix);
+    PrefixResult result = runPrefix([&prefixRoot, &knownInputStream](std::ostream& out)
+    {
+        Executor::execute(prefixRoot, out, knownInputStream);
+    }, globals.size());
+
+    for (size_t i = prefixLength; i < prefixRoot.children->size(); i++)
+    {
+        Executor::deleteTree((*prefixRoot.children)[i]);
+    }
+    delete prefixRoot.children;
+
+    if (result.isFailed)
+    {
+        return replayFailedPrefix(result, inputSets, out);
+    }
+
+    // Every set starts with the printed values, the definitions and the values of the globals, the known inputs are already read
+    Node residualRoot(NodeType::root);
+    std::vector<Node> addedStatements;
+    for (long long value : result.printedValues)
+    {
+        Node printNode(NodeType::operation_print);
+        printNode.children->push_back(makeNumber(value));
+        addedStatements.push_back(printNode);
+    }
+    for (size_t i = 0; i < globals.size(); i++)
+    {
+        Node assignNode(NodeType::operation_assign);
+        assignNode.children->push_back(Node(NodeType::variable, globals[i]));
+        assignNode.children->push_back(makeNumber(result.globalValues[i]));
+        addedStatements.push_back(assignNode);
+    }
+
+    residualRoot.children->assign(addedStatements.begin(), addedStatements.end());
+    for (size_t i = 0; i < statements.size(); i++)
+    {
+        if (i >= prefixLength || statements[i].type == NodeType::define_function)
+        {
+            residualRoot.children->push_back(statements[i]);
+        }
+    }
+
+    int sets = runSets([&residualRoot](std::ostream& out, std::istream& in)
+    {
+        Executor::execute(residualRoot, out, in);
+    }, "", inputSets, out);
+
+    for (Node& statement : addedStatements)
+    {
+        Executor::deleteTree(statement);
+    }
+    delete residualRoot.children;
+
+    return sets;
+}
+
+int BatchRunner::run(const Ast& ast, const std::string& engine, std::istream& inputSets, std::ostream& out)
+{
+    // The statements before the first read are the same for every set
+    std::vector<int> statements;
+    size_t prefixLength = 0;
+    std::vector<long long> globals;
+    std::vector<char> isGlobalSeen(ast.variables.size());
+    if (ast.root >= 0)
+    {
+        for (int i = 0; i < ast.nodes[ast.root].childCount; i++)
+        {
+            statements.push_back(ast.getChild(ast.root, i));
+        }
+    }
+    for (; prefixLength < statements.size(); prefixLength++)
+    {
+        const AstNode& statement = ast.nodes[statements[prefixLength]];
+        if (statement.type == NodeType::operation_read)
+        {
+            break;
+        }
+
+        long long global = statement.type == NodeType::operation_assign ? ast.nodes[ast.getChild(statements[prefixLength], 0)].value : -1;
+        if (global >= 0 && !isGlobalSeen[global])
+        {
+            isGlobalSeen[global] = true;
+            globals.push_back(global);
+        }
+    }
+
+    if (prefixLength == 0)
+    {
+        return runProgram(ast, engine, inputSets, out);
+    }
+
+    // The statements are executed once by the virtual machine, the values of the globals are printed after them
+    Ast prefixAst = ast;
+    std::vector<int> prefixStatements(statements.begin(), statements.begin() + prefixLength);
+    for (long long global : globals)
+    {
+        int variable = prefixAst.addNode(NodeType::variable, global);
+        prefixStatements.push_back(prefixAst.addNode(NodeType::operation_print, 0, { variable }));
+    }
+    prefixAst.root = prefixAst.addNode(NodeType::root, 0, prefixStatements);
+
+    PrefixResult result = runPrefix([&prefixAst](std::ostream& out)
+    {
+        std::istringstream in;
+        VirtualMachine::execute(BytecodeCompiler::compile(prefixAst), out, in);
+    }, globals.size());
+
+    if (result.isFailed)
+    {
+        return replayFailedPrefix(result, inputSets, out);
+    }
+
+    // Every set starts with the printed values, the definitions and the values of the globals
+    Ast residualAst = ast;
+    std::vector<int> residualStatements;
+    for (long long value : result.printedValues)
+    {
+        int number = residualAst.addNode(NodeType::number, value);
+        residualStatements.push_back(residualAst.addNode(NodeType::operation_print, 0, { number }));
+    }
+    for (size_t i = 0; i < globals.size(); i++)
+    {
+        int variable = residualAst.addNode(NodeType::variable, globals[i]);
+        int number = residualAst.addNode(NodeType::number, result.globalValues[i]);
+        residualStatements.push_back(residualAst.addNode(NodeType::operation_assign, 0, { variable, number }));
+    }
+    for (size_t i = 0; i < statements.size(); i++)
+    {
+        if (i >= prefixLength || ast.nodes[statements[i]].type == NodeType::define_function)
+        {
+            residualStatements.push_back(statements[i]);
+        }
+    }
+    residualAst.root = residualAst.addNode(NodeType::root, 0, residualStatements);
+
+    return runProgram(residualAst, engine, inputSets, out);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Ast.h"
+#include "Node.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// @brief Class with methods for executing a program with many input sets
+class BatchRunner
+{
+public:
+    /// @brief Executes the program once for every line of the input, the errors are written to the output and the next set is executed.
+    /// The statements before the first read of a value from the set are executed once, every set starts with their output and the values of their globals
+    /// @param treeRoot The root node of the AST (its statements are executed by the tree executor, so it is the reference for the other engines)
+    /// @param knownInputs The values given in front of every input set
+    /// @param inputSets The stream with one input set per line
+    /// @param out The output stream
+    /// @return The number of executed input sets
+    static int run(const Node& treeRoot, const std::vector<long long>& knownInputs, std::istream& inputSets, std::ostream& out);
+
+    /// @brief Compiles the program once and executes it once for every line of the input, the errors are written to the output and the next set is executed.
+    /// The statements before the first read are executed once like in the tree version, the AST is expected to be specialized by the partial evaluator,
+    /// so the later expressions that don't depend on the input are already computed
+    /// @param ast The arena AST
+    /// @param engine The name of the execution engine (vm, closure, jit or tiered)
+    /// @param inputSets The stream with one input set per line
+    /// @param out The output stream
+    /// @return The number of executed input sets
+    static int run(const Ast& ast, const std::string& engine, std::istream& inputSets, std::ostream& out);
+};
@@ -0,0 +1,112 @@
+#include "Benchmark.h"
+#include "Executor.h"
+#include "BytecodeCompiler.h"
+#include "VirtualMachine.h"
+#include "ClosureExecutor.h"
+#include "JitCompiler.h"
+#include "TieredExecutor.h"
+
+#include <chrono>
+#include <functional>
+#include <sstream>
+
+namespace
+{
+    /// @brief Measures the time of running the program several times
+    /// @param name The name of the engine
+    /// @param prepare Function that prepares the engine (compiles the program), measured once
+    /// @param execute Function that executes the program with the given streams
+    /// @param input The text given as input to every run
+    /// @param iterations The number of runs
+    /// @param report The stream the results are written to
+    /// @param expectedOutput The output of the reference engine (null when measuring the reference engine)
+    /// @return The output of the program
+    std::string measure(const std::string& name, std::function<void()> prepare, std::function<void(std::ostream&, std::istream&)> execute,
+        const std::string& input, int iterations, std::ostream& report, const std::string* expectedOutput)
+    {
+        auto prepareStart = std::chrono::steady_clock::now();
+        prepare();
+        auto prepareEnd = std::chrono::steady_clock::now();
+
+        std::string output;
+        for (int i = 0; i < iterations; i++)
+        {
+            std::ostringstream out;
+            std::istringstream in(input);
+
+            execute(out, in);
+
+            output = out.str();
+        }
+        auto executeEnd = std::chrono::steady_clock::now();
+
+        double prepareMs = std::chrono::duration<double, std::milli>(prepareEnd - prepareStart).count();
+        double executeMs = std::chrono::duration<double, std::milli>(executeEnd - prepareEnd).count();
+
+        report << name << ": prepare " << prepareMs << " ms, execute " << executeMs / iterations << " ms per run"
+            << (expectedOutput == nullptr || output == *expectedOutput ? "" : " (OUTPUT DIFFERS)") << std::endl;
+
+        return output;
+    }
+}
+
+void Benchmark::run(const Node& treeRoot, const std::string& input, int iterations, std::ostream& report)
+{
+    std::string expectedOutput = measure("tree", []() {}, [&treeRoot](std::ostream& out, std::istream& in)
+    {
+        Executor::execute(treeRoot, out, in);
+    }, input, iterations, report, nullptr);
+
+    // The compiled engines work on the arena AST
+    Ast ast(treeRoot);
+
+    Bytecode bytecode;
+    measure("vm", [&ast, &bytecode]()
+    {
+        bytecode = BytecodeCompiler::compile(ast);
+    }, [&bytecode](std::ostream& out, std::istream& in)
+    {
+        VirtualMachine::execute(bytecode, out, in);
+    }, input, iterations, report, &expectedOutput);
+
+    ClosureProgram closureProgram;
+    measure("closure", [&ast, &closureProgram]()
+    {
+        closureProgram = ClosureExecutor::compile(ast);
+    }, [&closureProgram](std::ostream& out, std::istream& in)
+    {
+        ClosureExecutor::execute(closureProgram, out, in);
+    }, input, iterations, report, &expectedOutput);
+
+    JitProgram jitProgram;
+    bool isJitCompiled = false;
+    measure("jit", [&ast, &jitProgram, &isJitCompiled]()
+    {
+        isJitCompiled = JitCompiler::compile(ast, jitProgram);
+    }, [&jitProgram, &isJitCompiled, &bytecode](std::ostream& out, std::istream& in)
+    {
+        // Programs the JIT can't compile are executed by the virtual machine
+        if (isJitCompiled)
+        {
+            JitCompiler::execute(jitProgram, out, in);
+        }
+        else
+        {
+            VirtualMachine::execute(bytecode, out, in);
+        }
+    }, input, iterations, report, &expectedOutput);
+
+    if (!isJitCompiled)
+    {
+        report << "jit: the program is executed by the vm" << std::endl;
+    }
+
+    // The tiered executor keeps its counters between the runs, so the hot code is promoted during the benchmark
+    TieredExecutor tieredExecutor(ast);
+    measure("tiered", []() {}, [&tieredExecutor](std::ostream& out, std::istream& in)
+    {
+        tieredExecutor.execute(out, in);
+    }, input, iterations, report, &expectedOutput);
+
+    tieredExecutor.printStats(report);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Node.h"
+#include <iostream>
+#include <string>
+
+/// @brief Class with methods for comparing the execution engines
+class Benchmark
+{
+public:
+    /// @brief Executes the AST with every execution engine and reports the times
+    /// @param treeRoot The root node of the AST
+    /// @param input The text given as input to every run
+    /// @param iterations The number of runs per engine
+    /// @param report The stream the results are written to
+    static void run(const Node& treeRoot, const std::string& input, int iterations, std::ostream& report);
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "Instruction.h"
+#include "DivisionByConstant.h"
+#include <vector>
+#include <string>
+
+/// @brief Function entry in the bytecode function table
+class BytecodeFunction
+{
+public:
+    /// @brief The name of the function
+    std::string name;
+    /// @brief Index of the first instruction of the function body
+    int entry;
+    /// @brief Constructor for creating a function entry by name
+    /// @param name The function name
+    BytecodeFunction(std::string name) : name(name), entry(-1) {}
+};
+
+/// @brief Linear program produced from the AST and executed by the virtual machine
+class Bytecode
+{
+public:
+    /// @brief The instructions (the main program starts at index 0, function bodies follow after it)
+    std::vector<Instruction> instructions;
+    /// @brief The number constants used by the program
+    std::vector<long long> constants;
+    /// @brief The precomputed constant divisors used by the program
+    std::vector<DivisionByConstant> divisors;
+    /// @brief Names of the global variables by slot
+    std::vector<std::string> globals;
+    /// @brief The function table
+    std::vector<BytecodeFunction> functions;
+    /// @brief The maximum depth the value stack can reach
+    int maxStackDepth = 0;
+    /// @brief True if the semantic analysis found no errors, so the instructions don't check the definitions
+    bool isAnalyzed = false;
+};
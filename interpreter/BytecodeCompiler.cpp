@@ -0,0 +1,175 @@
+#include "BytecodeCompiler.h"
+#include "SemanticAnalyzer.h"
+
+#include <stack>
+#include <stdexcept>
+
+Bytecode BytecodeCompiler::compile(const Node& treeRoot)
+{
+    return compile(Ast(treeRoot));
+}
+
+Bytecode BytecodeCompiler::compile(const Ast& ast)
+{
+    Bytecode bytecode;
+
+    // Every global and function of an analyzed program is defined before it is used, so the definitions aren't tracked
+    bytecode.isAnalyzed = SemanticAnalyzer::isSafe(ast);
+
+    // The names are already interned by the AST, so the symbol ids are the global slots and the function indexes
+    bytecode.globals = ast.variables;
+    for (const std::string& function : ast.functions)
+    {
+        bytecode.functions.push_back(BytecodeFunction(function));
+    }
+
+    // Function definitions whose bodies are emitted after the main program
+    std::vector<int> functionDefinitions;
+
+    const AstNode& root = ast.nodes[ast.root];
+    for (int i = 0; i < root.childCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+        const AstNode& statementNode = ast.nodes[statement];
+
+        switch (statementNode.type)
+        {
+        case NodeType::operation_assign:
+            emitExpression(ast, ast.getChild(statement, 1), -1, bytecode);
+            bytecode.instructions.push_back(Instruction(OpCode::store_global, (int)ast.nodes[ast.getChild(statement, 0)].value));
+            break;
+        case NodeType::operation_read:
+            bytecode.instructions.push_back(Instruction(OpCode::read_global, (int)ast.nodes[ast.getChild(statement, 0)].value));
+            break;
+        case NodeType::operation_print:
+            emitExpression(ast, ast.getChild(statement, 0), -1, bytecode);
+            bytecode.instructions.push_back(Instruction(OpCode::print));
+            break;
+        case NodeType::define_function:
+        {
+            // Only the first definition of a function can be called,
+            // every other definition fails when executed
+            int functionIndex = (int)statementNode.value;
+            if (bytecode.functions[functionIndex].entry < 0)
+            {
+                bytecode.functions[functionIndex].entry = 0;
+                functionDefinitions.push_back(statement);
+            }
+            if (!bytecode.isAnalyzed)
+            {
+                bytecode.instructions.push_back(Instruction(OpCode::define_function, functionIndex));
+            }
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    bytecode.instructions.push_back(Instruction(OpCode::halt));
+
+    for (int definition : functionDefinitions)
+    {
+        bytecode.functions[ast.nodes[definition].value].entry = (int)bytecode.instructions.size();
+
+        emitExpression(ast, ast.getChild(definition, 1), ast.nodes[ast.getChild(definition, 0)].value, bytecode);
+        bytecode.instructions.push_back(Instruction(OpCode::return_value));
+    }
+
+    return bytecode;
+}
+
+void BytecodeCompiler::emitExpression(const Ast& ast, int expression, long long parameter, Bytecode& bytecode)
+{
+    // Emit the nodes in post order with an iterative dfs (the operands are emitted before their operator)
+    // The flag shows whether the children of the node are already emitted
+    std::stack<std::pair<int, bool>> emitStack;
+    emitStack.push(std::pair<int, bool>(expression, false));
+
+    int stackDepth = 0;
+
+    // Divisions by a constant don't push the divisor, they use a precomputed divisor instead
+    auto isConstantDivision = [&ast](int node) -> bool
+    {
+        const AstNode& astNode = ast.nodes[node];
+        if (astNode.type != NodeType::operation_divide && astNode.type != NodeType::operation_modulo)
+        {
+            return false;
+        }
+
+        const AstNode& rightNode = ast.nodes[ast.getChild(node, 1)];
+        return rightNode.type == NodeType::number && DivisionByConstant::isReducible(rightNode.value);
+    };
+
+    while (!emitStack.empty())
+    {
+        int currIndex = emitStack.top().first;
+        const AstNode* currNode = &ast.nodes[currIndex];
+        bool childrenEmitted = emitStack.top().second;
+        emitStack.pop();
+
+        if (!childrenEmitted && currNode->childCount > 0)
+        {
+            emitStack.push(std::pair<int, bool>(currIndex, true));
+            for (int i = isConstantDivision(currIndex) ? 0 : currNode->childCount - 1; i >= 0; i--)
+            {
+                emitStack.push(std::pair<int, bool>(ast.getChild(currIndex, i), false));
+            }
+            continue;
+        }
+
+        switch (currNode->type)
+        {
+        case NodeType::number:
+            bytecode.constants.push_back(currNode->value);
+            bytecode.instructions.push_back(Instruction(OpCode::push_constant, (int)bytecode.constants.size() - 1));
+            stackDepth++;
+            break;
+        case NodeType::variable:
+            if (currNode->value == parameter)
+            {
+                bytecode.instructions.push_back(Instruction(OpCode::load_parameter));
+            }
+            else
+            {
+                bytecode.instructions.push_back(Instruction(bytecode.isAnalyzed ? OpCode::load_defined_global : OpCode::load_global, (int)currNode->value));
+            }
+            stackDepth++;
+            break;
+        case NodeType::operation_add:
+            bytecode.instructions.push_back(Instruction(OpCode::add));
+            stackDepth--;
+            break;
+        case NodeType::operation_subtract:
+            bytecode.instructions.push_back(Instruction(OpCode::subtract));
+            stackDepth--;
+            break;
+        case NodeType::operation_multipy:
+            bytecode.instructions.push_back(Instruction(OpCode::multiply));
+            stackDepth--;
+            break;
+        case NodeType::operation_divide:
+        case NodeType::operation_modulo:
+            if (isConstantDivision(currIndex))
+            {
+                bytecode.divisors.push_back(DivisionByConstant(ast.nodes[ast.getChild(currIndex, 1)].value));
+                bytecode.instructions.push_back(Instruction(currNode->type == NodeType::operation_divide ? OpCode::divide_constant : OpCode::modulo_constant,
+                    (int)bytecode.divisors.size() - 1));
+            }
+            else
+            {
+                bytecode.instructions.push_back(Instruction(currNode->type == NodeType::operation_divide ? OpCode::divide : OpCode::modulo));
+                stackDepth--;
+            }
+            break;
+        case NodeType::function:
+            // The argument is on the stack and is replaced by the result
+            bytecode.instructions.push_back(Instruction(bytecode.isAnalyzed ? OpCode::call_defined : OpCode::call, (int)currNode->value));
+            break;
+        default:
+            throw std::invalid_argument("Unexpected node in expression");
+        }
+
+        bytecode.maxStackDepth = std::max(bytecode.maxStackDepth, stackDepth);
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Node.h"
+#include "Ast.h"
+#include "Bytecode.h"
+
+/// @brief Class with methods that lower an AST to bytecode
+class BytecodeCompiler
+{
+public:
+    /// @brief Lowers the AST to bytecode
+    /// @param treeRoot The root node of the AST
+    /// @return The bytecode of the program
+    static Bytecode compile(const Node& treeRoot);
+
+    /// @brief Lowers the arena AST to bytecode (the variable symbol ids are used as global slots)
+    /// @param ast The arena AST
+    /// @return The bytecode of the program
+    static Bytecode compile(const Ast& ast);
+
+private:
+    /// @brief Emits the instructions of an expression (in post order)
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param bytecode The bytecode to emit to
+    static void emitExpression(const Ast& ast, int expression, long long parameter, Bytecode& bytecode);
+};
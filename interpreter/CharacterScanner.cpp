@@ -0,0 +1,164 @@
+#include "CharacterScanner.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CHARACTER_SCANNER_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace
+{
+#ifdef CHARACTER_SCANNER_SIMD
+#ifdef _MSC_VER
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+    /// @brief Gets the index of the lowest set bit
+    /// @param mask The bits (not zero)
+    /// @return The index of the bit
+    int countTrailingZeros(unsigned int mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (int)index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    /// @brief Finds the end of a run of characters in a range 16 characters at a time
+    /// @return The index of the first character after the run, or the index of the first block that can't be read whole
+    int skipRangeSse2(const char* text, int position, int readable, char first, char last)
+    {
+        // The characters of the ranges are below 127, so the signed comparisons can be used (the characters above 127 are negative)
+        __m128i below = _mm_set1_epi8(first - 1);
+        __m128i above = _mm_set1_epi8(last + 1);
+
+        while (position + 16 <= readable)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i*)(text + position));
+            __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(block, below), _mm_cmplt_epi8(block, above));
+
+            unsigned int outside = ~(unsigned int)_mm_movemask_epi8(inRange) & 0xFFFF;
+            if (outside != 0)
+            {
+                return position + countTrailingZeros(outside);
+            }
+
+            position += 16;
+        }
+
+        return position;
+    }
+
+    /// @brief Finds the end of a run of characters in a range 32 characters at a time
+    /// @return The index of the first character after the run, or the index of the first block that can't be read whole
+    TARGET_AVX2 int skipRangeAvx2(const char* text, int position, int readable, char first, char last)
+    {
+        __m256i below = _mm256_set1_epi8(first - 1);
+        __m256i above = _mm256_set1_epi8(last + 1);
+
+        while (position + 32 <= readable)
+        {
+            __m256i block = _mm256_loadu_si256((const __m256i*)(text + position));
+            __m256i inRange = _mm256_and_si256(_mm256_cmpgt_epi8(block, below), _mm256_cmpgt_epi8(above, block));
+
+            unsigned int outside = ~(unsigned int)_mm256_movemask_epi8(inRange);
+            if (outside != 0)
+            {
+                return position + countTrailingZeros(outside);
+            }
+
+            position += 32;
+        }
+
+        return position;
+    }
+#endif
+
+    /// @brief Finds the best instruction set the CPU and the operating system support
+    /// @return The instruction set
+    ScanLevel detectLevel()
+    {
+#ifdef CHARACTER_SCANNER_SIMD
+#ifdef _MSC_VER
+        // AVX2 needs the CPU flag and the operating system saving the YMM registers
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7)
+        {
+            __cpuid(info, 1);
+            bool hasAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+
+            __cpuidex(info, 7, 0);
+            if (hasAvx && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 6) == 6)
+            {
+                return ScanLevel::avx2;
+            }
+        }
+        return ScanLevel::sse2;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? ScanLevel::avx2 : ScanLevel::sse2;
+#endif
+#else
+        return ScanLevel::scalar;
+#endif
+    }
+
+    /// @brief The best instruction set the CPU supports
+    const ScanLevel supportedLevel = detectLevel();
+
+    /// @brief The instruction set used for scanning
+    ScanLevel currentLevel = supportedLevel;
+}
+
+int CharacterScanner::skipRange(const char* text, int start, int length, int readable, char first, char last)
+{
+    int position = start;
+
+#ifdef CHARACTER_SCANNER_SIMD
+    if (currentLevel == ScanLevel::avx2)
+    {
+        position = skipRangeAvx2(text, position, readable, first, last);
+    }
+    else if (currentLevel == ScanLevel::sse2)
+    {
+        position = skipRangeSse2(text, position, readable, first, last);
+    }
+
+    // The blocks can go past the length when more text can be read
+    if (position > length)
+    {
+        position = length;
+    }
+#endif
+
+    // The characters that are not in a whole block are scanned one at a time
+    while (position < length && text[position] >= first && text[position] <= last)
+    {
+        position++;
+    }
+
+    return position;
+}
+
+ScanLevel CharacterScanner::getLevel()
+{
+    return currentLevel;
+}
+
+void CharacterScanner::setLevel(ScanLevel level)
+{
+    currentLevel = level < supportedLevel ? level : supportedLevel;
+}
+
+ScanLevel CharacterScanner::getSupportedLevel()
+{
+    return supportedLevel;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+/// @brief The instruction sets the character scanner can use
+enum class ScanLevel
+{
+    scalar,
+    sse2,
+    avx2,
+};
+
+/// @brief Class with methods for finding the end of runs of characters with vector instructions (16 or 32 characters at a time)
+class CharacterScanner
+{
+public:
+    /// @brief Finds the end of a run of characters in a range
+    /// @param text The text to search
+    /// @param start The index of the first character of the run
+    /// @param length The number of characters the run can have (the run ends at this index)
+    /// @param readable The number of characters that can be read, blocks are read up to it even if it is after the length
+    /// @param first The first character of the range
+    /// @param last The last character of the range
+    /// @return The index of the first character after the run
+    static int skipRange(const char* text, int start, int length, int readable, char first, char last);
+
+    /// @brief Gets the instruction set used for scanning
+    /// @return The instruction set (chosen from the CPU when the program starts)
+    static ScanLevel getLevel();
+
+    /// @brief Sets the instruction set used for scanning, the levels the CPU doesn't support are lowered to the best supported one
+    /// @param level The instruction set
+    static void setLevel(ScanLevel level);
+
+    /// @brief Gets the best instruction set the CPU supports
+    /// @return The instruction set
+    static ScanLevel getSupportedLevel();
+};
@@ -0,0 +1,389 @@
+#include "ClosureExecutor.h"
+#include "Executor.h"
+#include "SemanticAnalyzer.h"
+#include "DivisionByConstant.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    /// @brief Creates the closure of a binary operation
+    /// @tparam Operation Functor type computing the operation
+    /// @param left The closure of the left operand
+    /// @param right The closure of the right operand
+    /// @param rightNode The node of the right operand (used to specialize constant operands)
+    /// @return The closure of the operation
+    template <typename Operation>
+    ClosureExpression makeBinaryOperation(ClosureExpression left, ClosureExpression right, const AstNode& rightNode)
+    {
+        // Constant right operands are very common (x * 2, n % 10), so they are bound directly
+        if (rightNode.type == NodeType::number)
+        {
+            long long constant = rightNode.value;
+            return [left = std::move(left), constant](ClosureContext& context) -> long long
+            {
+                return Operation()(left(context), constant);
+            };
+        }
+
+        return [left = std::move(left), right = std::move(right)](ClosureContext& context) -> long long
+        {
+            long long leftValue = left(context);
+            return Operation()(leftValue, right(context));
+        };
+    }
+
+    /// @brief The maximum nesting of the closures of an expression, the deeper subexpressions are computed first
+    /// and their values are stored in the context, so executing and destroying the closures doesn't overflow the native stack
+    const int maxClosureDepth = 256;
+
+    /// @brief The closure of a compiled subexpression
+    class CompiledExpression
+    {
+    public:
+        /// @brief The closure computing the subexpression
+        ClosureExpression closure;
+        /// @brief The nesting depth of the closure
+        int depth = 1;
+    };
+
+    struct Add { long long operator()(long long left, long long right) const { return left + right; } };
+    struct Subtract { long long operator()(long long left, long long right) const { return left - right; } };
+    struct Multiply { long long operator()(long long left, long long right) const { return left * right; } };
+    struct Divide { long long operator()(long long left, long long right) const { return left / right; } };
+    struct Modulo { long long operator()(long long left, long long right) const { return left % right; } };
+}
+
+ClosureContext::ClosureContext(const ClosureProgram& program, std::ostream& out, std::istream& in)
+    : program(&program), globals(program.globals.size(), 0), definedGlobals(program.globals.size(), 0),
+    definedFunctions(program.functions.size(), 0), out(&out), in(&in)
+{
+}
+
+ClosureProgram::ClosureProgram(const Ast& ast)
+    : globals(ast.variables), functions(ast.functions), functionBodies(ast.functions.size()), isAnalyzed(SemanticAnalyzer::isSafe(ast))
+{
+}
+
+ClosureProgram ClosureExecutor::compile(const Node& treeRoot)
+{
+    return compile(Ast(treeRoot));
+}
+
+ClosureProgram ClosureExecutor::compile(const Ast& ast)
+{
+    ClosureProgram program(ast);
+
+    // Function definitions whose bodies are converted after the main program
+    std::vector<int> functionDefinitions;
+    std::vector<char> functionsWithBody(ast.functions.size(), 0);
+
+    const AstNode& root = ast.nodes[ast.root];
+    for (int i = 0; i < root.childCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+
+        program.statements.push_back(compileStatement(ast, statement, program));
+
+        // Only the first definition of a function can be called,
+        // every other definition fails when executed
+        const AstNode& statementNode = ast.nodes[statement];
+        if (statementNode.type == NodeType::define_function && !functionsWithBody[statementNode.value])
+        {
+            functionsWithBody[statementNode.value] = 1;
+            functionDefinitions.push_back(statement);
+        }
+    }
+
+    for (int definition : functionDefinitions)
+    {
+        program.functionBodies[ast.nodes[definition].value] = compileExpression(ast, ast.getChild(definition, 1),
+            ast.nodes[ast.getChild(definition, 0)].value, program);
+    }
+
+    return program;
+}
+
+ClosureStatement ClosureExecutor::compileStatement(const Ast& ast, int statement, ClosureProgram& program)
+{
+    const AstNode& statementNode = ast.nodes[statement];
+
+    switch (statementNode.type)
+    {
+    case NodeType::operation_assign:
+    {
+        int slot = (int)ast.nodes[ast.getChild(statement, 0)].value;
+        ClosureExpression value = compileExpression(ast, ast.getChild(statement, 1), -1, program);
+
+        return [slot, value](ClosureContext& context)
+        {
+            context.globals[slot] = value(context);
+            context.definedGlobals[slot] = 1;
+        };
+    }
+    case NodeType::operation_read:
+    {
+        int slot = (int)ast.nodes[ast.getChild(statement, 0)].value;
+
+        return [slot](ClosureContext& context)
+        {
+            context.globals[slot] = Executor::readNumber(*context.in);
+            context.definedGlobals[slot] = 1;
+        };
+    }
+    case NodeType::operation_print:
+    {
+        ClosureExpression value = compileExpression(ast, ast.getChild(statement, 0), -1, program);
+
+        return [value](ClosureContext& context)
+        {
+            *context.out << value(context) << '\n';
+        };
+    }
+    case NodeType::define_function:
+    {
+        // The calls of an analyzed program don't check the definitions, so they aren't tracked
+        if (program.isAnalyzed)
+        {
+            return [](ClosureContext&) {};
+        }
+
+        int index = (int)statementNode.value;
+
+        return [index](ClosureContext& context)
+        {
+            if (context.definedFunctions[index])
+            {
+                throw std::invalid_argument("Function " + context.program->functions[index] + " already defined!");
+            }
+            context.definedFunctions[index] = 1;
+        };
+    }
+    default:
+        return [](ClosureContext&) {};
+    }
+}
+
+void ClosureExecutor::execute(const ClosureProgram& program)
+{
+    execute(program, std::cout, std::cin);
+}
+
+void ClosureExecutor::execute(const ClosureProgram& program, std::ostream& out, std::istream& in)
+{
+    ClosureContext context(program, out, in);
+
+    for (const ClosureStatement& statement : program.statements)
+    {
+        statement(context);
+    }
+
+    out.flush();
+}
+
+ClosureExpression ClosureExecutor::compileExpression(const Ast& ast, int expression, long long parameter, ClosureProgram& program)
+{
+    // The closures of the finished subexpressions (in post-order) and the subexpressions computed before the expression
+    std::vector<CompiledExpression> compiled;
+    std::vector<ClosureStatement> steps;
+    int slotCount = 0;
+    // The closures below this index are already moved to the steps
+    size_t firstKept = 0;
+
+    // The closures are built from an explicit stack, so deep expressions don't overflow the native stack
+    std::vector<std::pair<int, bool>> stack = { { expression, false } };
+    while (!stack.empty())
+    {
+        int node = stack.back().first;
+        bool isVisited = stack.back().second;
+        stack.pop_back();
+
+        const AstNode& expressionNode = ast.nodes[node];
+
+        if (!isVisited && expressionNode.childCount > 0)
+        {
+            stack.push_back({ node, true });
+            for (int i = expressionNode.childCount - 1; i >= 0; i--)
+            {
+                stack.push_back({ ast.getChild(node, i), false });
+            }
+            continue;
+        }
+
+        CompiledExpression result;
+
+        switch (expressionNode.type)
+        {
+        case NodeType::number:
+        {
+            long long value = expressionNode.value;
+            result.closure = [value](ClosureContext&) -> long long { return value; };
+        }
+        break;
+        case NodeType::variable:
+        {
+            int slot = (int)expressionNode.value;
+            if (expressionNode.value == parameter)
+            {
+                result.closure = [](ClosureContext& context) -> long long { return context.parameter; };
+            }
+            else if (program.isAnalyzed)
+            {
+                result.closure = [slot](ClosureContext& context) -> long long { return context.globals[slot]; };
+            }
+            else
+            {
+                result.closure = [slot](ClosureContext& context) -> long long
+                {
+                    if (!context.definedGlobals[slot])
+                    {
+                        throw std::invalid_argument("Use of undefined variable '" + context.program->globals[slot] + "'");
+                    }
+                    return context.globals[slot];
+                };
+            }
+        }
+        break;
+        case NodeType::operation_add:
+        case NodeType::operation_subtract:
+        case NodeType::operation_multipy:
+        case NodeType::operation_divide:
+        case NodeType::operation_modulo:
+        {
+            CompiledExpression right = std::move(compiled.back());
+            compiled.pop_back();
+            CompiledExpression left = std::move(compiled.back());
+            compiled.pop_back();
+
+            const AstNode& rightNode = ast.nodes[ast.getChild(node, 1)];
+            result.depth = std::max(left.depth, right.depth) + 1;
+
+            // Divisions by a constant are computed with the precomputed multiplier and shift
+            if ((expressionNode.type == NodeType::operation_divide || expressionNode.type == NodeType::operation_modulo)
+                && rightNode.type == NodeType::number && DivisionByConstant::isReducible(rightNode.value))
+            {
+                ClosureExpression leftClosure = std::move(left.closure);
+                DivisionByConstant divisor(rightNode.value);
+
+                if (expressionNode.type == NodeType::operation_divide)
+                {
+                    result.closure = [leftClosure = std::move(leftClosure), divisor](ClosureContext& context) -> long long { return divisor.divide(leftClosure(context)); };
+                }
+                else
+                {
+                    result.closure = [leftClosure = std::move(leftClosure), divisor](ClosureContext& context) -> long long { return divisor.modulo(leftClosure(context)); };
+                }
+                break;
+            }
+
+            switch (expressionNode.type)
+            {
+            case NodeType::operation_add: result.closure = makeBinaryOperation<Add>(std::move(left.closure), std::move(right.closure), rightNode); break;
+            case NodeType::operation_subtract: result.closure = makeBinaryOperation<Subtract>(std::move(left.closure), std::move(right.closure), rightNode); break;
+            case NodeType::operation_multipy: result.closure = makeBinaryOperation<Multiply>(std::move(left.closure), std::move(right.closure), rightNode); break;
+            case NodeType::operation_divide: result.closure = makeBinaryOperation<Divide>(std::move(left.closure), std::move(right.closure), rightNode); break;
+            default: result.closure = makeBinaryOperation<Modulo>(std::move(left.closure), std::move(right.closure), rightNode); break;
+            }
+        }
+        break;
+        case NodeType::function:
+        {
+            int index = (int)expressionNode.value;
+            ClosureExpression argument = std::move(compiled.back().closure);
+            result.depth = compiled.back().depth + 1;
+            compiled.pop_back();
+
+            if (program.isAnalyzed)
+            {
+                result.closure = [index, argument = std::move(argument)](ClosureContext& context) -> long long
+                {
+                    long long argumentValue = argument(context);
+
+                    long long callerParameter = context.parameter;
+                    context.parameter = argumentValue;
+
+                    long long result = context.program->functionBodies[index](context);
+
+                    context.parameter = callerParameter;
+
+                    return result;
+                };
+            }
+            else
+            {
+                result.closure = [index, argument = std::move(argument)](ClosureContext& context) -> long long
+                {
+                    long long argumentValue = argument(context);
+
+                    if (!context.definedFunctions[index])
+                    {
+                        throw std::invalid_argument("Function " + context.program->functions[index] + " is not defined!");
+                    }
+
+                    long long callerParameter = context.parameter;
+                    context.parameter = argumentValue;
+
+                    long long result = context.program->functionBodies[index](context);
+
+                    context.parameter = callerParameter;
+
+                    return result;
+                };
+            }
+        }
+        break;
+        default:
+            throw std::invalid_argument("Unexpected node in expression");
+        }
+
+        compiled.push_back(std::move(result));
+        firstKept = std::min(firstKept, compiled.size() - 1);
+
+        // Every finished closure before a too deep one is computed earlier in post-order,
+        // so they are all moved to the steps in order and the error of the first failing subexpression is still reported first
+        if (compiled.back().depth >= maxClosureDepth)
+        {
+            for (size_t i = firstKept; i < compiled.size(); i++)
+            {
+                int slot = slotCount++;
+                steps.push_back([slot, closure = std::move(compiled[i].closure)](ClosureContext& context)
+                {
+                    // The value is computed first, because the calls in the closure can move the stored values
+                    long long value = closure(context);
+                    context.spilledValues[context.spillBase + slot] = value;
+                });
+
+                compiled[i].closure = [slot](ClosureContext& context) -> long long { return context.spilledValues[context.spillBase + slot]; };
+                compiled[i].depth = 1;
+            }
+            firstKept = compiled.size();
+        }
+    }
+
+    ClosureExpression closure = std::move(compiled.back().closure);
+    if (steps.empty())
+    {
+        return closure;
+    }
+
+    // Every evaluation of the expression has its own stored values, so the calls of the functions with deep bodies don't overwrite them
+    return [steps = std::move(steps), closure = std::move(closure), slotCount](ClosureContext& context) -> long long
+    {
+        size_t callerBase = context.spillBase;
+        context.spillBase = context.spilledValues.size();
+        context.spilledValues.resize(context.spillBase + slotCount);
+
+        for (const ClosureStatement& step : steps)
+        {
+            step(context);
+        }
+        long long result = closure(context);
+
+        context.spilledValues.resize(context.spillBase);
+        context.spillBase = callerBase;
+
+        return result;
+    };
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Node.h"
+#include "Ast.h"
+#include <functional>
+#include <iostream>
+
+class ClosureProgram;
+
+/// @brief Runtime state shared by the closures of a program
+class ClosureContext
+{
+public:
+    /// @brief Constructor for creating the state of a new run of a program
+    /// @param program The program that is executed
+    /// @param out The output stream
+    /// @param in The input stream
+    ClosureContext(const ClosureProgram& program, std::ostream& out, std::istream& in);
+
+    /// @brief The program that is executed
+    const ClosureProgram* program;
+    /// @brief Values of the global variables by slot
+    std::vector<long long> globals;
+    /// @brief Flags showing which global variables are assigned
+    std::vector<char> definedGlobals;
+    /// @brief Flags showing which functions are defined
+    std::vector<char> definedFunctions;
+    /// @brief The parameter of the currently executed function
+    long long parameter = 0;
+    /// @brief The values of the subexpressions computed before the too deep expressions (one block for every evaluation in progress)
+    std::vector<long long> spilledValues;
+    /// @brief The start of the block of the currently evaluated deep expression
+    size_t spillBase = 0;
+    /// @brief The output stream
+    std::ostream* out;
+    /// @brief The input stream
+    std::istream* in;
+};
+
+/// @brief Pre-resolved expression that computes its value
+typedef std::function<long long(ClosureContext&)> ClosureExpression;
+
+/// @brief Pre-resolved statement that executes itself
+typedef std::function<void(ClosureContext&)> ClosureStatement;
+
+/// @brief Program where every node of the AST is converted to a closure
+class ClosureProgram
+{
+public:
+    /// @brief The statements of the program in execution order
+    std::vector<ClosureStatement> statements;
+    /// @brief Names of the global variables by slot
+    std::vector<std::string> globals;
+    /// @brief Names of the functions by index
+    std::vector<std::string> functions;
+    /// @brief Bodies of the functions by index
+    std::vector<ClosureExpression> functionBodies;
+    /// @brief True if the semantic analysis found no errors, so the closures don't check the definitions
+    bool isAnalyzed = false;
+
+    /// @brief Base constructor for an empty program
+    ClosureProgram() {}
+
+    /// @brief Constructor for creating a program without statements with the symbols of an AST and the result of its semantic analysis
+    /// (the variable symbol ids are the global slots and the function symbol ids are the function indexes)
+    /// @param ast The arena AST
+    explicit ClosureProgram(const Ast& ast);
+};
+
+/// @brief Class with methods that convert an AST to closures and execute them
+class ClosureExecutor
+{
+public:
+    /// @brief Converts the AST to a closure program
+    /// @param treeRoot The root node of the AST
+    /// @return The closure program
+    static ClosureProgram compile(const Node& treeRoot);
+
+    /// @brief Converts the arena AST to a closure program
+    /// @param ast The arena AST
+    /// @return The closure program
+    static ClosureProgram compile(const Ast& ast);
+
+    /// @brief Executes a closure program using the console output and input streams
+    /// @param program The closure program
+    static void execute(const ClosureProgram& program);
+
+    /// @brief Executes a closure program using the given output and input streams
+    /// @param program The closure program
+    /// @param out The output stream
+    /// @param in The input stream
+    static void execute(const ClosureProgram& program, std::ostream& out, std::istream& in);
+
+    /// @brief Converts a statement to a closure (a function definition is converted only to the check that it is defined once)
+    /// @param ast The arena AST
+    /// @param statement The index of the statement node
+    /// @param program The closure program with the variable and function tables
+    /// @return The closure of the statement
+    static ClosureStatement compileStatement(const Ast& ast, int statement, ClosureProgram& program);
+
+    /// @brief Converts an expression to a closure, the closures are built from an iterative post-order.
+    /// The closures are nested at most a few hundred levels, the deeper subexpressions are computed in order before the expression
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param program The closure program with the variable and function tables
+    /// @return The closure of the expression
+    static ClosureExpression compileExpression(const Ast& ast, int expression, long long parameter, ClosureProgram& program);
+};
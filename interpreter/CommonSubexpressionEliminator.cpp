@@ -0,0 +1,425 @@
+#include "CommonSubexpressionEliminator.h"
+#include "UsageAnalysis.h"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+namespace
+{
+    /// @brief The contents of a node with the merged indexes of its children, identical nodes have equal keys
+    class NodeKey
+    {
+    public:
+        NodeType type;
+        long long value;
+        std::vector<int> children;
+
+        bool operator==(const NodeKey& other) const
+        {
+            return type == other.type && value == other.value && children == other.children;
+        }
+    };
+
+    /// @brief Hash of a node key, combined the same way as the hash of the Node
+    class NodeKeyHash
+    {
+    public:
+        std::size_t operator()(const NodeKey& key) const
+        {
+            std::size_t hash = (std::hash<int>()((int)key.type) ^ (std::hash<long long>()(key.value) << 1)) >> 1;
+            for (int child : key.children)
+            {
+                hash = (hash * 31) ^ std::hash<int>()(child);
+            }
+
+            return hash;
+        }
+    };
+
+    /// @brief A range of statements where a subexpression keeps its value (none of its inputs is assigned)
+    class Window
+    {
+    public:
+        /// @brief The index of the subexpression node
+        int node;
+        /// @brief The number of times the subexpression is computed in the range
+        int count;
+        /// @brief The position of the statement that starts the range
+        int start;
+        /// @brief The symbol id of the hidden global with the value (-1 until it is assigned)
+        int temporary = -1;
+
+        Window(int node, int start) : node(node), count(1), start(start) {}
+    };
+
+    /// @brief What the first pass needs to know about the subexpressions of a statement,
+    /// computed bottom-up once per statement, so every node is visited once
+    class SubexpressionFacts
+    {
+    public:
+        /// @brief Flags showing which subexpressions can fail with a runtime error
+        std::vector<char> canFail;
+        /// @brief Flags showing which subexpressions call only defined functions that aren't recursive
+        std::vector<char> hasUses;
+        /// @brief The position of the last statement that assigned a global used by every subexpression (-1 if there is none)
+        std::vector<int> lastAssignments;
+        /// @brief The position of the statement whose walk computed the facts of every node
+        std::vector<int> stamps;
+        /// @brief The position of the last statement that assigned a global used by every function, for the current statement
+        std::vector<int> functionAssignments;
+        /// @brief The position of the statement whose walk computed the last assignment of every function
+        std::vector<int> functionStamps;
+
+        SubexpressionFacts(const Ast& ast)
+            : canFail(ast.nodes.size(), 0), hasUses(ast.nodes.size(), 0), lastAssignments(ast.nodes.size(), -1), stamps(ast.nodes.size(), -1),
+            functionAssignments(ast.functions.size(), -1), functionStamps(ast.functions.size(), -1) {}
+    };
+
+    /// @brief Computes the facts of the nodes of an expression of the main program in post order (a shared node is computed once)
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param position The position of the statement of the expression
+    /// @param analysis The usage analysis of the program
+    /// @param definedGlobals Flags showing which globals are surely assigned before the statement
+    /// @param safeFunctions Flags showing which functions are surely defined and can't fail
+    /// @param globalAssignments The position of the last statement that assigned every global (-1 if there is none)
+    /// @param facts The facts that get the facts of the nodes
+    void computeFacts(const Ast& ast, int expression, int position, UsageAnalysis& analysis, const std::vector<char>& definedGlobals,
+        const std::vector<char>& safeFunctions, const std::vector<int>& globalAssignments, SubexpressionFacts& facts)
+    {
+        // The flag shows whether the children of the node are already computed
+        std::vector<std::pair<int, bool>> walkStack{ std::pair<int, bool>(expression, false) };
+        while (!walkStack.empty())
+        {
+            int node = walkStack.back().first;
+            bool childrenComputed = walkStack.back().second;
+
+            if (!childrenComputed)
+            {
+                if (facts.stamps[node] == position)
+                {
+                    walkStack.pop_back();
+                    continue;
+                }
+                facts.stamps[node] = position;
+
+                walkStack.back().second = true;
+                for (int i = ast.nodes[node].childCount - 1; i >= 0; i--)
+                {
+                    walkStack.push_back(std::pair<int, bool>(ast.getChild(node, i), false));
+                }
+                continue;
+            }
+            walkStack.pop_back();
+
+            const AstNode& currNode = ast.nodes[node];
+            bool canFail = false;
+            bool hasUses = true;
+            int lastAssignment = -1;
+            for (int i = 0; i < currNode.childCount; i++)
+            {
+                int child = ast.getChild(node, i);
+                canFail = canFail || facts.canFail[child];
+                hasUses = hasUses && facts.hasUses[child];
+                lastAssignment = std::max(lastAssignment, facts.lastAssignments[child]);
+            }
+
+            switch (currNode.type)
+            {
+            case NodeType::variable:
+                canFail = !definedGlobals[currNode.value];
+                lastAssignment = globalAssignments[currNode.value];
+                break;
+            case NodeType::function:
+            {
+                int function = (int)currNode.value;
+                canFail = canFail || !safeFunctions[function];
+
+                const Uses* uses = analysis.getFunctionUses(function);
+                if (uses == nullptr)
+                {
+                    hasUses = false;
+                    break;
+                }
+
+                // The globals of a function are checked once per statement
+                if (facts.functionStamps[function] != position)
+                {
+                    facts.functionStamps[function] = position;
+                    facts.functionAssignments[function] = -1;
+                    for (int global : uses->globals)
+                    {
+                        facts.functionAssignments[function] = std::max(facts.functionAssignments[function], globalAssignments[global]);
+                    }
+                }
+                lastAssignment = std::max(lastAssignment, facts.functionAssignments[function]);
+            }
+            break;
+            case NodeType::operation_divide:
+            case NodeType::operation_modulo:
+            {
+                // Division by zero and LLONG_MIN / -1 trap
+                const AstNode& divisor = ast.nodes[ast.getChild(node, 1)];
+                canFail = canFail || divisor.type != NodeType::number || divisor.value == 0 || divisor.value == -1;
+            }
+            break;
+            default:
+                break;
+            }
+
+            facts.canFail[node] = canFail;
+            facts.hasUses[node] = hasUses;
+            facts.lastAssignments[node] = lastAssignment;
+        }
+    }
+}
+
+int CommonSubexpressionEliminator::shareNodes(Ast& ast)
+{
+    if (ast.root < 0)
+    {
+        return 0;
+    }
+
+    std::unordered_map<NodeKey, int, NodeKeyHash> uniqueNodes;
+    std::vector<int> mergedIndexes(ast.nodes.size(), -1);
+
+    // The children come before their parent in post order, so their merged indexes are known when the parent is looked up
+    for (int node : ast.getPostOrder(ast.root))
+    {
+        if (mergedIndexes[node] >= 0)
+        {
+            continue;
+        }
+
+        const AstNode& astNode = ast.nodes[node];
+
+        NodeKey key;
+        key.type = astNode.type;
+        key.value = astNode.value;
+        for (int i = 0; i < astNode.childCount; i++)
+        {
+            key.children.push_back(mergedIndexes[ast.getChild(node, i)]);
+        }
+
+        auto uniqueNode = uniqueNodes.find(key);
+        if (uniqueNode != uniqueNodes.end())
+        {
+            mergedIndexes[node] = uniqueNode->second;
+            continue;
+        }
+
+        // The children are redirected to the merged nodes
+        for (int i = 0; i < astNode.childCount; i++)
+        {
+            ast.childIndices[astNode.firstChild + i] = key.children[i];
+        }
+
+        mergedIndexes[node] = node;
+        uniqueNodes.insert(std::pair<NodeKey, int>(key, node));
+    }
+
+    ast.isShared = true;
+
+    return ast.compact();
+}
+
+int CommonSubexpressionEliminator::eliminate(Ast& ast)
+{
+    if (ast.root < 0)
+    {
+        return 0;
+    }
+
+    shareNodes(ast);
+
+    int statementCount = ast.nodes[ast.root].childCount;
+    std::vector<int> statements(statementCount);
+    for (int i = 0; i < statementCount; i++)
+    {
+        statements[i] = ast.getChild(ast.root, i);
+    }
+
+    // First pass: count how many times every subexpression is computed before one of its inputs changes.
+    // The repeated uses are not entered, because they will read the hidden global.
+    // The window of every visited subexpression is recorded in visiting order (-1 if it can fail), so the second pass can follow it.
+    // A window ends when a global the subexpression uses is assigned after the window starts
+    UsageAnalysis analysis(ast);
+    SubexpressionFacts facts(ast);
+    std::vector<Window> windows;
+    std::vector<int> visitedWindows;
+    std::vector<int> currentWindows(ast.nodes.size(), -1);
+    std::vector<int> globalAssignments(ast.variables.size(), -1);
+    std::vector<char> definedGlobals(ast.variables.size(), 0);
+    std::vector<char> safeFunctions(ast.functions.size(), 0);
+    std::vector<char> definedFunctions(ast.functions.size(), 0);
+
+    for (int position = 0; position < statementCount; position++)
+    {
+        int statement = statements[position];
+        const AstNode& statementNode = ast.nodes[statement];
+
+        if (statementNode.type == NodeType::operation_assign || statementNode.type == NodeType::operation_print)
+        {
+            int expression = ast.getChild(statement, statementNode.childCount - 1);
+            computeFacts(ast, expression, position, analysis, definedGlobals, safeFunctions, globalAssignments, facts);
+
+            std::vector<int> visitStack{ expression };
+            while (!visitStack.empty())
+            {
+                int currNode = visitStack.back();
+                visitStack.pop_back();
+
+                if (isLeaf(ast, currNode))
+                {
+                    continue;
+                }
+
+                int window = currentWindows[currNode];
+                if (window >= 0 && facts.lastAssignments[currNode] < windows[window].start)
+                {
+                    windows[window].count++;
+                    visitedWindows.push_back(window);
+                    continue;
+                }
+
+                window = -1;
+                if (!facts.canFail[currNode] && facts.hasUses[currNode])
+                {
+                    window = (int)windows.size();
+                    windows.push_back(Window(currNode, position));
+                }
+                currentWindows[currNode] = window;
+                visitedWindows.push_back(window);
+
+                for (int i = ast.nodes[currNode].childCount - 1; i >= 0; i--)
+                {
+                    visitStack.push_back(ast.getChild(currNode, i));
+                }
+            }
+        }
+
+        if (statementNode.type == NodeType::operation_assign || statementNode.type == NodeType::operation_read)
+        {
+            // The windows of the subexpressions that read the assigned global end with the statement
+            int global = (int)ast.nodes[ast.getChild(statement, 0)].value;
+            globalAssignments[global] = position;
+            definedGlobals[global] = 1;
+        }
+        else if (statementNode.type == NodeType::define_function && !definedFunctions[statementNode.value])
+        {
+            definedFunctions[statementNode.value] = 1;
+            safeFunctions[statementNode.value] = !UsageAnalysis::canFail(ast, ast.getChild(statement, 1),
+                ast.nodes[ast.getChild(statement, 0)].value, definedGlobals, safeFunctions);
+        }
+    }
+
+    // Second pass: rebuild the statements in the same visiting order, the first use of a repeated subexpression
+    // is assigned to a hidden global before the statement and the next uses read it.
+    // The hidden globals are named with a character that can't be in a variable, so they don't collide with the program
+    std::vector<int> newStatements;
+    std::unordered_map<int, int> temporaries;
+    int visitedIndex = 0;
+    int sharedSubexpressions = 0;
+
+    for (int statement : statements)
+    {
+        const AstNode statementNode = ast.nodes[statement];
+
+        if (statementNode.type != NodeType::operation_assign && statementNode.type != NodeType::operation_print)
+        {
+            newStatements.push_back(statement);
+            continue;
+        }
+
+        // Iterative dfs where the window is -2 until the node is visited (its children are added then)
+        std::vector<std::pair<int, int>> rebuildStack{ std::pair<int, int>(ast.getChild(statement, statementNode.childCount - 1), -2) };
+        std::vector<int> rebuiltNodes;
+        while (!rebuildStack.empty())
+        {
+            int currNode = rebuildStack.back().first;
+            int window = rebuildStack.back().second;
+
+            if (isLeaf(ast, currNode))
+            {
+                rebuiltNodes.push_back(currNode);
+                rebuildStack.pop_back();
+                continue;
+            }
+
+            if (window == -2)
+            {
+                window = visitedWindows[visitedIndex++];
+                if (window >= 0 && windows[window].temporary >= 0)
+                {
+                    rebuiltNodes.push_back(ast.addNode(NodeType::variable, windows[window].temporary));
+                    rebuildStack.pop_back();
+                    continue;
+                }
+
+                rebuildStack.back().second = window;
+                for (int i = ast.nodes[currNode].childCount - 1; i >= 0; i--)
+                {
+                    rebuildStack.push_back(std::pair<int, int>(ast.getChild(currNode, i), -2));
+                }
+                continue;
+            }
+            rebuildStack.pop_back();
+
+            // The rebuilt children are the last ones on the stack of rebuilt nodes
+            int childCount = ast.nodes[currNode].childCount;
+            std::vector<int> children(rebuiltNodes.end() - childCount, rebuiltNodes.end());
+            rebuiltNodes.resize(rebuiltNodes.size() - childCount);
+
+            bool isChanged = false;
+            for (int i = 0; i < childCount; i++)
+            {
+                isChanged = isChanged || children[i] != ast.getChild(currNode, i);
+            }
+
+            int rebuiltNode = isChanged ? ast.addNode(ast.nodes[currNode].type, ast.nodes[currNode].value, children) : currNode;
+
+            if (window >= 0 && windows[window].count > 1)
+            {
+                auto temporary = temporaries.find(currNode);
+                if (temporary == temporaries.end())
+                {
+                    int id = ast.getVariableId("_t" + std::to_string(temporaries.size()));
+                    temporary = temporaries.insert(std::pair<int, int>(currNode, id)).first;
+                }
+                windows[window].temporary = temporary->second;
+
+                int variable = ast.addNode(NodeType::variable, temporary->second);
+                newStatements.push_back(ast.addNode(NodeType::operation_assign, 0, { variable, rebuiltNode }));
+                rebuiltNode = ast.addNode(NodeType::variable, temporary->second);
+
+                sharedSubexpressions++;
+            }
+
+            rebuiltNodes.push_back(rebuiltNode);
+        }
+
+        int expression = rebuiltNodes.back();
+        if (statementNode.type == NodeType::operation_assign)
+        {
+            newStatements.push_back(ast.addNode(statementNode.type, statementNode.value, { ast.getChild(statement, 0), expression }));
+        }
+        else
+        {
+            newStatements.push_back(ast.addNode(statementNode.type, statementNode.value, { expression }));
+        }
+    }
+
+    ast.root = ast.addNode(NodeType::root, 0, newStatements);
+
+    // The rebuilt statements are merged again, so the reads of the hidden globals are shared too
+    shareNodes(ast);
+
+    return sharedSubexpressions;
+}
+
+bool CommonSubexpressionEliminator::isLeaf(const Ast& ast, int node)
+{
+    return ast.nodes[node].type == NodeType::number || ast.nodes[node].type == NodeType::variable;
+}
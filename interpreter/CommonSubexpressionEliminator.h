@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Ast.h"
+#include <vector>
+
+/// @brief Class with methods that share the structurally identical subexpressions of a program
+class CommonSubexpressionEliminator
+{
+public:
+    /// @brief Merges the structurally identical nodes (hash consing), so the AST becomes a DAG
+    /// where every distinct subexpression is stored once.
+    /// The AST is marked as shared, so the passes that rewrite nodes in place copy the shared nodes before they change them
+    /// @param ast The arena AST (it is compacted after the merging)
+    /// @return The number of merged nodes
+    static int shareNodes(Ast& ast);
+
+    /// @brief Shares the identical nodes and computes the subexpressions that repeat in the statements of the main program once,
+    /// a hidden global is assigned before the first use and read by the next ones until one of the inputs of the subexpression is assigned.
+    /// Only the subexpressions that can't fail are computed earlier, so the runtime errors stay the same
+    /// @param ast The arena AST
+    /// @return The number of subexpressions that are computed once instead of repeatedly
+    static int eliminate(Ast& ast);
+
+private:
+    /// @brief Checks if a node is loaded directly by the engines (there is nothing to share in it)
+    /// @param ast The arena AST
+    /// @param node The node index
+    /// @return True for numbers and variables, otherwise false
+    static bool isLeaf(const Ast& ast, int node);
+};
@@ -1,76 +1,468 @@
 #include "Compiler.h"
+#include "Executor.h"
 
-Node Compiler::compile(std::vector<Token> tokens)
+namespace
 {
+	/// @brief Checks if a token is a binary operator
+	/// @param type The token type
+	/// @return True if the token is a binary operator, otherwise false
+	bool isOperator(TokenType type)
+	{
+		return type == TokenType::add
+			|| type == TokenType::subtract
+			|| type == TokenType::multiply
+			|| type == TokenType::division
+			|| type == TokenType::modulo;
+	}
+}
+
+class Compiler::TreeBuilder
+{
+public:
+	/// @brief Constructor for a builder of the expressions of the token buffer
+	/// @param tokens The token buffer
+	explicit TreeBuilder(const TokenBuffer& tokens) : tokens(tokens) {}
+
+	/// @brief Adds a variable or a number node
+	/// @param token The index of the token
+	/// @return The index of the node
+	int addLeaf(int token)
+	{
+		if (tokens.types[token] == TokenType::variable)
+		{
+			nodes.push_back(Node(NodeType::variable, tokens.getName(token)));
+		}
+		else
+		{
+			nodes.push_back(Node(NodeType::number, tokens.getValue(token)));
+		}
+
+		return (int)nodes.size() - 1;
+	}
+
+	/// @brief Adds a binary operator node, the operands are moved to its children and it takes their place
+	/// @param token The index of the operator token
+	/// @param left The index of the left operand
+	/// @param right The index of the right operand
+	/// @return The index of the node
+	int addOperator(int token, int left, int right)
+	{
+		Node operatorNode(getNodeType(tokens.types[token]), tokens.getValue(token));
+		operatorNode.children->push_back(std::move(nodes[left]));
+		operatorNode.children->push_back(std::move(nodes[right]));
+		nodes.pop_back();
+		nodes.back() = std::move(operatorNode);
+
+		return left;
+	}
+
+	/// @brief Adds a function call node, the argument is moved to its child and it takes its place
+	/// @param token The index of the function token
+	/// @param argument The index of the argument
+	/// @return The index of the node
+	int addCall(int token, int argument)
+	{
+		Node callNode(NodeType::function, tokens.getValue(token));
+		callNode.children->push_back(std::move(nodes[argument]));
+		nodes.back() = std::move(callNode);
+
+		return argument;
+	}
+
+	/// @brief Takes the root of the expression, the stack is reused for the next expression
+	/// @param node The index of the root node
+	/// @return The root node
+	Node takeRoot(int node)
+	{
+		Node root = std::move(nodes[node]);
+		nodes.pop_back();
+
+		return root;
+	}
+
+private:
+	/// @brief The token buffer
+	const TokenBuffer& tokens;
+	/// @brief The nodes that don't have a parent yet, the parser always combines the last ones,
+	/// so they are kept in a stack that is only as deep as the pending operators
+	std::vector<Node> nodes;
+};
+
+class Compiler::ArenaBuilder
+{
+public:
+	/// @brief Constructor for a builder of the expressions of the token buffer
+	/// @param tokens The token buffer
+	/// @param ast The arena AST
+	/// @param variableIds The AST ids of the variables by name id
+	/// @param functionIds The AST ids of the functions by name id
+	ArenaBuilder(const TokenBuffer& tokens, Ast& ast, std::vector<int>& variableIds, std::vector<int>& functionIds)
+		: tokens(tokens), ast(ast), variableIds(variableIds), functionIds(functionIds) {}
+
+	/// @brief Adds a variable or a number node
+	/// @param token The index of the token
+	/// @return The index of the node
+	int addLeaf(int token)
+	{
+		if (tokens.types[token] == TokenType::variable)
+		{
+			return ast.addNode(NodeType::variable, getVariableId(tokens, token, variableIds, ast));
+		}
+
+		// The numbers are parsed by the tokenizer, the ones that can't be parsed are reported here
+		return ast.addNode(NodeType::number, tokens.values[token] >= 0 ? tokens.numbers[tokens.values[token]] : Executor::parseNumber(tokens.getValue(token)));
+	}
+
+	/// @brief Adds a binary operator node
+	/// @param token The index of the operator token
+	/// @param left The index of the left operand
+	/// @param right The index of the right operand
+	/// @return The index of the node
+	int addOperator(int token, int left, int right)
+	{
+		return ast.addNode(getNodeType(tokens.types[token]), 0, { left, right });
+	}
+
+	/// @brief Adds a function call node
+	/// @param token The index of the function token
+	/// @param argument The index of the argument
+	/// @return The index of the node
+	int addCall(int token, int argument)
+	{
+		return ast.addNode(NodeType::function, getFunctionId(tokens, token, functionIds, ast), { argument });
+	}
+
+private:
+	/// @brief The token buffer
+	const TokenBuffer& tokens;
+	/// @brief The arena AST
+	Ast& ast;
+	/// @brief The AST ids of the variables by name id
+	std::vector<int>& variableIds;
+	/// @brief The AST ids of the functions by name id
+	std::vector<int>& functionIds;
+};
+
+Node Compiler::compile(const std::vector<Token>& tokens)
+{
+	return compile(TokenBuffer(tokens));
+}
+
+Node Compiler::compile(const TokenBuffer& tokens)
+{
+	checkSyntax(tokens);
+
+	// Build AST statement by statement, the expressions are parsed with precedence climbing directly form the tokens (infix syntax)
+	// without converting to prefix first
+	Node treeRoot(NodeType::root);
+
+	// The stack of the parser and the storage of the expression nodes are reused for every line
+	std::vector<std::pair<int, int>> frames;
+	TreeBuilder builder(tokens);
+
+	for (int i = 0; i < tokens.size(); i++)
+	{
+		switch (tokens.types[i])
+		{
+			// Case 1: Variable declaration
+		case TokenType::variable:
+		{
+			// Root is the assignment operator that has two children:
+			// the first is the variable parameter 
+			// the second is the root of the function expresion 
+
+			if (tokens.types[i + 1] != TokenType::equals)
+			{
+				throw std::invalid_argument("Expected '=' on line: " + std::to_string(tokens.getLine(i)));
+			}
+
+			Node assignNode(NodeType::operation_assign);
+			assignNode.children->push_back(Node(NodeType::variable, tokens.getName(i)));
+
+			i += 2;
+			assignNode.children->push_back(builder.takeRoot(parseExpression(tokens, i, frames, builder)));
+
+			treeRoot.children->push_back(assignNode);
+		}
+		break;
+		// Case 2: Function declaration
+		case TokenType::function:
+		{
+			// Root is the function name with two children:
+			// the first is the function parameter 
+			// the second is the root of the function expression 
+
+			if (i + 5 >= tokens.size())
+			{
+				throw std::invalid_argument("Invalid function definition on line: " + std::to_string(tokens.getLine(i)));
+			}
+
+			if (tokens.types[i + 1] != TokenType::left_bracket
+				|| tokens.types[i + 2] != TokenType::variable
+				|| tokens.types[i + 3] != TokenType::right_bracket
+				|| tokens.types[i + 4] != TokenType::equals)
+			{
+				throw std::invalid_argument("Invalid function definition on line: " + std::to_string(tokens.getLine(i)));
+			}
+
+			Node functionDefNode(NodeType::define_function, tokens.getName(i));
+			Node variableNode(NodeType::variable, tokens.getName(i + 2));
+
+			functionDefNode.children->push_back(variableNode);
+
+			i += 5;
+			functionDefNode.children->push_back(builder.takeRoot(parseExpression(tokens, i, frames, builder)));
+
+			treeRoot.children->push_back(functionDefNode);
+		}
+		break;
+		// Case 3: read keyword
+		case TokenType::read:
+		{
+			// Root is the read operator with only one child that should be a variable
+
+			if (i + 2 >= tokens.size())
+			{
+				throw std::invalid_argument("Unexpected end of line on line: " + std::to_string(tokens.getLine(i)));
+			}
+			if (tokens.types[i + 1] != TokenType::variable)
+			{
+				throw std::invalid_argument("Expected variable on line: " + std::to_string(tokens.getLine(i)));
+			}
+			if (tokens.types[i + 2] != TokenType::end_of_line)
+			{
+				throw std::invalid_argument("Read accepts only one argument on line: " + std::to_string(tokens.getLine(i)));
+			}
+
+			Node readNode(NodeType::operation_read);
+			readNode.children->push_back(Node(NodeType::variable, tokens.getName(i + 1)));
+
+			treeRoot.children->push_back(readNode);
+
+			i++;
+		}
+		break;
+		// Case 4: print keyword
+		case TokenType::print:
+		{
+			// Root is the print operator with only one child that will be the root of the expression
+
+			Node printNode(NodeType::operation_print);
+
+			i++;
+			printNode.children->push_back(builder.takeRoot(parseExpression(tokens, i, frames, builder)));
+
+			treeRoot.children->push_back(printNode);
+		}
+		break;
+		default:
+			break;
+		}
+	}
+
+	return treeRoot;
+}
+
+Ast Compiler::compileAst(const std::vector<Token>& tokens)
+{
+	return compileAst(TokenBuffer(tokens));
+}
+
+Ast Compiler::compileAst(const TokenBuffer& tokens)
+{
+	checkSyntax(tokens);
+
+	// Build the AST with the same parser, but the nodes are added to the arena
+	// (every token creates at most one node, so the arena is allocated once)
+	Ast ast;
+	ast.nodes.reserve(tokens.size() + 1);
+	ast.childIndices.reserve(tokens.size() + 1);
+
+	std::vector<int> statements;
+
+	// The name ids of the tokens are mapped to the AST ids when a name is first used, so the ids are in the same order as before
+	std::vector<int> variableIds(tokens.names.size(), -1);
+	std::vector<int> functionIds(tokens.names.size(), -1);
+
+	// The stack of the parser is reused for every line
+	std::vector<std::pair<int, int>> frames;
+	ArenaBuilder builder(tokens, ast, variableIds, functionIds);
+
+	for (int i = 0; i < tokens.size(); i++)
+	{
+		switch (tokens.types[i])
+		{
+			// Case 1: Variable declaration
+		case TokenType::variable:
+		{
+			if (tokens.types[i + 1] != TokenType::equals)
+			{
+				throw std::invalid_argument("Expected '=' on line: " + std::to_string(tokens.getLine(i)));
+			}
+
+			// The children must be added before their parent
+			int variable = ast.addNode(NodeType::variable, getVariableId(tokens, i, variableIds, ast));
+
+			i += 2;
+			int expression = parseExpression(tokens, i, frames, builder);
+
+			statements.push_back(ast.addNode(NodeType::operation_assign, 0, { variable, expression }));
+		}
+		break;
+		// Case 2: Function declaration
+		case TokenType::function:
+		{
+			if (i + 5 >= tokens.size())
+			{
+				throw std::invalid_argument("Invalid function definition on line: " + std::to_string(tokens.getLine(i)));
+			}
+
+			if (tokens.types[i + 1] != TokenType::left_bracket
+				|| tokens.types[i + 2] != TokenType::variable
+				|| tokens.types[i + 3] != TokenType::right_bracket
+				|| tokens.types[i + 4] != TokenType::equals)
+			{
+				throw std::invalid_argument("Invalid function definition on line: " + std::to_string(tokens.getLine(i)));
+			}
+
+			int function = getFunctionId(tokens, i, functionIds, ast);
+			int parameter = ast.addNode(NodeType::variable, getVariableId(tokens, i + 2, variableIds, ast));
+
+			i += 5;
+			int expression = parseExpression(tokens, i, frames, builder);
+
+			statements.push_back(ast.addNode(NodeType::define_function, function, { parameter, expression }));
+		}
+		break;
+		// Case 3: read keyword
+		case TokenType::read:
+		{
+			if (i + 2 >= tokens.size())
+			{
+				throw std::invalid_argument("Unexpected end of line on line: " + std::to_string(tokens.getLine(i)));
+			}
+			if (tokens.types[i + 1] != TokenType::variable)
+			{
+				throw std::invalid_argument("Expected variable on line: " + std::to_string(tokens.getLine(i)));
+			}
+			if (tokens.types[i + 2] != TokenType::end_of_line)
+			{
+				throw std::invalid_argument("Read accepts only one argument on line: " + std::to_string(tokens.getLine(i)));
+			}
+
+			int variable = ast.addNode(NodeType::variable, getVariableId(tokens, i + 1, variableIds, ast));
+			statements.push_back(ast.addNode(NodeType::operation_read, 0, { variable }));
+
+			i++;
+		}
+		break;
+		// Case 4: print keyword
+		case TokenType::print:
+		{
+			i++;
+			int expression = parseExpression(tokens, i, frames, builder);
+
+			statements.push_back(ast.addNode(NodeType::operation_print, 0, { expression }));
+		}
+		break;
+		default:
+			break;
+		}
+	}
+
+	ast.root = ast.addNode(NodeType::root, 0, statements);
+
+	return ast;
+}
+
+void Compiler::checkSyntax(const TokenBuffer& tokens)
+{
+	// Find the first call of the function at the beggining of every line in the rest of the line in one pass,
+	// so the line isn't scanned again for every function token
+	std::vector<int> recursiveCalls(tokens.size(), -1);
+	int lineFunction = -1;
+	for (int i = 0; i < tokens.size(); i++)
+	{
+		if (tokens.types[i] == TokenType::end_of_line)
+		{
+			lineFunction = -1;
+		}
+		else if (tokens.types[i] == TokenType::function)
+		{
+			if (i == 0
+				|| tokens.types[i - 1] == TokenType::end_of_line)
+			{
+				lineFunction = i;
+			}
+			else if (lineFunction >= 0
+				&& recursiveCalls[lineFunction] < 0
+				&& tokens.values[i] == tokens.values[lineFunction])
+			{
+				recursiveCalls[lineFunction] = i;
+			}
+		}
+	}
+
 	// Check tokens for correct syntax
 	for (int i = 0; i < tokens.size(); i++)
 	{
-		switch (tokens[i].type)
+		switch (tokens.types[i])
 		{
 		case TokenType::undefined:
-			throw std::invalid_argument("Unexpected symbol on line: " + std::to_string(tokens[i].line) + ", column: " + std::to_string(tokens[i].column));
+			throw std::invalid_argument("Unexpected symbol on line: " + std::to_string(tokens.getLine(i)) + ", column: " + std::to_string(tokens.getColumn(i)));
 		case TokenType::function:
 			if (i + 1 >= tokens.size())
 			{
-				throw std::invalid_argument("Unexpected end of line: " + std::to_string(tokens[i].line));
+				throw std::invalid_argument("Unexpected end of line: " + std::to_string(tokens.getLine(i)));
 			}
 
-			if (tokens[i + 1].type != TokenType::left_bracket)
+			if (tokens.types[i + 1] != TokenType::left_bracket)
 			{
-				throw std::invalid_argument("Unexpected token after function '" + tokens[i].value + "' on line: " + std::to_string(tokens[i + 1].line) + ", column: " + std::to_string(tokens[i + 1].column));
+				throw std::invalid_argument("Unexpected token after function '" + tokens.getName(i) + "' on line: " + std::to_string(tokens.getLine(i + 1)) + ", column: " + std::to_string(tokens.getColumn(i + 1)));
 			}
 
 			// Check for recursion (if current function token is at the beggining of the line, and there is another util the end)
-			if (i == 0
-				|| tokens[i - 1].type == TokenType::end_of_line)
+			if (recursiveCalls[i] >= 0)
 			{
-				int curLineI = i + 1;
-				while (curLineI < tokens.size() && tokens[curLineI].type != TokenType::end_of_line)
-				{
-					if (tokens[curLineI].type == TokenType::function
-						&& tokens[curLineI].value == tokens[i].value)
-					{
-						throw std::invalid_argument("Recursion is not supported! Unexpected function call '" + tokens[curLineI].value + "' on line: " + std::to_string(tokens[curLineI].line) + ", column: " + std::to_string(tokens[curLineI].column));
-					}
-					curLineI++;
-				}
+				int call = recursiveCalls[i];
+				throw std::invalid_argument("Recursion is not supported! Unexpected function call '" + tokens.getName(call) + "' on line: " + std::to_string(tokens.getLine(call)) + ", column: " + std::to_string(tokens.getColumn(call)));
 			}
 			break;
 		case TokenType::variable:
 			if (i + 1 < tokens.size())
 			{
-				if (tokens[i + 1].type == TokenType::variable
-					|| tokens[i + 1].type == TokenType::function
-					|| tokens[i + 1].type == TokenType::left_bracket
-					|| tokens[i + 1].type == TokenType::left_parenthesis
-					|| tokens[i + 1].type == TokenType::number
-					|| tokens[i + 1].type == TokenType::print
-					|| tokens[i + 1].type == TokenType::read)
+				if (tokens.types[i + 1] == TokenType::variable
+					|| tokens.types[i + 1] == TokenType::function
+					|| tokens.types[i + 1] == TokenType::left_bracket
+					|| tokens.types[i + 1] == TokenType::left_parenthesis
+					|| tokens.types[i + 1] == TokenType::number
+					|| tokens.types[i + 1] == TokenType::print
+					|| tokens.types[i + 1] == TokenType::read)
 				{
-					throw std::invalid_argument("Unexpected token after variable '" + tokens[i].value + "' on line: " + std::to_string(tokens[i + 1].line) + ", column: " + std::to_string(tokens[i + 1].column));
+					throw std::invalid_argument("Unexpected token after variable '" + tokens.getName(i) + "' on line: " + std::to_string(tokens.getLine(i + 1)) + ", column: " + std::to_string(tokens.getColumn(i + 1)));
 				}
 
-				if (tokens[i + 1].type == TokenType::equals
+				if (tokens.types[i + 1] == TokenType::equals
 					&& (i != 0
-						&& tokens[i - 1].type != TokenType::end_of_line))
+						&& tokens.types[i - 1] != TokenType::end_of_line))
 				{
-					throw std::invalid_argument("Unexpected token after variable '" + tokens[i].value + "' on line: " + std::to_string(tokens[i + 1].line) + ", column: " + std::to_string(tokens[i + 1].column));
+					throw std::invalid_argument("Unexpected token after variable '" + tokens.getName(i) + "' on line: " + std::to_string(tokens.getLine(i + 1)) + ", column: " + std::to_string(tokens.getColumn(i + 1)));
 				}
 			}
 			break;
 		case TokenType::number:
 			if (i + 1 < tokens.size())
 			{
-				if (tokens[i + 1].type == TokenType::variable
-					|| tokens[i + 1].type == TokenType::function
-					|| tokens[i + 1].type == TokenType::left_bracket
-					|| tokens[i + 1].type == TokenType::left_parenthesis
-					|| tokens[i + 1].type == TokenType::number
-					|| tokens[i + 1].type == TokenType::print
-					|| tokens[i + 1].type == TokenType::read
-					|| tokens[i + 1].type == TokenType::equals)
+				if (tokens.types[i + 1] == TokenType::variable
+					|| tokens.types[i + 1] == TokenType::function
+					|| tokens.types[i + 1] == TokenType::left_bracket
+					|| tokens.types[i + 1] == TokenType::left_parenthesis
+					|| tokens.types[i + 1] == TokenType::number
+					|| tokens.types[i + 1] == TokenType::print
+					|| tokens.types[i + 1] == TokenType::read
+					|| tokens.types[i + 1] == TokenType::equals)
 				{
-					throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens[i + 1].line) + ", column: " + std::to_string(tokens[i + 1].column));
+					throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens.getLine(i + 1)) + ", column: " + std::to_string(tokens.getColumn(i + 1)));
 				}
 			}
 			break;
@@ -84,312 +476,88 @@ Node Compiler::compile(std::vector<Token> tokens)
 		case TokenType::left_parenthesis:
 			if (i + 1 >= tokens.size())
 			{
-				throw std::invalid_argument("Unexpected end of line: " + std::to_string(tokens[i].line));
+				throw std::invalid_argument("Unexpected end of line: " + std::to_string(tokens.getLine(i)));
 			}
 
-			if (tokens[i + 1].type != TokenType::variable
-				&& tokens[i + 1].type != TokenType::function
-				&& tokens[i + 1].type != TokenType::number
-				&& tokens[i + 1].type != TokenType::left_parenthesis)
+			if (tokens.types[i + 1] != TokenType::variable
+				&& tokens.types[i + 1] != TokenType::function
+				&& tokens.types[i + 1] != TokenType::number
+				&& tokens.types[i + 1] != TokenType::left_parenthesis)
 			{
-				throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens[i + 1].line) + ", column: " + std::to_string(tokens[i + 1].column));
+				throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens.getLine(i + 1)) + ", column: " + std::to_string(tokens.getColumn(i + 1)));
 			}
 			break;
 		case TokenType::right_bracket:
 			if (i + 1 < tokens.size())
 			{
-				if (tokens[i + 1].type == TokenType::variable
-					|| tokens[i + 1].type == TokenType::function
-					|| tokens[i + 1].type == TokenType::left_bracket
-					|| tokens[i + 1].type == TokenType::left_parenthesis
-					|| tokens[i + 1].type == TokenType::number
-					|| tokens[i + 1].type == TokenType::print
-					|| tokens[i + 1].type == TokenType::read)
+				if (tokens.types[i + 1] == TokenType::variable
+					|| tokens.types[i + 1] == TokenType::function
+					|| tokens.types[i + 1] == TokenType::left_bracket
+					|| tokens.types[i + 1] == TokenType::left_parenthesis
+					|| tokens.types[i + 1] == TokenType::number
+					|| tokens.types[i + 1] == TokenType::print
+					|| tokens.types[i + 1] == TokenType::read)
 				{
-					throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens[i + 1].line) + ", column: " + std::to_string(tokens[i + 1].column));
+					throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens.getLine(i + 1)) + ", column: " + std::to_string(tokens.getColumn(i + 1)));
 				}
 			}
 			break;
 		case TokenType::right_parenthesis:
 			if (i + 1 < tokens.size())
 			{
-				if (tokens[i + 1].type == TokenType::variable
-					|| tokens[i + 1].type == TokenType::function
-					|| tokens[i + 1].type == TokenType::left_bracket
-					|| tokens[i + 1].type == TokenType::left_parenthesis
-					|| tokens[i + 1].type == TokenType::number
-					|| tokens[i + 1].type == TokenType::print
-					|| tokens[i + 1].type == TokenType::read
-					|| tokens[i + 1].type == TokenType::equals)
+				if (tokens.types[i + 1] == TokenType::variable
+					|| tokens.types[i + 1] == TokenType::function
+					|| tokens.types[i + 1] == TokenType::left_bracket
+					|| tokens.types[i + 1] == TokenType::left_parenthesis
+					|| tokens.types[i + 1] == TokenType::number
+					|| tokens.types[i + 1] == TokenType::print
+					|| tokens.types[i + 1] == TokenType::read
+					|| tokens.types[i + 1] == TokenType::equals)
 				{
-					throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens[i + 1].line) + ", column: " + std::to_string(tokens[i + 1].column));
+					throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens.getLine(i + 1)) + ", column: " + std::to_string(tokens.getColumn(i + 1)));
 				}
 			}
 			break;
 		case TokenType::print:
 			if (i + 1 >= tokens.size())
 			{
-				throw std::invalid_argument("Unexpected end of line: " + std::to_string(tokens[i].line));
+				throw std::invalid_argument("Unexpected end of line: " + std::to_string(tokens.getLine(i)));
 			}
 
-			if (tokens[i + 1].type != TokenType::variable
-				&& tokens[i + 1].type != TokenType::function
-				&& tokens[i + 1].type != TokenType::number
-				&& tokens[i + 1].type != TokenType::left_parenthesis)
+			if (tokens.types[i + 1] != TokenType::variable
+				&& tokens.types[i + 1] != TokenType::function
+				&& tokens.types[i + 1] != TokenType::number
+				&& tokens.types[i + 1] != TokenType::left_parenthesis)
 			{
-				throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens[i + 1].line) + ", column: " + std::to_string(tokens[i + 1].column));
+				throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens.getLine(i + 1)) + ", column: " + std::to_string(tokens.getColumn(i + 1)));
 			}
 			break;
 		case TokenType::read:
 			if (i + 1 >= tokens.size())
 			{
-				throw std::invalid_argument("Unexpected end of line: " + std::to_string(tokens[i].line));
+				throw std::invalid_argument("Unexpected end of line: " + std::to_string(tokens.getLine(i)));
 			}
 
-			if (tokens[i + 1].type != TokenType::variable)
+			if (tokens.types[i + 1] != TokenType::variable)
 			{
-				throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens[i + 1].line) + ", column: " + std::to_string(tokens[i + 1].column));
+				throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens.getLine(i + 1)) + ", column: " + std::to_string(tokens.getColumn(i + 1)));
 			}
 			break;
 		case TokenType::end_of_line:
 			if (i + 1 < tokens.size()
-				&& tokens[i + 1].type != TokenType::variable
-				&& tokens[i + 1].type != TokenType::function
-				&& tokens[i + 1].type != TokenType::print
-				&& tokens[i + 1].type != TokenType::read
-				&& tokens[i + 1].type != TokenType::end_of_line)
+				&& tokens.types[i + 1] != TokenType::variable
+				&& tokens.types[i + 1] != TokenType::function
+				&& tokens.types[i + 1] != TokenType::print
+				&& tokens.types[i + 1] != TokenType::read
+				&& tokens.types[i + 1] != TokenType::end_of_line)
 			{
-				throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens[i + 1].line) + ", column: " + std::to_string(tokens[i + 1].column));
+				throw std::invalid_argument("Unexpected token on line: " + std::to_string(tokens.getLine(i + 1)) + ", column: " + std::to_string(tokens.getColumn(i + 1)));
 			}
 			break;
 		default:
 			break;
 		}
 	}
-
-	// Build AST using shunting yard algorithm for expressions directly form the tokens (infix syntax) 
-	// without converting to prefix first
-	Node treeRoot(NodeType::root);
-
-	Node* parentNode = &treeRoot;
-
-	// Determines if we are building an expression currently
-	bool isInExpression = false;
-
-	// Output stack for the shunting yard algorithm (contains the nodes for the AST)
-	std::stack<Node> outputStack;
-	// Operator stack for the shunting yard algorithm (stores the operators until they are processed to the output)
-	std::stack<Token> operatorStack;
-
-	for (int i = 0; i < tokens.size(); i++)
-	{
-		// When computing an expression use the shunting yard algorithm
-		if (isInExpression)
-		{
-			switch (tokens[i].type)
-			{
-				// Case 1: Number / Var
-			case TokenType::variable:
-				outputStack.push(Node(NodeType::variable, tokens[i].value));
-				break;
-			case TokenType::number:
-				outputStack.push(Node(NodeType::number, tokens[i].value));
-				break;
-				// Case 2: Function
-			case TokenType::function:
-				operatorStack.push(tokens[i]);
-				break;
-				// Case 3: Operator
-			case TokenType::add:
-			case TokenType::subtract:
-			case TokenType::division:
-			case TokenType::multiply:
-			case TokenType::modulo:
-				// While operator stack is not empty and the last element is not left parenthesis 
-				// and the top element precedence is bigger than the current or the precedences are equal,
-				// we pop the operators and move them to the output stack (building the AST) and
-				// push the current operator to the operator stack
-				while (!operatorStack.empty() && operatorStack.top().type != TokenType::left_parenthesis
-					&& (getPrecedence(operatorStack.top().type) < getPrecedence(tokens[i].type)
-						|| (getPrecedence(operatorStack.top().type) == getPrecedence(tokens[i].type))))
-				{
-					popOperator(operatorStack, outputStack, tokens[i]);
-				}
-				operatorStack.push(tokens[i]);
-				break;
-				// Case 4: left parenthesis/bracket
-			case TokenType::left_parenthesis:
-			case TokenType::left_bracket:
-				operatorStack.push(tokens[i]);
-				break;
-				// Case 5: right parenthesis/bracket
-			case TokenType::right_parenthesis:
-			case TokenType::right_bracket:
-			{
-				// Pop operators until we find the matching left parenthesis/bracket and then pop it as well
-				// Note: parenthesis and brackets are not part of the AST and are not added to the output
-				TokenType bracketType = tokens[i].type == TokenType::right_bracket ? TokenType::left_bracket : TokenType::left_parenthesis;
-				while (!operatorStack.empty() && operatorStack.top().type != bracketType)
-				{
-					popOperator(operatorStack, outputStack, tokens[i]);
-				}
-				if (!operatorStack.empty())
-				{
-					operatorStack.pop();
-				}
-				else
-				{
-					throw std::invalid_argument("Missmatched parenthesis on line: " + std::to_string(tokens[i].line));
-				}
-			}
-			break;
-			// Case 5: End of line
-			case TokenType::end_of_line:
-			{
-				// Pop the remaining operators from the stack
-				while (!operatorStack.empty())
-				{
-					if (operatorStack.top().type == TokenType::left_parenthesis)
-					{
-						throw std::invalid_argument("Missmatched parenthesis on line: " + std::to_string(tokens[i].line));
-					}
-					if (operatorStack.top().type == TokenType::left_bracket)
-					{
-						throw std::invalid_argument("Missmatched parenthesis on line: " + std::to_string(tokens[i].line));
-					}
-
-					popOperator(operatorStack, outputStack, tokens[i]);
-				}
-
-				// At the end the output should have only one element (the root node of the expression)
-				if (outputStack.size() != 1)
-				{
-					throw std::invalid_argument("Invalid syntax on line: " + std::to_string(tokens[i].line));
-				}
-
-				Node node = outputStack.top();
-				outputStack.pop();
-
-				parentNode->children->push_back(node);
-			}
-			break;
-			default: break;
-			}
-		}
-		else // When in the beginning of the line
-		{
-			switch (tokens[i].type)
-			{
-				// Case 1: Variable declaration
-			case TokenType::variable:
-			{
-				// Root is the assignment operator that has two children:
-				// the first is the variable parameter 
-				// the second is the root of the function expresion 
-
-				if (tokens[i + 1].type != TokenType::equals)
-				{
-					throw std::invalid_argument("Expected '=' on line: " + std::to_string(tokens[i].line));
-				}
-
-				Node assignNode(NodeType::operation_assign);
-				assignNode.children->push_back(Node(NodeType::variable, tokens[i].value));
-
-				parentNode->children->push_back(assignNode);
-				parentNode = &assignNode;
-
-				i++;
-
-				isInExpression = true;
-			}
-			break;
-			// Case 2: Function declaration
-			case TokenType::function:
-			{
-				// Root is the function name with two children:
-				// the first is the function parameter 
-				// the second is the root of the function expression 
-
-				if (i + 5 >= tokens.size())
-				{
-					throw std::invalid_argument("Invalid function definition on line: " + std::to_string(tokens[i].line));
-				}
-
-				if (tokens[i + 1].type != TokenType::left_bracket
-					|| tokens[i + 2].type != TokenType::variable
-					|| tokens[i + 3].type != TokenType::right_bracket
-					|| tokens[i + 4].type != TokenType::equals)
-				{
-					throw std::invalid_argument("Invalid function definition on line: " + std::to_string(tokens[i].line));
-				}
-
-				Node functionDefNode(NodeType::define_function, tokens[i].value);
-				Node variableNode(NodeType::variable, tokens[i + 2].value);
-
-				functionDefNode.children->push_back(variableNode);
-
-				parentNode->children->push_back(functionDefNode);
-				parentNode = &functionDefNode;
-
-				i += 4;
-
-				isInExpression = true;
-			}
-			break;
-			// Case 3: read keyword
-			case TokenType::read:
-			{
-				// Root is the read operator with only one child that should be a variable
-
-				if (i + 2 >= tokens.size())
-				{
-					throw std::invalid_argument("Unexpected end of line on line: " + std::to_string(tokens[i].line));
-				}
-				if (tokens[i + 1].type != TokenType::variable)
-				{
-					throw std::invalid_argument("Expected variable on line: " + std::to_string(tokens[i].line));
-				}
-				if (tokens[i + 2].type != TokenType::end_of_line)
-				{
-					throw std::invalid_argument("Read accepts only one argument on line: " + std::to_string(tokens[i].line));
-				}
-
-				Node readNode(NodeType::operation_read);
-				readNode.children->push_back(Node(NodeType::variable, tokens[i + 1].value));
-
-				parentNode->children->push_back(readNode);
-
-				i++;
-			}
-			break;
-			// Case 4: print keyword
-			case TokenType::print:
-			{
-				// Root is the print operator with only one child that will be the root of the expression
-
-				Node printNode(NodeType::operation_print);
-
-				parentNode->children->push_back(printNode);
-				parentNode = &printNode;
-
-				isInExpression = true;
-
-			}
-			break;
-			default:
-				break;
-			}
-		}
-
-		if (tokens[i].type == TokenType::end_of_line)
-		{
-			isInExpression = false;
-
-			parentNode = &treeRoot;
-		}
-	}
-
-	return treeRoot;
 }
 
 int Compiler::getPrecedence(const TokenType& tokenType)
@@ -426,47 +594,133 @@ NodeType Compiler::getNodeType(const TokenType& type)
 	}
 }
 
-void Compiler::popOperator(std::stack<Token>& operatorStack, std::stack<Node>& outputStack, Token token)
+int Compiler::getVariableId(const TokenBuffer& tokens, int token, std::vector<int>& variableIds, Ast& ast)
+{
+	int& id = variableIds[tokens.values[token]];
+	if (id < 0)
+	{
+		id = ast.getVariableId(tokens.getName(token));
+	}
+
+	return id;
+}
+
+int Compiler::getFunctionId(const TokenBuffer& tokens, int token, std::vector<int>& functionIds, Ast& ast)
 {
-	// When popping operator we get its operands from the output stack
-	// and build a node for the AST and push it back to the output stack
+	int& id = functionIds[tokens.values[token]];
+	if (id < 0)
+	{
+		id = ast.getFunctionId(tokens.getName(token));
+	}
 
-	Token operatorToken = operatorStack.top();
-	operatorStack.pop();
+	return id;
+}
 
-	Node operatorNode(getNodeType(operatorToken.type), operatorToken.value);
+template <typename Builder>
+int Compiler::parseExpression(const TokenBuffer& tokens, int& token, std::vector<std::pair<int, int>>& frames, Builder& builder)
+{
+	// Every frame is a binary operator waiting for its right operand or an open group (a parenthesis or the bracket of a function call),
+	// the operators are added to the tree when an operator with the same or lower precedence or the end of their group is found
+	frames.clear();
 
-	// Function has only one operand
-	if (operatorToken.type == TokenType::function)
+	int operand = -1;
+	bool isOperandExpected = true;
+	while (true)
 	{
-		if (outputStack.empty())
+		TokenType type = token < tokens.size() ? tokens.types[token] : TokenType::end_of_line;
+
+		// Case 1: Operand or the start of a group
+		if (isOperandExpected)
 		{
-			throw std::invalid_argument("Invalid syntax on line: " + std::to_string(token.line));
+			switch (type)
+			{
+			case TokenType::variable:
+			case TokenType::number:
+				operand = builder.addLeaf(token);
+				isOperandExpected = false;
+				break;
+			case TokenType::left_parenthesis:
+				frames.push_back(std::pair<int, int>(token, -1));
+				break;
+			case TokenType::function:
+				// The function node is added when its bracket is closed
+				if (token + 1 >= tokens.size() || tokens.types[token + 1] != TokenType::left_bracket)
+				{
+					throwAt(tokens, token + 1, "Unexpected token");
+				}
+				frames.push_back(std::pair<int, int>(token, -1));
+				token++;
+				break;
+			default:
+				throwAt(tokens, token, "Unexpected token");
+			}
+
+			token++;
+			continue;
 		}
-		Node element = outputStack.top();
-		outputStack.pop();
 
-		operatorNode.children->push_back(element);
-	}
-	else // All other operators have two operands
-	{
-		if (outputStack.empty())
+		// Case 2: Operator, end of a group or end of the expression
+		// The operators before it with the same or higher precedence are done first, so the operators are left associative
+		// (the tokens that aren't operators have the lowest precedence and finish all operators of the group)
+		int precedence = getPrecedence(type);
+		while (!frames.empty()
+			&& isOperator(tokens.types[frames.back().first])
+			&& getPrecedence(tokens.types[frames.back().first]) <= precedence)
 		{
-			throw std::invalid_argument("Invalid syntax on line: " + std::to_string(token.line));
+			operand = builder.addOperator(frames.back().first, frames.back().second, operand);
+			frames.pop_back();
 		}
-		Node right = outputStack.top();
-		outputStack.pop();
 
-		if (outputStack.empty())
+		switch (type)
+		{
+		case TokenType::add:
+		case TokenType::subtract:
+		case TokenType::division:
+		case TokenType::multiply:
+		case TokenType::modulo:
+			frames.push_back(std::pair<int, int>(token, operand));
+			isOperandExpected = true;
+			break;
+		case TokenType::right_parenthesis:
+		case TokenType::right_bracket:
 		{
-			throw std::invalid_argument("Invalid syntax on line: " + std::to_string(token.line));
+			// The group must be opened with the same kind of bracket
+			TokenType groupType = frames.empty() ? TokenType::undefined : tokens.types[frames.back().first];
+			if ((type == TokenType::right_parenthesis && groupType != TokenType::left_parenthesis)
+				|| (type == TokenType::right_bracket && groupType != TokenType::function))
+			{
+				throwAt(tokens, token, "Missmatched parenthesis");
+			}
+
+			if (groupType == TokenType::function)
+			{
+				operand = builder.addCall(frames.back().first, operand);
+			}
+			frames.pop_back();
+		}
+		break;
+		case TokenType::end_of_line:
+			// Only the groups that aren't closed are left, the error is at the innermost one
+			if (!frames.empty())
+			{
+				int group = frames.back().first;
+				throwAt(tokens, tokens.types[group] == TokenType::function ? group + 1 : group, "Missmatched parenthesis");
+			}
+			return operand;
+		default:
+			throwAt(tokens, token, "Unexpected token");
 		}
-		Node left = outputStack.top();
-		outputStack.pop();
 
-		operatorNode.children->push_back(left);
-		operatorNode.children->push_back(right);
+		token++;
 	}
-
-	outputStack.push(operatorNode);
 }
+
+void Compiler::throwAt(const TokenBuffer& tokens, int token, const std::string& message)
+{
+	if (token >= tokens.size())
+	{
+		token = tokens.size() - 1;
+	}
+
+	throw std::invalid_argument(message + " on line: " + std::to_string(tokens.getLine(token)) + ", column: " + std::to_string(tokens.getColumn(token)));
+}
\ No newline at end of file
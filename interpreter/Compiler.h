@@ -1,9 +1,12 @@
 #pragma once
 
-#include <stack>
 #include <iostream>
+#include <utility>
+#include <vector>
 #include "Node.h"
+#include "Ast.h"
 #include "Token.h"
+#include "TokenBuffer.h"
 
 class Compiler
 {
@@ -11,9 +14,29 @@ public:
     /// @brief Builds an AST from the tokens vector
     /// @param tokens Vector with the tokens
     /// @return The AST root
-    static Node compile(std::vector<Token> tokens);
+    static Node compile(const std::vector<Token>& tokens);
+
+    /// @brief Builds an AST from the token buffer
+    /// @param tokens The token buffer
+    /// @return The AST root
+    static Node compile(const TokenBuffer& tokens);
+
+    /// @brief Builds an arena AST from the tokens vector (the syntax errors are the same as for the tree)
+    /// @param tokens Vector with the tokens
+    /// @return The arena AST
+    static Ast compileAst(const std::vector<Token>& tokens);
+
+    /// @brief Builds an arena AST from the token buffer (the syntax errors are the same as for the tree)
+    /// @param tokens The token buffer
+    /// @return The arena AST
+    static Ast compileAst(const TokenBuffer& tokens);
+
+    /// @brief Checks the tokens for correct syntax (the compile methods check it before they build the AST)
+    /// @param tokens The token buffer
+    static void checkSyntax(const TokenBuffer& tokens);
 
 private:
+
     /// @brief Computes the precedence of the operator
     /// @param tokenType The token type
     /// @return The precedence of the given operator
@@ -24,9 +47,42 @@ private:
     /// @return The corresponding node type
     static NodeType getNodeType(const TokenType& type);
 
-    /// @brief Pops the top operator from the operator stack (part of the shunting yard algorithm)
-    /// @param operatorStack The operator stack for the shunting yard algorithm
-    /// @param outputStack The output stack for the shunting yard algorithm
-    /// @param token The current token processed by the algorithm
-    static void popOperator(std::stack<Token>& operatorStack, std::stack<Node>& outputStack, Token token);
-};
+    /// @brief Gets the AST id of a variable, the AST gets the names in the order they are first used
+    /// @param tokens The token buffer
+    /// @param token The index of the variable token
+    /// @param variableIds The AST ids by name id (-1 if the name is not added yet)
+    /// @param ast The arena AST
+    /// @return The AST id of the variable
+    static int getVariableId(const TokenBuffer& tokens, int token, std::vector<int>& variableIds, Ast& ast);
+
+    /// @brief Gets the AST id of a function, the AST gets the names in the order they are first used
+    /// @param tokens The token buffer
+    /// @param token The index of the function token
+    /// @param functionIds The AST ids by name id (-1 if the name is not added yet)
+    /// @param ast The arena AST
+    /// @return The AST id of the function
+    static int getFunctionId(const TokenBuffer& tokens, int token, std::vector<int>& functionIds, Ast& ast);
+
+    /// @brief Builds the nodes of the tree of Nodes for the expression parser
+    class TreeBuilder;
+
+    /// @brief Builds the nodes of the arena AST for the expression parser
+    class ArenaBuilder;
+
+    /// @brief Parses an expression with precedence climbing and adds its nodes with the builder.
+    /// The stack of pending operators and open brackets is kept in a vector, so the expressions can be arbitrarily long and deep,
+    /// every token is pushed and popped at most once and the nodes are added in the same order as by the shunting yard algorithm
+    /// @param tokens The token buffer
+    /// @param token The index of the first token of the expression, it gets the index of the end of line after the expression
+    /// @param frames The stack of the parser with the operator or bracket token and the left operand (reused for every expression)
+    /// @param builder The builder of the nodes
+    /// @return The index of the root node of the expression in the builder
+    template <typename Builder>
+    static int parseExpression(const TokenBuffer& tokens, int& token, std::vector<std::pair<int, int>>& frames, Builder& builder);
+
+    /// @brief Throws the error of an unexpected token in an expression
+    /// @param tokens The token buffer
+    /// @param token The index of the token
+    /// @param message The start of the message
+    static void throwAt(const TokenBuffer& tokens, int token, const std::string& message);
+};
\ No newline at end of file
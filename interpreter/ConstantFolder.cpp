@@ -0,0 +1,285 @@
+#include "ConstantFolder.h"
+
+#include <climits>
+
+namespace
+{
+    /// @brief Computes a binary operation with wrapping arithmetic (the division and modulo must not trap)
+    long long compute(NodeType type, long long left, long long right)
+    {
+        // The unsigned arithmetic wraps like the operations of the engines do, but without undefined behavior
+        switch (type)
+        {
+        case NodeType::operation_add: return (long long)((unsigned long long)left + (unsigned long long)right);
+        case NodeType::operation_subtract: return (long long)((unsigned long long)left - (unsigned long long)right);
+        case NodeType::operation_multipy: return (long long)((unsigned long long)left * (unsigned long long)right);
+        case NodeType::operation_divide: return left / right;
+        default: return left % right;
+        }
+    }
+
+    /// @brief Checks if a division or modulo by the number can trap (division by zero or overflow of LLONG_MIN / -1)
+    bool canDivisionTrap(long long divisor)
+    {
+        return divisor == 0 || divisor == -1;
+    }
+
+    /// @brief Converts a node to a number node
+    void makeNumber(Ast& ast, int node, long long value)
+    {
+        ast.nodes[node].type = NodeType::number;
+        ast.nodes[node].value = value;
+        ast.nodes[node].childCount = 0;
+    }
+}
+
+int ConstantFolder::fold(Ast& ast)
+{
+    if (ast.root < 0)
+    {
+        return 0;
+    }
+
+    // The nodes are rewritten in place, so a shared node is copied for every parent first
+    if (ast.isShared)
+    {
+        ast.unshare();
+    }
+
+    std::vector<int> replacements(ast.nodes.size());
+    for (int i = 0; i < replacements.size(); i++)
+    {
+        replacements[i] = i;
+    }
+    std::vector<char> canFail(ast.nodes.size(), 0);
+
+    // The statements are executed in order, so a global assigned by an earlier statement is surely defined.
+    // A function body is computed only after its first definition, so it sees the globals defined before it
+    std::vector<char> definedGlobals(ast.variables.size(), 0);
+    std::vector<char> definedFunctions(ast.functions.size(), 0);
+
+    const AstNode& root = ast.nodes[ast.root];
+    for (int i = 0; i < root.childCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+        AstNode& statementNode = ast.nodes[statement];
+
+        switch (statementNode.type)
+        {
+        case NodeType::operation_assign:
+        case NodeType::operation_print:
+        {
+            int& expression = ast.childIndices[statementNode.firstChild + statementNode.childCount - 1];
+            expression = foldExpression(ast, expression, -1, definedGlobals, replacements, canFail);
+
+            if (statementNode.type == NodeType::operation_assign)
+            {
+                definedGlobals[ast.nodes[ast.getChild(statement, 0)].value] = 1;
+            }
+        }
+        break;
+        case NodeType::operation_read:
+            definedGlobals[ast.nodes[ast.getChild(statement, 0)].value] = 1;
+            break;
+        case NodeType::define_function:
+            // Only the first definition of a function can be called
+            if (!definedFunctions[statementNode.value])
+            {
+                definedFunctions[statementNode.value] = 1;
+
+                int& body = ast.childIndices[statementNode.firstChild + 1];
+                body = foldExpression(ast, body, ast.nodes[ast.getChild(statement, 0)].value, definedGlobals, replacements, canFail);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    return ast.compact();
+}
+
+int ConstantFolder::foldExpression(Ast& ast, int expression, long long parameter, const std::vector<char>& definedGlobals,
+    std::vector<int>& replacements, std::vector<char>& canFail)
+{
+    // The children are folded before their parent, so the parent sees the nodes that replaced them
+    for (int node : ast.getPostOrder(expression))
+    {
+        AstNode& currNode = ast.nodes[node];
+        for (int i = 0; i < currNode.childCount; i++)
+        {
+            int& child = ast.childIndices[currNode.firstChild + i];
+            child = replacements[child];
+        }
+
+        switch (currNode.type)
+        {
+        case NodeType::number:
+            canFail[node] = 0;
+            break;
+        case NodeType::variable:
+            canFail[node] = currNode.value != parameter && !definedGlobals[currNode.value];
+            break;
+        case NodeType::function:
+            // The function may not be defined yet when it is called
+            canFail[node] = 1;
+            break;
+        case NodeType::operation_add:
+        case NodeType::operation_subtract:
+        case NodeType::operation_multipy:
+        case NodeType::operation_divide:
+        case NodeType::operation_modulo:
+        {
+            int left = ast.getChild(node, 0);
+            int right = ast.getChild(node, 1);
+            AstNode& leftNode = ast.nodes[left];
+            AstNode& rightNode = ast.nodes[right];
+
+            bool isDivision = currNode.type == NodeType::operation_divide || currNode.type == NodeType::operation_modulo;
+
+            // Case 1: Both operands are numbers
+            if (leftNode.type == NodeType::number && rightNode.type == NodeType::number)
+            {
+                if (!isDivision || (!canDivisionTrap(rightNode.value)))
+                {
+                    makeNumber(ast, node, compute(currNode.type, leftNode.value, rightNode.value));
+                    canFail[node] = 0;
+                }
+                else if (rightNode.value == -1 && leftNode.value != LLONG_MIN)
+                {
+                    // x / -1 and x % -1 trap only for the smallest value
+                    makeNumber(ast, node, currNode.type == NodeType::operation_divide ? -leftNode.value : 0);
+                    canFail[node] = 0;
+                }
+                else
+                {
+                    canFail[node] = 1;
+                }
+                break;
+            }
+
+            // Case 2: (x + c1) + c2 and (x * c1) * c2 are computed as x + (c1 + c2) and x * (c1 * c2),
+            // which is exact with wrapping arithmetic
+            if (rightNode.type == NodeType::number && leftNode.childCount == 2
+                && ast.nodes[ast.getChild(left, 1)].type == NodeType::number)
+            {
+                bool isAdditive = (currNode.type == NodeType::operation_add || currNode.type == NodeType::operation_subtract)
+                    && (leftNode.type == NodeType::operation_add || leftNode.type == NodeType::operation_subtract);
+                bool isMultiplicative = currNode.type == NodeType::operation_multipy && leftNode.type == NodeType::operation_multipy;
+
+                if (isAdditive || isMultiplicative)
+                {
+                    long long leftConstant = ast.nodes[ast.getChild(left, 1)].value;
+                    if (isAdditive)
+                    {
+                        long long leftTerm = leftNode.type == NodeType::operation_add ? leftConstant : compute(NodeType::operation_subtract, 0, leftConstant);
+                        long long rightTerm = currNode.type == NodeType::operation_add ? rightNode.value : compute(NodeType::operation_subtract, 0, rightNode.value);
+
+                        rightNode.value = compute(NodeType::operation_add, leftTerm, rightTerm);
+                        currNode.type = NodeType::operation_add;
+                    }
+                    else
+                    {
+                        rightNode.value = compute(NodeType::operation_multipy, leftConstant, rightNode.value);
+                    }
+
+                    ast.childIndices[currNode.firstChild] = ast.getChild(left, 0);
+                    left = ast.getChild(node, 0);
+                }
+            }
+
+            const AstNode& leftOperand = ast.nodes[left];
+            const AstNode& rightOperand = ast.nodes[right];
+            bool isLeftConstant = leftOperand.type == NodeType::number;
+            bool isRightConstant = rightOperand.type == NodeType::number;
+
+            canFail[node] = canFail[left] || canFail[right] || (isDivision && (!isRightConstant || canDivisionTrap(rightOperand.value)));
+
+            // Case 3: Identities, an operand is dropped only when it can't fail
+            switch (currNode.type)
+            {
+            case NodeType::operation_add:
+                if (isRightConstant && rightOperand.value == 0)
+                {
+                    replacements[node] = left;
+                }
+                else if (isLeftConstant && leftOperand.value == 0)
+                {
+                    replacements[node] = right;
+                }
+                break;
+            case NodeType::operation_subtract:
+                if (isRightConstant && rightOperand.value == 0)
+                {
+                    replacements[node] = left;
+                }
+                else if (!canFail[node] && isSameExpression(ast, left, right))
+                {
+                    makeNumber(ast, node, 0);
+                }
+                break;
+            case NodeType::operation_multipy:
+                if (isRightConstant && rightOperand.value == 1)
+                {
+                    replacements[node] = left;
+                }
+                else if (isLeftConstant && leftOperand.value == 1)
+                {
+                    replacements[node] = right;
+                }
+                else if (!canFail[node] && ((isRightConstant && rightOperand.value == 0) || (isLeftConstant && leftOperand.value == 0)))
+                {
+                    makeNumber(ast, node, 0);
+                }
+                break;
+            case NodeType::operation_divide:
+                if (isRightConstant && rightOperand.value == 1)
+                {
+                    replacements[node] = left;
+                }
+                break;
+            case NodeType::operation_modulo:
+                if (!canFail[node] && isRightConstant && rightOperand.value == 1)
+                {
+                    makeNumber(ast, node, 0);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    return replacements[expression];
+}
+
+bool ConstantFolder::isSameExpression(const Ast& ast, int left, int right)
+{
+    std::vector<std::pair<int, int>> compareStack{ std::pair<int, int>(left, right) };
+    while (!compareStack.empty())
+    {
+        const AstNode& leftNode = ast.nodes[compareStack.back().first];
+        const AstNode& rightNode = ast.nodes[compareStack.back().second];
+        int leftIndex = compareStack.back().first;
+        int rightIndex = compareStack.back().second;
+        compareStack.pop_back();
+
+        if (leftNode.type != rightNode.type
+            || leftNode.value != rightNode.value
+            || leftNode.childCount != rightNode.childCount)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < leftNode.childCount; i++)
+        {
+            compareStack.push_back(std::pair<int, int>(ast.getChild(leftIndex, i), ast.getChild(rightIndex, i)));
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Ast.h"
+#include <vector>
+
+/// @brief Class with methods that fold constant expressions and apply algebraic identities to an AST
+class ConstantFolder
+{
+public:
+    /// @brief Folds the constant subtrees and simplifies the identities (x + 0, x * 1, x - x, ...) in every expression.
+    /// The result is the same as the wrapping long long arithmetic of the engines, so a division or modulo is folded
+    /// only when it can't trap, and a subtree is dropped only when it can't fail with a runtime error
+    /// @param ast The arena AST (it is unshared before and compacted after the folding)
+    /// @return The number of eliminated nodes
+    static int fold(Ast& ast);
+
+private:
+    /// @brief Folds the nodes of an expression in post order
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param definedGlobals Flags showing which globals are surely assigned when the expression is computed
+    /// @param replacements The node every node is replaced by (the index of the node itself if it is not replaced)
+    /// @param canFail Flags showing which nodes can fail with a runtime error
+    /// @return The node that replaces the expression
+    static int foldExpression(Ast& ast, int expression, long long parameter, const std::vector<char>& definedGlobals,
+        std::vector<int>& replacements, std::vector<char>& canFail);
+
+    /// @brief Checks if two expressions are the same
+    /// @param ast The arena AST
+    /// @param left The index of the first expression
+    /// @param right The index of the second expression
+    /// @return True if both expressions have the same nodes, otherwise false
+    static bool isSameExpression(const Ast& ast, int left, int right);
+};
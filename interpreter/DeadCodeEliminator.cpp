@@ -0,0 +1,117 @@
+#include "DeadCodeEliminator.h"
+
+int DeadCodeEliminator::eliminate(Ast& ast)
+{
+    if (ast.root < 0)
+    {
+        return 0;
+    }
+
+    int statementCount = ast.nodes[ast.root].childCount;
+    std::vector<int> statements(statementCount);
+    for (int i = 0; i < statementCount; i++)
+    {
+        statements[i] = ast.getChild(ast.root, i);
+    }
+
+    // Forward pass: find the assignments that can fail, a failing assignment has to be kept even if its value is never read.
+    // A function is safe to call when it is surely defined and its first body can't fail
+    std::vector<char> canFail(statementCount, 0);
+    std::vector<char> definedGlobals(ast.variables.size(), 0);
+    std::vector<char> safeFunctions(ast.functions.size(), 0);
+    std::vector<int> definitionCounts(ast.functions.size(), 0);
+
+    for (int i = 0; i < statementCount; i++)
+    {
+        int statement = statements[i];
+        const AstNode& statementNode = ast.nodes[statement];
+
+        switch (statementNode.type)
+        {
+        case NodeType::operation_assign:
+            canFail[i] = UsageAnalysis::canFail(ast, ast.getChild(statement, 1), -1, definedGlobals, safeFunctions);
+            definedGlobals[ast.nodes[ast.getChild(statement, 0)].value] = 1;
+            break;
+        case NodeType::operation_read:
+            definedGlobals[ast.nodes[ast.getChild(statement, 0)].value] = 1;
+            break;
+        case NodeType::define_function:
+            if (++definitionCounts[statementNode.value] == 1)
+            {
+                safeFunctions[statementNode.value] = !UsageAnalysis::canFail(ast, ast.getChild(statement, 1),
+                    ast.nodes[ast.getChild(statement, 0)].value, definedGlobals, safeFunctions);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Backward pass: a global is live when a later statement reads it before it is assigned again
+    // and a function is live when a later statement calls it (directly or through other functions)
+    UsageAnalysis analysis(ast);
+    std::vector<char> liveGlobals(ast.variables.size(), 0);
+    std::vector<char> liveFunctions(ast.functions.size(), 0);
+    std::vector<char> isKept(statementCount, 1);
+
+    for (int i = statementCount - 1; i >= 0; i--)
+    {
+        int statement = statements[i];
+        const AstNode& statementNode = ast.nodes[statement];
+
+        switch (statementNode.type)
+        {
+        case NodeType::operation_assign:
+        {
+            int variable = (int)ast.nodes[ast.getChild(statement, 0)].value;
+            if (liveGlobals[variable] || canFail[i])
+            {
+                liveGlobals[variable] = 0;
+                markUses(ast.getChild(statement, 1), analysis, liveGlobals, liveFunctions);
+            }
+            else
+            {
+                isKept[i] = 0;
+            }
+        }
+        break;
+        case NodeType::operation_read:
+            liveGlobals[ast.nodes[ast.getChild(statement, 0)].value] = 0;
+            break;
+        case NodeType::operation_print:
+            markUses(ast.getChild(statement, 0), analysis, liveGlobals, liveFunctions);
+            break;
+        case NodeType::define_function:
+            isKept[i] = liveFunctions[statementNode.value] || definitionCounts[statementNode.value] > 1;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // The kept statements are moved to the beginning of the child range of the root
+    int keptCount = 0;
+    for (int i = 0; i < statementCount; i++)
+    {
+        if (isKept[i])
+        {
+            ast.childIndices[ast.nodes[ast.root].firstChild + keptCount] = statements[i];
+            keptCount++;
+        }
+    }
+    ast.nodes[ast.root].childCount = keptCount;
+
+    ast.compact();
+
+    return statementCount - keptCount;
+}
+
+void DeadCodeEliminator::markUses(int expression, UsageAnalysis& analysis, std::vector<char>& liveGlobals, std::vector<char>& liveFunctions)
+{
+    if (!analysis.markUses(expression, -1, liveGlobals, liveFunctions))
+    {
+        // A call of a function that is never defined or a recursion, everything is kept
+        liveGlobals.assign(liveGlobals.size(), 1);
+        liveFunctions.assign(liveFunctions.size(), 1);
+    }
+}
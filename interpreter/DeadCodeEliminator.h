@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Ast.h"
+#include "UsageAnalysis.h"
+#include <vector>
+
+/// @brief Class with methods that remove the statements that can't affect the output of a program
+class DeadCodeEliminator
+{
+public:
+    /// @brief Removes the assignments whose value is never read and the definitions of functions that are never called,
+    /// found with a liveness analysis over the statements from the last to the first.
+    /// The reads are kept (they consume the input), and so are the statements that can fail with a runtime error
+    /// and the definitions of functions that are defined more than once (the second definition fails)
+    /// @param ast The arena AST (it is compacted after the elimination)
+    /// @return The number of eliminated statements
+    static int eliminate(Ast& ast);
+
+private:
+    /// @brief Marks the globals and functions used by an expression as live
+    /// @param expression The index of the root node of the expression
+    /// @param analysis The usage analysis of the AST
+    /// @param liveGlobals Flags showing which globals are read later
+    /// @param liveFunctions Flags showing which functions are called later
+    static void markUses(int expression, UsageAnalysis& analysis, std::vector<char>& liveGlobals, std::vector<char>& liveFunctions);
+};
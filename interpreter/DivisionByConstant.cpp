@@ -0,0 +1,92 @@
+#include "DivisionByConstant.h"
+
+#include <climits>
+
+DivisionByConstant::DivisionByConstant(long long divisor) : divisor(divisor), multiplier(0), shift(0)
+{
+    unsigned long long absoluteDivisor = divisor < 0 ? 0 - (unsigned long long)divisor : (unsigned long long)divisor;
+
+    if ((absoluteDivisor & (absoluteDivisor - 1)) == 0)
+    {
+        while (((unsigned long long)1 << shift) != absoluteDivisor)
+        {
+            shift++;
+        }
+        return;
+    }
+
+    // The magic number of a signed division (Hacker's Delight, chapter 10), the smallest power 2^p for which
+    // 2^p / divisor rounded up gives exact quotients for every 64 bit dividend
+    const unsigned long long twoPower63 = (unsigned long long)1 << 63;
+
+    unsigned long long limit = twoPower63 + ((unsigned long long)divisor >> 63);
+    unsigned long long absoluteLimit = limit - 1 - limit % absoluteDivisor;
+
+    unsigned long long quotient1 = twoPower63 / absoluteLimit;
+    unsigned long long remainder1 = twoPower63 - quotient1 * absoluteLimit;
+    unsigned long long quotient2 = twoPower63 / absoluteDivisor;
+    unsigned long long remainder2 = twoPower63 - quotient2 * absoluteDivisor;
+    unsigned long long delta;
+
+    int power = 63;
+    do
+    {
+        power++;
+
+        quotient1 *= 2;
+        remainder1 *= 2;
+        if (remainder1 >= absoluteLimit)
+        {
+            quotient1++;
+            remainder1 -= absoluteLimit;
+        }
+
+        quotient2 *= 2;
+        remainder2 *= 2;
+        if (remainder2 >= absoluteDivisor)
+        {
+            quotient2++;
+            remainder2 -= absoluteDivisor;
+        }
+
+        delta = absoluteDivisor - remainder2;
+    } while (quotient1 < delta || (quotient1 == delta && remainder1 == 0));
+
+    multiplier = (long long)(quotient2 + 1);
+    if (divisor < 0)
+    {
+        multiplier = (long long)(0 - (unsigned long long)multiplier);
+    }
+    shift = power - 64;
+}
+
+bool DivisionByConstant::isReducible(long long divisor)
+{
+    return divisor != 0 && divisor != 1 && divisor != -1 && divisor != LLONG_MIN;
+}
+
+long long DivisionByConstant::multiplyHighPortable(long long left, long long right)
+{
+    // Unsigned product of the 32 bit halves, corrected for the signs of the operands
+    unsigned long long a = (unsigned long long)left;
+    unsigned long long b = (unsigned long long)right;
+
+    unsigned long long lowLow = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    unsigned long long highLow = (a >> 32) * (b & 0xFFFFFFFF);
+    unsigned long long lowHigh = (a & 0xFFFFFFFF) * (b >> 32);
+    unsigned long long highHigh = (a >> 32) * (b >> 32);
+
+    unsigned long long middle = (lowLow >> 32) + (highLow & 0xFFFFFFFF) + (lowHigh & 0xFFFFFFFF);
+    unsigned long long high = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+
+    if (left < 0)
+    {
+        high -= b;
+    }
+    if (right < 0)
+    {
+        high -= a;
+    }
+
+    return (long long)high;
+}
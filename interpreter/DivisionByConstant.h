@@ -0,0 +1,106 @@
+#pragma once
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#endif
+
+/// @brief Division and modulo by a constant computed with multiplication and shifts instead of a hardware division,
+/// the results are truncated toward zero like the C++ operators
+class DivisionByConstant
+{
+public:
+    /// @brief The divisor
+    long long divisor;
+    /// @brief The magic multiplier (0 when the divisor is a power of two)
+    long long multiplier;
+    /// @brief The shift applied after the multiplication (the exponent when the divisor is a power of two)
+    int shift;
+
+    /// @brief Base constructor (divides by one)
+    DivisionByConstant() : divisor(1), multiplier(0), shift(0) {}
+
+    /// @brief Constructor for computing the multiplier and the shift of a divisor
+    /// @param divisor The divisor (it must be reducible)
+    DivisionByConstant(long long divisor);
+
+    /// @brief Checks if a division by the divisor can be replaced. Division by 0 and -1 can trap, so they stay hardware divisions,
+    /// and the smallest number has no positive counterpart
+    /// @param divisor The divisor
+    /// @return True if the divisor can be used, otherwise false
+    static bool isReducible(long long divisor);
+
+    /// @brief Checks if the absolute value of the divisor is a power of two (the division is only shifts then)
+    /// @return True for a power of two, otherwise false
+    bool isPowerOfTwo() const { return multiplier == 0; }
+
+    /// @brief Divides a number by the divisor
+    /// @param value The dividend
+    /// @return The quotient truncated toward zero
+    long long divide(long long value) const
+    {
+        if (isPowerOfTwo())
+        {
+            // The negative numbers are rounded toward zero by adding divisor - 1 before the shift
+            long long quotient = (long long)((unsigned long long)value + getBias(value)) >> shift;
+            return divisor < 0 ? -quotient : quotient;
+        }
+
+        long long quotient = multiplyHigh(multiplier, value);
+        if (divisor > 0 && multiplier < 0)
+        {
+            quotient = (long long)((unsigned long long)quotient + (unsigned long long)value);
+        }
+        else if (divisor < 0 && multiplier > 0)
+        {
+            quotient = (long long)((unsigned long long)quotient - (unsigned long long)value);
+        }
+        quotient >>= shift;
+
+        // A negative quotient is one less than the truncated one
+        return quotient + (long long)((unsigned long long)quotient >> 63);
+    }
+
+    /// @brief Computes the remainder of the division of a number by the divisor
+    /// @param value The dividend
+    /// @return The remainder with the sign of the dividend
+    long long modulo(long long value) const
+    {
+        if (isPowerOfTwo())
+        {
+            unsigned long long mask = ((unsigned long long)1 << shift) - 1;
+            return (long long)((unsigned long long)value - (((unsigned long long)value + getBias(value)) & ~mask));
+        }
+
+        return (long long)((unsigned long long)value - (unsigned long long)divide(value) * (unsigned long long)divisor);
+    }
+
+    /// @brief Computes the high 64 bits of the 128 bit product of two numbers
+    /// @param left The left operand
+    /// @param right The right operand
+    /// @return The high half of the product
+    static long long multiplyHigh(long long left, long long right)
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        return __mulh(left, right);
+#elif defined(__SIZEOF_INT128__)
+        return (long long)(((__int128)left * right) >> 64);
+#else
+        return multiplyHighPortable(left, right);
+#endif
+    }
+
+private:
+    /// @brief Gets the value added to a dividend before the shift by a power of two (divisor - 1 for negative dividends)
+    /// @param value The dividend
+    /// @return The bias
+    unsigned long long getBias(long long value) const
+    {
+        return (unsigned long long)(value >> 63) >> (64 - shift);
+    }
+
+    /// @brief Computes the high 64 bits of a product with 32 bit multiplications (for compilers without 128 bit integers)
+    /// @param left The left operand
+    /// @param right The right operand
+    /// @return The high half of the product
+    static long long multiplyHighPortable(long long left, long long right);
+};
@@ -0,0 +1,67 @@
+#include "ExecutableMemory.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+ExecutableMemory::ExecutableMemory(const std::vector<unsigned char>& code) : memory(nullptr), size(code.size())
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    // The memory is never writable and executable at the same time:
+    // the code is copied while it is writable and then the block is switched to executable
+#ifdef _WIN32
+    memory = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (memory == nullptr)
+    {
+        throw std::runtime_error("Couldn't allocate executable memory");
+    }
+
+    std::memcpy(memory, code.data(), size);
+
+    DWORD oldProtection;
+    if (!VirtualProtect(memory, size, PAGE_EXECUTE_READ, &oldProtection))
+    {
+        VirtualFree(memory, 0, MEM_RELEASE);
+        throw std::runtime_error("Couldn't make memory executable");
+    }
+    FlushInstructionCache(GetCurrentProcess(), memory, size);
+#else
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        memory = nullptr;
+        throw std::runtime_error("Couldn't allocate executable memory");
+    }
+
+    std::memcpy(memory, code.data(), size);
+
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(memory, size);
+        throw std::runtime_error("Couldn't make memory executable");
+    }
+#endif
+}
+
+ExecutableMemory::~ExecutableMemory()
+{
+    if (memory == nullptr)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    munmap(memory, size);
+#endif
+}
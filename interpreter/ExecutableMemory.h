@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/// @brief Block of memory that holds generated machine code
+class ExecutableMemory
+{
+public:
+    /// @brief Constructor for creating an empty block
+    ExecutableMemory() : memory(nullptr), size(0) {}
+    /// @brief Constructor for creating a block with the given machine code (the block is made read only and executable)
+    /// @param code The machine code
+    ExecutableMemory(const std::vector<unsigned char>& code);
+    /// @brief Destructor that releases the memory
+    ~ExecutableMemory();
+
+    ExecutableMemory(const ExecutableMemory&) = delete;
+    ExecutableMemory& operator=(const ExecutableMemory&) = delete;
+
+    /// @brief Gets the address of a byte in the block
+    /// @param offset The offset of the byte
+    /// @return The address of the byte
+    void* address(std::size_t offset) const { return (unsigned char*)memory + offset; }
+
+private:
+    /// @brief The allocated memory
+    void* memory;
+    /// @brief The size of the allocated memory
+    std::size_t size;
+};
@@ -1,4 +1,5 @@
 #include "Executor.h"
+#include "Resolver.h"
 
 #include <stack>
 #include <unordered_set>
@@ -38,24 +39,58 @@ void Executor::deleteTree(Node& treeRoot)
     }
 }
 
-void Executor::execute(Node treeRoot, std::ostream& out, std::istream& in)
+long long Executor::parseNumber(const std::string& text)
+{
+    try
+    {
+        return std::stoul(text, nullptr, 10);
+    }
+    catch (const std::exception&)
+    {
+        throw std::invalid_argument("Invalid number");
+    }
+}
+
+long long Executor::readNumber(std::istream& in)
+{
+    std::string input;
+    in >> input;
+    try
+    {
+        return std::stoul(input, nullptr, 10);
+    }
+    catch (const std::exception&)
+    {
+        throw std::invalid_argument("Invalid number is entered");
+    }
+}
+
+void Executor::execute(Node treeRoot, std::ostream& out, std::istream& in, FunctionCache* cache)
 {
     {
         // Execution is done by traversing the AST with dfs iteratively
 
-        // We need stacks for the currently executed node, the results of the execution and a stack for the funtion call parameters, 
+        // The names are resolved to slots once, so the execution works only with flat arrays
+        SymbolTable symbols = Resolver::resolve(treeRoot);
+
+        if (cache != nullptr)
+        {
+            cache->prepare(treeRoot, symbols);
+        }
+
+        // We need stacks for the currently executed node, the results of the execution and a stack for the saved function parameters, 
         // hash map to track the visited nodes 
         std::stack<Node> executionStack;
         std::unordered_map<Node, int> visitedChildren;
         std::stack<long long> executionResults;
-        std::stack<std::pair<std::string, long long>> functionParameterStack;
+        std::stack<long long> functionParameterStack;
 
-        // We need hash maps to store the cuurent values of variables, 
-        // function definition nodes (for faster finding when called)
-        // and for the function paremeters
-        std::unordered_map<std::string, long long> variables;
-        std::unordered_map<std::string, Node> functions;
-        std::unordered_map<std::string, std::string> functionParametersMap;
+        // We need arrays to store the current values of variables (globals followed by the function parameters)
+        // with flags for the assigned ones, and the function definition nodes (for faster finding when called)
+        std::vector<long long> variables(symbols.variables.size(), 0);
+        std::vector<char> definedVariables(symbols.variables.size(), 0);
+        std::vector<Node> functions(symbols.functions.size());
+        std::vector<char> definedFunctions(symbols.functions.size(), 0);
 
         executionStack.push(treeRoot);
         visitedChildren.insert(std::pair<Node, int>(treeRoot, 0));
@@ -104,66 +139,32 @@ void Executor::execute(Node treeRoot, std::ostream& out, std::istream& in)
                         long long result = executionResults.top();
                         executionResults.pop();
 
-                        std::string varName = (*currNode.children)[0].value;
-                        if (variables.find(varName) == variables.end())
+                        int slot = (*currNode.children)[0].slot;
+                        variables[slot] = result;
+                        definedVariables[slot] = 1;
+
+                        if (cache != nullptr)
                         {
-                            variables.insert(std::pair<std::string, long long>(varName, 0));
+                            cache->onGlobalAssigned(slot);
                         }
-                        variables[varName] = result;
 
                         executionStack.pop();
                     }
                 }
-                // For variables, when a function is called (function params stack is not empty)
-                // we need to check if the variable is from the function and use its value
-                // or a global variable and retrieve it from the map
+                // Variables are resolved either to a global slot or to the parameter slot of the function they are in
                 else if (currNode.type == NodeType::variable)
                 {
-                    if (functionParameterStack.empty())
+                    if (!definedVariables[currNode.slot])
                     {
-                        if (variables.find(currNode.value) == variables.end())
-                        {
-                            throw std::invalid_argument("Use of undefined variable '" + currNode.value + "'");
-                        }
-                        executionResults.push(variables[currNode.value]);
-                    }
-                    else
-                    {
-                        std::pair<std::string, long long> funcParamPair = functionParameterStack.top();
-                        if (functionParametersMap.find(funcParamPair.first) == functionParametersMap.end())
-                        {
-                            throw std::invalid_argument("Incorrect function call");
-                        }
-
-                        if (functionParametersMap[funcParamPair.first] == currNode.value)
-                        {
-                            executionResults.push(funcParamPair.second);
-                        }
-                        else
-                        {
-                            if (variables.find(currNode.value) == variables.end())
-                            {
-                                throw std::invalid_argument("Use of undefined variable '" + currNode.value + "'");
-                            }
-                            executionResults.push(variables[currNode.value]);
-                        }
+                        throw std::invalid_argument("Use of undefined variable '" + currNode.value + "'");
                     }
+                    executionResults.push(variables[currNode.slot]);
 
                     executionStack.pop();
                 }
                 else if (currNode.type == NodeType::number)
                 {
-                    long long num;
-                    try
-                    {
-                        num = std::stoul(currNode.value, nullptr, 10);
-                    }
-                    catch (const std::exception&)
-                    {
-                        throw std::invalid_argument("Invalid number");
-                    }
-
-                    executionResults.push(num);
+                    executionResults.push(parseNumber(currNode.value));
 
                     executionStack.pop();
                 }
@@ -175,14 +176,27 @@ void Executor::execute(Node treeRoot, std::ostream& out, std::istream& in)
                     || currNode.type == NodeType::operation_divide
                     || currNode.type == NodeType::operation_modulo)
                 {
+                    // The constant divisors are precomputed by the resolver, so only the left operand is executed
+                    int operandCount = currNode.slot >= 0 ? 1 : (int)currNode.children->size();
+
                     int nextChildIndex = visitedChildren[currNode];
-                    if (nextChildIndex < currNode.children->size())
+                    if (nextChildIndex < operandCount)
                     {
                         Node child = (*currNode.children)[nextChildIndex];
                         executionStack.push(child);
                         visitedChildren[child] = 0;
                         visitedChildren[currNode]++;
                     }
+                    else if (currNode.slot >= 0)
+                    {
+                        long long left = executionResults.top();
+                        executionResults.pop();
+
+                        const DivisionByConstant& divisor = symbols.divisors[currNode.slot];
+                        executionResults.push(currNode.type == NodeType::operation_divide ? divisor.divide(left) : divisor.modulo(left));
+
+                        executionStack.pop();
+                    }
                     else
                     {
                         long long right = executionResults.top();
@@ -242,55 +256,36 @@ void Executor::execute(Node treeRoot, std::ostream& out, std::istream& in)
                 // Read has a single child with the variable which we set from the input stream
                 else if (currNode.type == NodeType::operation_read)
                 {
-                    int nextChildIndex = visitedChildren[currNode];
-                    if (visitedChildren[currNode] == 0)
-                    {
-                        visitedChildren[currNode]++;
-                    }
+                    int slot = (*currNode.children)[0].slot;
+                    variables[slot] = readNumber(in);
+                    definedVariables[slot] = 1;
 
-                    long long result;
-
-                    std::string varName = (*currNode.children)[0].value;
-                    if (variables.find(varName) == variables.end())
-                    {
-                        variables.insert(std::pair<std::string, long long>(varName, 0));
-                    }
-
-                    std::string input;
-                    in >> input;
-                    try
-                    {
-                        result = stoul(input, nullptr, 10);
-                    }
-                    catch (std::exception ex)
+                    if (cache != nullptr)
                     {
-                        throw std::invalid_argument("Invalid number is entered");
+                        cache->onGlobalAssigned(slot);
                     }
 
-                    variables[varName] = result;
-
                     executionStack.pop();
                 }
-                // For define function nodes we just save the node in the functions map for execution latter on a function call
+                // For define function nodes we just save the node in the functions array for execution latter on a function call
                 else if (currNode.type == NodeType::define_function)
                 {
-                    std::string funcName = currNode.value;
-                    if (functions.find(funcName) == functions.end())
-                    {
-                        functions.insert(std::pair<std::string, Node>(funcName, currNode));
-                    }
-                    else
+                    if (definedFunctions[currNode.slot])
                     {
-                        throw std::invalid_argument("Function " + funcName + " already defined!");
+                        throw std::invalid_argument("Function " + currNode.value + " already defined!");
                     }
+                    functions[currNode.slot] = currNode;
+                    definedFunctions[currNode.slot] = 1;
 
                     executionStack.pop();
                 }
                 // For fuction call, we first execute the single child (with the expression of the function parameter)
-                // then we find the function def and execute its expression by providing the value for its parameter
+                // then we find the function def and execute its expression by providing the value for its parameter,
+                // and when the function body is executed we restore the parameter of the caller
                 else if (currNode.type == NodeType::function)
                 {
                     int nextChildIndex = visitedChildren[currNode];
+                    int parameterSlot = symbols.getParameterSlot(currNode.slot);
                     if (nextChildIndex < currNode.children->size())
                     {
                         Node child = (*currNode.children)[nextChildIndex];
@@ -298,35 +293,46 @@ void Executor::execute(Node treeRoot, std::ostream& out, std::istream& in)
                         visitedChildren[child] = 0;
                         visitedChildren[currNode]++;
                     }
-                    else
+                    else if (nextChildIndex == currNode.children->size())
                     {
-                        if (functionParameterStack.empty()
-                            || functionParameterStack.top().first != currNode.value)
+                        long long result = executionResults.top();
+                        executionResults.pop();
+
+                        if (!definedFunctions[currNode.slot])
                         {
-                            long long result = executionResults.top();
-                            executionResults.pop();
+                            throw std::invalid_argument("Function " + currNode.value + " is not defined!");
+                        }
 
-                            if (functions.find(currNode.value) == functions.end())
-                            {
-                                throw std::invalid_argument("Function " + currNode.value + " is not defined!");
-                            }
+                        // When the result for the argument is cached, the body is not executed
+                        long long cachedResult;
+                        if (cache != nullptr && cache->find(currNode.slot, result, cachedResult))
+                        {
+                            executionResults.push(cachedResult);
 
-                            Node functionDefNode = functions[currNode.value];
-                            functionParametersMap[functionDefNode.value] = (*functionDefNode.children)[0].value;
+                            executionStack.pop();
+                            continue;
+                        }
 
-                            functionParameterStack.push(std::pair<std::string, long long>(functionDefNode.value, result));
+                        functionParameterStack.push(variables[parameterSlot]);
+                        variables[parameterSlot] = result;
+                        definedVariables[parameterSlot] = 1;
 
-                            Node child = (*functionDefNode.children)[1];
-                            executionStack.push(child);
-                            visitedChildren[child] = 0;
-                        }
-                        else
+                        Node child = (*functions[currNode.slot].children)[1];
+                        executionStack.push(child);
+                        visitedChildren[child] = 0;
+                        visitedChildren[currNode]++;
+                    }
+                    else
+                    {
+                        if (cache != nullptr)
                         {
-                            functionParameterStack.pop();
-
-                            executionStack.pop();
+                            cache->insert(currNode.slot, variables[parameterSlot], executionResults.top());
                         }
 
+                        variables[parameterSlot] = functionParameterStack.top();
+                        functionParameterStack.pop();
+
+                        executionStack.pop();
                     }
                 }
             }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Node.h"
+#include "FunctionCache.h"
 #include <iostream>
 #include <algorithm>
 
@@ -16,9 +17,20 @@ public:
     /// @param treeRoot The root node of the AST
     /// @param out The output stream
     /// @param in The input stream
-    static void execute(Node treeRoot, std::ostream& out, std::istream& in);
+    /// @param cache Cache for the results of the function calls (null to compute every call)
+    static void execute(Node treeRoot, std::ostream& out, std::istream& in, FunctionCache* cache = nullptr);
 
     /// @brief Deletes the AST (deletes the children vector)
     /// @param treeRoot The root of the tree
     static void deleteTree(Node& treeRoot);
+
+    /// @brief Converts the text of a number node to its value
+    /// @param text The text of the number
+    /// @return The value of the number
+    static long long parseNumber(const std::string& text);
+
+    /// @brief Reads a number from the input stream
+    /// @param in The input stream
+    /// @return The read number
+    static long long readNumber(std::istream& in);
 };
@@ -0,0 +1,200 @@
+#include "FunctionCache.h"
+
+#include <algorithm>
+
+void FunctionCache::prepare(const Node& treeRoot, const SymbolTable& symbols)
+{
+    int functionCount = (int)symbols.functions.size();
+
+    dependencies.assign(functionCount, std::vector<int>());
+    counters.assign(symbols.globalCount, -1);
+    versions.clear();
+    results.assign(functionCount, std::unordered_map<long long, long long>());
+    stamps.assign(functionCount, 0);
+    entries = 0;
+
+    // Find the globals and the functions used directly by the body of the first definition of every function,
+    // the marks keep the lists sparse and without duplicates
+    std::vector<std::vector<int>> readGlobals(functionCount);
+    std::vector<std::vector<int>> calledFunctions(functionCount);
+    std::vector<char> isDefinitionSeen(functionCount, 0);
+    std::vector<int> globalMarks(symbols.globalCount, -1);
+    std::vector<int> functionMarks(functionCount, -1);
+
+    for (const Node& statement : *treeRoot.children)
+    {
+        if (statement.type != NodeType::define_function || isDefinitionSeen[statement.slot])
+        {
+            continue;
+        }
+        isDefinitionSeen[statement.slot] = 1;
+
+        std::vector<const Node*> nodes{ &(*statement.children)[1] };
+        while (!nodes.empty())
+        {
+            const Node* currNode = nodes.back();
+            nodes.pop_back();
+
+            if (currNode->type == NodeType::variable && currNode->slot < symbols.globalCount)
+            {
+                if (globalMarks[currNode->slot] != statement.slot)
+                {
+                    globalMarks[currNode->slot] = statement.slot;
+                    readGlobals[statement.slot].push_back(currNode->slot);
+                }
+            }
+            else if (currNode->type == NodeType::function)
+            {
+                if (functionMarks[currNode->slot] != statement.slot)
+                {
+                    functionMarks[currNode->slot] = statement.slot;
+                    calledFunctions[statement.slot].push_back(currNode->slot);
+                }
+            }
+
+            for (const Node& child : *currNode->children)
+            {
+                nodes.push_back(&child);
+            }
+        }
+    }
+
+    // Add the globals of the called functions in the post order of an iterative dfs over the call graph, so every function
+    // merges the finished lists of its callees. A callee that is still on the stack closes a cycle, a call of such function
+    // always fails with the recursion error, so its incomplete list is never used for a result
+    std::fill(globalMarks.begin(), globalMarks.end(), -1);
+    // State of every function (0 - not visited, 1 - on the stack, 2 - done)
+    std::vector<char> states(functionCount, 0);
+    // The functions on the stack with the number of their visited callees
+    std::vector<std::pair<int, int>> dfsStack;
+
+    for (int start = 0; start < functionCount; start++)
+    {
+        if (states[start] != 0)
+        {
+            continue;
+        }
+
+        states[start] = 1;
+        dfsStack.push_back(std::pair<int, int>(start, 0));
+
+        while (!dfsStack.empty())
+        {
+            int function = dfsStack.back().first;
+            if (dfsStack.back().second < (int)calledFunctions[function].size())
+            {
+                int calledFunction = calledFunctions[function][dfsStack.back().second++];
+                if (states[calledFunction] == 0)
+                {
+                    states[calledFunction] = 1;
+                    dfsStack.push_back(std::pair<int, int>(calledFunction, 0));
+                }
+                continue;
+            }
+
+            states[function] = 2;
+            dfsStack.pop_back();
+
+            std::vector<int>& functionDependencies = dependencies[function];
+            auto addGlobal = [&](int slot)
+            {
+                if (globalMarks[slot] != function)
+                {
+                    globalMarks[slot] = function;
+                    functionDependencies.push_back(slot);
+                }
+            };
+
+            for (int slot : readGlobals[function])
+            {
+                addGlobal(slot);
+            }
+            for (int calledFunction : calledFunctions[function])
+            {
+                for (int slot : dependencies[calledFunction])
+                {
+                    addGlobal(slot);
+                }
+            }
+        }
+    }
+
+    // Only the globals read by some function get a version counter, the lists of the functions keep the counters instead of the slots
+    for (std::vector<int>& functionDependencies : dependencies)
+    {
+        for (int& dependency : functionDependencies)
+        {
+            if (counters[dependency] < 0)
+            {
+                counters[dependency] = (int)versions.size();
+                versions.push_back(0);
+            }
+            dependency = counters[dependency];
+        }
+    }
+}
+
+void FunctionCache::onGlobalAssigned(int slot)
+{
+    if (counters[slot] >= 0)
+    {
+        versions[counters[slot]]++;
+    }
+}
+
+bool FunctionCache::find(int function, long long argument, long long& result)
+{
+    // The results computed with other values of the globals are removed when the function is called again
+    long long stamp = getStamp(function);
+    if (stamps[function] != stamp)
+    {
+        entries -= results[function].size();
+        results[function].clear();
+        stamps[function] = stamp;
+    }
+
+    auto cached = results[function].find(argument);
+    if (cached == results[function].end())
+    {
+        misses++;
+        return false;
+    }
+
+    hits++;
+    result = cached->second;
+    return true;
+}
+
+void FunctionCache::insert(int function, long long argument, long long result)
+{
+    if (entries >= maxEntries)
+    {
+        for (std::unordered_map<long long, long long>& functionResults : results)
+        {
+            functionResults.clear();
+        }
+        entries = 0;
+    }
+
+    // The globals can't change while the function is computed, so the stamp from the lookup is still valid
+    if (results[function].insert(std::pair<long long, long long>(argument, result)).second)
+    {
+        entries++;
+    }
+}
+
+void FunctionCache::printStats(std::ostream& out) const
+{
+    out << "function cache: " << hits << " hits, " << misses << " misses" << std::endl;
+}
+
+long long FunctionCache::getStamp(int function) const
+{
+    long long stamp = 0;
+    for (int counter : dependencies[function])
+    {
+        stamp += versions[counter];
+    }
+
+    return stamp;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Node.h"
+#include "SymbolTable.h"
+#include <cstddef>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Cache with the results of the function calls of the tree executor.
+/// A function result depends only on the argument and on the globals the function reads (directly or through the
+/// functions it calls), so every function has its own table keyed by the argument, which is valid for one version
+/// stamp of those globals. An assignment invalidates only the tables of the functions that read the assigned global
+class FunctionCache
+{
+public:
+    /// @brief Constructor for creating an empty cache
+    /// @param maxEntries The maximum number of cached results of all functions
+    FunctionCache(std::size_t maxEntries = 4096) : maxEntries(maxEntries) {}
+
+    /// @brief Prepares the cache for a run of a program (the cached results of the previous run are removed)
+    /// @param treeRoot The root node of the AST with resolved slots
+    /// @param symbols The symbol table of the AST
+    void prepare(const Node& treeRoot, const SymbolTable& symbols);
+
+    /// @brief Marks that a global variable is assigned
+    /// @param slot The slot of the global
+    void onGlobalAssigned(int slot);
+
+    /// @brief Finds the cached result of a call (counts a hit or a miss)
+    /// @param function The function index
+    /// @param argument The argument of the call
+    /// @param result The cached result if it is found
+    /// @return True if the result is found, otherwise false
+    bool find(int function, long long argument, long long& result);
+
+    /// @brief Adds the result of a call (when the cache is full, all results are removed first)
+    /// @param function The function index
+    /// @param argument The argument of the call
+    /// @param result The result of the call
+    void insert(int function, long long argument, long long result);
+
+    /// @brief Gets the number of calls whose result was cached
+    long long getHits() const { return hits; }
+
+    /// @brief Gets the number of calls whose result was computed
+    long long getMisses() const { return misses; }
+
+    /// @brief Writes the hit and miss counters
+    /// @param out The stream the counters are written to
+    void printStats(std::ostream& out) const;
+
+private:
+    /// @brief Computes the version stamp of the globals a function reads
+    /// @param function The function index
+    /// @return The sum of the versions (the versions only grow, so every assignment changes the sum)
+    long long getStamp(int function) const;
+
+    /// @brief The version counters of the globals every function reads (directly or through the functions it calls)
+    std::vector<std::vector<int>> dependencies;
+    /// @brief The version counter of every global slot (-1 if no function reads the global)
+    std::vector<int> counters;
+    /// @brief Number of assignments of every global read by a function
+    std::vector<long long> versions;
+    /// @brief The cached results of every function by argument
+    std::vector<std::unordered_map<long long, long long>> results;
+    /// @brief The version stamp the results of every function are valid for
+    std::vector<long long> stamps;
+    /// @brief Number of cached results of all functions
+    std::size_t entries = 0;
+    /// @brief The maximum number of cached results of all functions
+    std::size_t maxEntries;
+    /// @brief Number of calls whose result was cached
+    long long hits = 0;
+    /// @brief Number of calls whose result was computed
+    long long misses = 0;
+};
@@ -0,0 +1,206 @@
+#include "Inliner.h"
+#include "UsageAnalysis.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+int Inliner::inlineCalls(Ast& ast, int sizeBudget)
+{
+    if (ast.root < 0)
+    {
+        return 0;
+    }
+
+    // The children of the nodes are replaced in place, so a shared node is copied for every parent first
+    if (ast.isShared)
+    {
+        ast.unshare();
+    }
+
+    int inlinedCalls = 0;
+
+    // The statements are executed in order, so a global assigned and a function defined by an earlier statement
+    // are surely defined. A function body is computed only after its first definition, so the same holds for it
+    std::vector<char> definedGlobals(ast.variables.size(), 0);
+    std::vector<InlinedBody> bodies(ast.functions.size());
+
+    // The expansions are added to the arena, so the nodes are accessed by index only
+    int statementCount = ast.nodes[ast.root].childCount;
+    for (int i = 0; i < statementCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+        NodeType statementType = ast.nodes[statement].type;
+
+        switch (statementType)
+        {
+        case NodeType::operation_assign:
+        case NodeType::operation_print:
+        {
+            int expressionPosition = ast.nodes[statement].firstChild + ast.nodes[statement].childCount - 1;
+            int expression = inlineExpression(ast, ast.childIndices[expressionPosition], -1, definedGlobals, bodies, sizeBudget, inlinedCalls);
+            ast.childIndices[expressionPosition] = expression;
+
+            if (statementType == NodeType::operation_assign)
+            {
+                definedGlobals[ast.nodes[ast.getChild(statement, 0)].value] = 1;
+            }
+        }
+        break;
+        case NodeType::operation_read:
+            definedGlobals[ast.nodes[ast.getChild(statement, 0)].value] = 1;
+            break;
+        case NodeType::define_function:
+        {
+            // Only the first definition of a function can be called
+            int function = (int)ast.nodes[statement].value;
+            if (bodies[function].definition < 0)
+            {
+                int bodyPosition = ast.nodes[statement].firstChild + 1;
+                long long functionParameter = ast.nodes[ast.getChild(statement, 0)].value;
+                int body = inlineExpression(ast, ast.childIndices[bodyPosition], functionParameter, definedGlobals, bodies, sizeBudget, inlinedCalls);
+                ast.childIndices[bodyPosition] = body;
+
+                // The function can be expanded only after its definition (so it can't be expanded in itself),
+                // its body doesn't change after that
+                bodies[function] = describeBody(ast, statement);
+            }
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    ast.compact();
+
+    return inlinedCalls;
+}
+
+int Inliner::inlineExpression(Ast& ast, int expression, long long parameter, const std::vector<char>& definedGlobals,
+    const std::vector<InlinedBody>& bodies, int sizeBudget, int& inlinedCalls)
+{
+    // The arguments are expanded before their call, so the calls in F[G[H[x]]] are expanded from the innermost
+    std::vector<int> postOrder = ast.getPostOrder(expression);
+
+    // The node every expanded call is replaced by, only the nodes of the expression are in it (not a vector over the whole arena,
+    // because the expressions of every statement are expanded one after another)
+    std::unordered_map<int, int> replacements;
+
+    // The size of every visited subtree (after the expansions in it) and whether it can fail, computed bottom-up,
+    // the ones of the children of a node are the last ones on the stack
+    std::vector<std::pair<long long, bool>> subtrees;
+    const std::vector<char> noSafeFunctions;
+
+    for (int node : postOrder)
+    {
+        for (int i = 0; i < ast.nodes[node].childCount; i++)
+        {
+            int& child = ast.childIndices[ast.nodes[node].firstChild + i];
+            auto replacement = replacements.find(child);
+            if (replacement != replacements.end())
+            {
+                child = replacement->second;
+            }
+        }
+
+        if (ast.nodes[node].type != NodeType::function)
+        {
+            int childCount = ast.nodes[node].childCount;
+            long long size = 1;
+            bool canFail = UsageAnalysis::canNodeFail(ast, node, parameter, definedGlobals, noSafeFunctions);
+            for (int i = (int)subtrees.size() - childCount; i < subtrees.size(); i++)
+            {
+                size += subtrees[i].first;
+                canFail = canFail || subtrees[i].second;
+            }
+            subtrees.resize(subtrees.size() - childCount);
+            subtrees.push_back(std::pair<long long, bool>(size, canFail));
+            continue;
+        }
+
+        // A call that isn't expanded can fail
+        std::pair<long long, bool> argument = subtrees.back();
+        subtrees.back() = std::pair<long long, bool>(argument.first + 1, true);
+
+        // The calls left in the argument are not expanded, so they may fail
+        const InlinedBody& body = bodies[ast.nodes[node].value];
+        if (body.definition < 0 || argument.second)
+        {
+            continue;
+        }
+
+        // Check that the body doesn't read a global named like the caller parameter
+        long long expansionSize = body.size + body.parameterUses * argument.first;
+        bool isCaptured = std::binary_search(body.globals.begin(), body.globals.end(), parameter);
+        if (isCaptured || expansionSize > sizeBudget)
+        {
+            continue;
+        }
+
+        long long calleeParameter = ast.nodes[ast.getChild(body.definition, 0)].value;
+        int expansion = copySubtree(ast, ast.getChild(body.definition, 1), calleeParameter, ast.getChild(node, 0));
+        replacements[node] = expansion;
+
+        // The expansion has at most sizeBudget nodes, so checking it again keeps the pass linear
+        subtrees.back() = std::pair<long long, bool>(expansionSize, UsageAnalysis::canFail(ast, expansion, parameter, definedGlobals, noSafeFunctions));
+
+        inlinedCalls++;
+    }
+
+    auto replacement = replacements.find(expression);
+    return replacement != replacements.end() ? replacement->second : expression;
+}
+
+InlinedBody Inliner::describeBody(const Ast& ast, int definition)
+{
+    InlinedBody body;
+    body.definition = definition;
+
+    long long parameter = ast.nodes[ast.getChild(definition, 0)].value;
+    for (int node : ast.getPostOrder(ast.getChild(definition, 1)))
+    {
+        const AstNode& currNode = ast.nodes[node];
+        if (currNode.type == NodeType::variable && currNode.value == parameter)
+        {
+            body.parameterUses++;
+            continue;
+        }
+
+        body.size++;
+        if (currNode.type == NodeType::variable)
+        {
+            body.globals.push_back(currNode.value);
+        }
+    }
+
+    std::sort(body.globals.begin(), body.globals.end());
+    body.globals.erase(std::unique(body.globals.begin(), body.globals.end()), body.globals.end());
+
+    return body;
+}
+
+int Inliner::copySubtree(Ast& ast, int subtree, long long parameter, int argument)
+{
+    // The nodes are copied in post order, so the copies of the children are known when their parent is copied
+    std::vector<int> postOrder = ast.getPostOrder(subtree);
+    std::vector<int> copies;
+
+    for (int node : postOrder)
+    {
+        AstNode currNode = ast.nodes[node];
+
+        if (currNode.type == NodeType::variable && currNode.value == parameter)
+        {
+            copies.push_back(copySubtree(ast, argument, -1, -1));
+            continue;
+        }
+
+        // The copied children are the last ones on the stack of copies
+        std::vector<int> children(copies.end() - currNode.childCount, copies.end());
+        copies.resize(copies.size() - children.size());
+
+        copies.push_back(ast.addNode(currNode.type, currNode.value, children));
+    }
+
+    return copies.back();
+}
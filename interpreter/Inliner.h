@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Ast.h"
+#include <vector>
+
+/// @brief The body of a surely defined function with what the inliner checks for every call of it
+class InlinedBody
+{
+public:
+    /// @brief The index of the first definition of the function (-1 if the function is not surely defined)
+    int definition = -1;
+    /// @brief The number of nodes of the body that aren't uses of the parameter
+    int size = 0;
+    /// @brief The number of uses of the parameter in the body
+    int parameterUses = 0;
+    /// @brief The sorted symbol ids of the globals read by the body
+    std::vector<long long> globals;
+};
+
+/// @brief Class with methods that expand the function calls of an AST in place
+class Inliner
+{
+public:
+    /// @brief Replaces the calls with the body of the called function where every use of the parameter is the argument.
+    /// A call is expanded only when it has the same result and errors as the call: the function is surely defined,
+    /// the argument can't fail (it is computed once by the call) and the body doesn't read a global with the name
+    /// of the parameter of the caller. The calls are expanded from the innermost, so F[G[H[x]]] becomes one expression
+    /// @param ast The arena AST (it is unshared before and compacted after the inlining)
+    /// @param sizeBudget The maximum number of nodes of an expanded call
+    /// @return The number of expanded calls
+    static int inlineCalls(Ast& ast, int sizeBudget = 64);
+
+private:
+    /// @brief Expands the calls of an expression in post order
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param definedGlobals Flags showing which globals are surely assigned when the expression is computed
+    /// @param bodies The body of every function (the definition is -1 for the functions that aren't surely defined)
+    /// @param sizeBudget The maximum number of nodes of an expanded call
+    /// @param inlinedCalls The number of expanded calls
+    /// @return The node that replaces the expression
+    static int inlineExpression(Ast& ast, int expression, long long parameter, const std::vector<char>& definedGlobals,
+        const std::vector<InlinedBody>& bodies, int sizeBudget, int& inlinedCalls);
+
+    /// @brief Counts the nodes and collects the globals of a function body once, so they aren't counted again for every call
+    /// @param ast The arena AST
+    /// @param definition The index of the definition node
+    /// @return The body
+    static InlinedBody describeBody(const Ast& ast, int definition);
+
+    /// @brief Copies a subtree to new nodes, the uses of a parameter are replaced by copies of another subtree
+    /// @param ast The arena AST
+    /// @param subtree The index of the root of the copied subtree
+    /// @param parameter The symbol id of the replaced parameter (-1 to copy the subtree as it is)
+    /// @param argument The index of the subtree that replaces the parameter
+    /// @return The index of the root of the copy
+    static int copySubtree(Ast& ast, int subtree, long long parameter, int argument);
+};
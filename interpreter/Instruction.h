@@ -0,0 +1,16 @@
+#pragma once
+#include "OpCode.h"
+
+/// @brief Single instruction of the bytecode
+class Instruction
+{
+public:
+    /// @brief The operation code
+    OpCode code;
+    /// @brief The operand (constant index, divisor index, variable slot, function index or unused)
+    int operand;
+    /// @brief Constructor for creating an instruction by operation code and operand
+    /// @param code The operation code
+    /// @param operand The operand
+    Instruction(OpCode code, int operand = 0) : code(code), operand(operand) {}
+};
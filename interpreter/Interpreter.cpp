@@ -2,22 +2,330 @@
 
 #include "Reader.h"
 #include "Tokenizer.h"
+#include "TokenBuffer.h"
+#include "SourceText.h"
+#include "CharacterScanner.h"
 #include "Executor.h"
 #include "Compiler.h"
+#include "Ast.h"
+#include "ConstantFolder.h"
+#include "Inliner.h"
+#include "DeadCodeEliminator.h"
+#include "CommonSubexpressionEliminator.h"
+#include "IrBuilder.h"
+#include "IrPasses.h"
+#include "Optimizer.h"
+#include "PartialEvaluator.h"
+#include "Resolver.h"
+#include "BytecodeCompiler.h"
+#include "VirtualMachine.h"
+#include "ClosureExecutor.h"
+#include "JitCompiler.h"
+#include "TieredExecutor.h"
+#include "Transpiler.h"
+#include "Benchmark.h"
+#include "BatchRunner.h"
+#include "StreamExecutor.h"
+#include "SpscQueue.h"
+#include "Pipeline.h"
+#include "ParallelCompiler.h"
+#include "SemanticAnalyzer.h"
 
-int main()
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+int main(int argc, char* argv[])
 {
+    // Usage: interpreter [--engine=tree|vm|closure|jit|tiered] [--stats] [--no-optimize] [--passes=name,...] [--known-input=value,...] [--batch] [--stream] [--pipeline] [--memoize] [--benchmark=iterations] [--threads=count]
+    //                    [--transpile=output | --transpile-shared=output] [program file | -]
+    std::string filePath = "test1.txt";
+    std::string engine = "tree";
+    int benchmarkIterations = 0;
+    int threadCount = 0;
+    std::string transpileOutput;
+    bool isSharedLibrary = false;
+    bool printStats = false;
+    bool optimize = true;
+    bool memoize = false;
+    bool isBatch = false;
+    bool isStream = false;
+    bool isPipeline = false;
+    std::vector<std::string> passes;
+    std::string knownInputList;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument.rfind("--engine=", 0) == 0)
+        {
+            engine = argument.substr(9);
+        }
+        else if (argument.rfind("--benchmark=", 0) == 0)
+        {
+            benchmarkIterations = std::stoi(argument.substr(12));
+        }
+        else if (argument.rfind("--threads=", 0) == 0)
+        {
+            // The number of threads that compile the program (0 for one per core)
+            threadCount = std::stoi(argument.substr(10));
+        }
+        else if (argument == "--stats")
+        {
+            printStats = true;
+        }
+        else if (argument == "--no-optimize")
+        {
+            optimize = false;
+        }
+        else if (argument.rfind("--passes=", 0) == 0)
+        {
+            // The optimization passes in running order, separated by commas
+            std::stringstream passList(argument.substr(9));
+            std::string pass;
+            while (std::getline(passList, pass, ','))
+            {
+                passes.push_back(pass);
+            }
+        }
+        else if (argument.rfind("--known-input=", 0) == 0)
+        {
+            // The values of the first reads, the program is specialized for them
+            knownInputList = argument.substr(14);
+        }
+        else if (argument == "--batch")
+        {
+            // Every line of the input is a separate input set
+            isBatch = true;
+        }
+        else if (argument == "--stream")
+        {
+            // The program is executed while it is read, one statement at a time
+            isStream = true;
+        }
+        else if (argument == "--pipeline")
+        {
+            // The program is executed like in streaming mode with the reader, the tokenizer and the compiler on other threads
+            isPipeline = true;
+        }
+        else if (argument == "--memoize")
+        {
+            memoize = true;
+        }
+        else if (argument.rfind("--transpile=", 0) == 0)
+        {
+            transpileOutput = argument.substr(12);
+        }
+        else if (argument.rfind("--transpile-shared=", 0) == 0)
+        {
+            transpileOutput = argument.substr(19);
+            isSharedLibrary = true;
+        }
+        else
+        {
+            filePath = argument;
+        }
+    }
+
     try
     {
-        std::vector<std::string> lines = Reader::readAllLines("test1.txt");
+        if (isPipeline)
+        {
+            std::ifstream programFile(filePath);
+            if (!programFile.is_open())
+            {
+                throw std::invalid_argument("Couldn't open file for reading");
+            }
+
+            Pipeline::execute(programFile, std::cout, std::cin, printStats ? &std::cerr : nullptr);
+
+            return 0;
+        }
+
+        // In streaming mode the whole program is never in memory, only the globals and the function definitions are kept
+        if (isStream)
+        {
+            std::ifstream programFile(filePath);
+            if (!programFile.is_open())
+            {
+                throw std::invalid_argument("Couldn't open file for reading");
+            }
+
+            int lines = StreamExecutor::execute(programFile, std::cout, std::cin);
+
+            if (printStats)
+            {
+                std::cerr << "stream: " << lines << " lines executed" << std::endl;
+            }
+
+            return 0;
+        }
+
+        // The file is mapped, so it is never copied, and its chunks of lines are tokenized and compiled on many threads
+        std::shared_ptr<const SourceText> source = Reader::readSource(filePath);
+
+        std::vector<long long> knownInputs;
+        std::stringstream knownInputValues(knownInputList);
+        std::string knownInput;
+        while (std::getline(knownInputValues, knownInput, ','))
+        {
+            std::istringstream knownInputStream(knownInput);
+            knownInputs.push_back(Executor::readNumber(knownInputStream));
+        }
+
+        if (benchmarkIterations > 0)
+        {
+            Node treeRoot = ParallelCompiler::compile(source, threadCount);
+            SemanticAnalyzer::check(Ast(treeRoot));
+
+            // Every run gets the same input, so it is read once
+            std::string input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+
+            Benchmark::run(treeRoot, input, benchmarkIterations, std::cout);
+
+            Executor::deleteTree(treeRoot);
+        }
+        else if (isBatch && engine == "tree" && transpileOutput.empty())
+        {
+            Node treeRoot = ParallelCompiler::compile(source, threadCount);
+            SemanticAnalyzer::check(Ast(treeRoot));
+
+            int sets = BatchRunner::run(treeRoot, knownInputs, std::cin, std::cout);
+
+            if (printStats)
+            {
+                std::cerr << "batch: " << sets << " input sets" << std::endl;
+            }
+
+            Executor::deleteTree(treeRoot);
+        }
+        else if (engine == "tree" && transpileOutput.empty())
+        {
+            Node treeRoot = ParallelCompiler::compile(source, threadCount);
+            SemanticAnalyzer::check(Ast(treeRoot));
+
+            // The function results are cached only when asked for, because the cache costs memory and time on every call
+            FunctionCache cache;
+
+            // The tree executor is the reference, so it gets the known values in front of the input instead of specializing the program
+            std::istringstream inputStream;
+            if (!knownInputs.empty())
+            {
+                std::string input;
+                for (long long value : knownInputs)
+                {
+                    input += std::to_string(value) + " ";
+                }
+                input.append(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+                inputStream.str(input);
+            }
+
+            Executor::execute(treeRoot, std::cout, knownInputs.empty() ? std::cin : inputStream, memoize ? &cache : nullptr);
+
+            if (memoize && printStats)
+            {
+                cache.printStats(std::cerr);
+            }
+
+            Executor::deleteTree(treeRoot);
+        }
+        else
+        {
+            // The other engines work on the arena AST, which is freed at once
+            Ast ast = ParallelCompiler::compileAst(source, threadCount);
+
+            // The symbols are checked before the program is executed, so all errors are reported at once
+            // and the engines execute the program without checking the definitions
+            SemanticAnalyzer::check(ast);
+
+            // The residual program reads only the inputs after the known ones, it can be executed or transpiled once and reused.
+            // In batch mode the program is specialized even without known inputs, so the expressions that don't depend on the input are computed once for all sets
+            // (the batch runner also executes the statements before the first read once)
+            if (!knownInputs.empty() || isBatch)
+            {
+                int computedExpressions = PartialEvaluator::specialize(ast, knownInputs);
+
+                if (printStats)
+                {
+                    std::cerr << "partial evaluation: " << computedExpressions << " expressions computed" << std::endl;
+                }
+            }
+
+            // The optimizations can be turned off to debug the engines on the AST as it is written
+            if (optimize)
+            {
+                Optimizer optimizer;
+                if (!passes.empty())
+                {
+                    optimizer.setPipeline(passes);
+                }
+
+                optimizer.optimize(ast);
+
+                if (printStats)
+                {
+                    optimizer.printStats(std::cerr);
+                }
+            }
+
+            if (!transpileOutput.empty())
+            {
+                std::string source = Transpiler::transpile(ast);
+
+                Transpiler::build(source, transpileOutput, isSharedLibrary);
+            }
+            else if (isBatch)
+            {
+                int sets = BatchRunner::run(ast, engine, std::cin, std::cout);
+
+                if (printStats)
+                {
+                    std::cerr << "batch: " << sets << " input sets" << std::endl;
+                }
+            }
+            else if (engine == "vm")
+            {
+                Bytecode bytecode = BytecodeCompiler::compile(ast);
+
+                VirtualMachine::execute(bytecode);
+            }
+            else if (engine == "closure")
+            {
+                ClosureProgram program = ClosureExecutor::compile(ast);
 
-        std::vector<Token> tokens = Tokenizer::tokenize(lines);
+                ClosureExecutor::execute(program);
+            }
+            else if (engine == "jit")
+            {
+                // Programs the JIT can't compile are executed by the virtual machine
+                JitProgram program;
+                if (JitCompiler::compile(ast, program))
+                {
+                    JitCompiler::execute(program);
+                }
+                else
+                {
+                    Bytecode bytecode = BytecodeCompiler::compile(ast);
 
-        Node treeRoot = Compiler::compile(tokens);
+                    VirtualMachine::execute(bytecode);
+                }
+            }
+            else if (engine == "tiered")
+            {
+                TieredExecutor executor(ast);
 
-        Executor::execute(treeRoot);
+                executor.execute();
 
-        Executor::deleteTree(treeRoot);
+                if (printStats)
+                {
+                    executor.printStats(std::cerr);
+                }
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown execution engine '" + engine + "'");
+            }
+        }
     }
     catch (const std::exception& ex)
     {
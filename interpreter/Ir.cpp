@@ -0,0 +1,337 @@
+#include "Ir.h"
+
+#include <stdexcept>
+#include <unordered_map>
+
+IrType IrInstruction::getType() const
+{
+    switch (opcode)
+    {
+    case IrOpcode::store_global:
+    case IrOpcode::print:
+    case IrOpcode::define_function:
+        return IrType::none;
+    default:
+        return IrType::integer;
+    }
+}
+
+bool IrInstruction::isStatement() const
+{
+    return opcode == IrOpcode::store_global
+        || opcode == IrOpcode::read_global
+        || opcode == IrOpcode::print
+        || opcode == IrOpcode::define_function;
+}
+
+int IrFunction::add(const IrInstruction& instruction)
+{
+    instructions.push_back(instruction);
+
+    return (int)instructions.size() - 1;
+}
+
+int IrFunction::replaceValues(const std::vector<int>& replacements)
+{
+    std::vector<int> newIndexes(instructions.size(), -1);
+
+    // The replacing values are earlier, so their new indexes are known when a replaced value is used
+    auto getNewIndex = [&replacements, &newIndexes](int value) -> int
+    {
+        while (replacements[value] >= 0 && replacements[value] != value)
+        {
+            value = replacements[value];
+        }
+        if (replacements[value] < 0)
+        {
+            throw std::invalid_argument("Invalid IR: removed value " + std::to_string(value) + " is still used");
+        }
+        return newIndexes[value];
+    };
+
+    std::vector<IrInstruction> oldInstructions;
+    oldInstructions.swap(instructions);
+
+    for (int i = 0; i < oldInstructions.size(); i++)
+    {
+        if (replacements[i] != i)
+        {
+            continue;
+        }
+
+        IrInstruction instruction = oldInstructions[i];
+        for (int j = 0; j < instruction.argumentCount; j++)
+        {
+            instruction.arguments[j] = getNewIndex(instruction.arguments[j]);
+        }
+
+        newIndexes[i] = add(instruction);
+    }
+
+    if (result >= 0)
+    {
+        result = getNewIndex(result);
+    }
+
+    return (int)(oldInstructions.size() - instructions.size());
+}
+
+std::vector<int> IrFunction::getUseCounts() const
+{
+    std::vector<int> useCounts(instructions.size(), 0);
+    for (const IrInstruction& instruction : instructions)
+    {
+        for (int j = 0; j < instruction.argumentCount; j++)
+        {
+            useCounts[instruction.arguments[j]]++;
+        }
+    }
+    if (result >= 0)
+    {
+        useCounts[result]++;
+    }
+
+    return useCounts;
+}
+
+std::vector<int> IrFunction::getStatementNumbers() const
+{
+    std::vector<int> statementNumbers(instructions.size(), 0);
+
+    int statementCount = 0;
+    for (const IrInstruction& instruction : instructions)
+    {
+        statementCount += instruction.isStatement() ? 1 : 0;
+    }
+
+    // Every value belongs to the first statement after it
+    int nextStatement = statementCount;
+    for (int i = (int)instructions.size() - 1; i >= 0; i--)
+    {
+        if (instructions[i].isStatement())
+        {
+            nextStatement--;
+        }
+        statementNumbers[i] = nextStatement;
+    }
+
+    return statementNumbers;
+}
+
+std::vector<int> IrFunction::getArgumentHolders() const
+{
+    std::vector<int> statementNumbers = getStatementNumbers();
+    std::vector<int> holders(instructions.size() * 2, -1);
+
+    // The value every global holds and the globals that hold every value
+    std::unordered_map<long long, int> heldValues;
+    std::unordered_map<int, std::vector<long long>> holdingGlobals;
+
+    auto hold = [&heldValues, &holdingGlobals](long long global, int value)
+    {
+        auto heldValue = heldValues.find(global);
+        if (heldValue != heldValues.end())
+        {
+            std::vector<long long>& globals = holdingGlobals[heldValue->second];
+            for (int i = 0; i < globals.size(); i++)
+            {
+                if (globals[i] == global)
+                {
+                    globals.erase(globals.begin() + i);
+                    break;
+                }
+            }
+        }
+
+        heldValues[global] = value;
+        holdingGlobals[value].push_back(global);
+    };
+
+    for (int i = 0; i < instructions.size(); i++)
+    {
+        const IrInstruction& instruction = instructions[i];
+
+        for (int j = 0; j < instruction.argumentCount; j++)
+        {
+            int argument = instruction.arguments[j];
+            if (statementNumbers[argument] != statementNumbers[i] && instructions[argument].opcode != IrOpcode::constant)
+            {
+                auto globals = holdingGlobals.find(argument);
+                if (globals != holdingGlobals.end() && !globals->second.empty())
+                {
+                    holders[i * 2 + j] = (int)globals->second.back();
+                }
+            }
+        }
+
+        switch (instruction.opcode)
+        {
+        case IrOpcode::store_global:
+            hold(instruction.operand, instruction.arguments[0]);
+            break;
+        case IrOpcode::read_global:
+            hold(instruction.operand, i);
+            break;
+        case IrOpcode::load_global:
+            // The loaded value is the value of the global, if the global already holds a value they are the same
+            if (heldValues.find(instruction.operand) == heldValues.end())
+            {
+                hold(instruction.operand, i);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    return holders;
+}
+
+int IrProgram::getInstructionCount() const
+{
+    int instructionCount = (int)main.instructions.size();
+    for (const IrFunction& definition : definitions)
+    {
+        instructionCount += (int)definition.instructions.size();
+    }
+
+    return instructionCount;
+}
+
+void IrProgram::verify() const
+{
+    verifyFunction(main, true);
+    for (const IrFunction& definition : definitions)
+    {
+        verifyFunction(definition, false);
+    }
+}
+
+void IrProgram::verifyFunction(const IrFunction& function, bool isMain) const
+{
+    std::string name = isMain ? "the main program" : "function " + (function.function >= 0 && function.function < functions.size() ? functions[function.function] : std::to_string(function.function));
+    auto fail = [&name](int instruction, const std::string& message)
+    {
+        std::string position = instruction >= 0 ? " at instruction " + std::to_string(instruction) : "";
+        throw std::invalid_argument("Invalid IR in " + name + position + ": " + message);
+    };
+
+    std::vector<int> useCounts = function.getUseCounts();
+
+    for (int i = 0; i < function.instructions.size(); i++)
+    {
+        const IrInstruction& instruction = function.instructions[i];
+
+        int expectedArguments = 0;
+        switch (instruction.opcode)
+        {
+        case IrOpcode::store_global:
+        case IrOpcode::print:
+        case IrOpcode::call:
+            expectedArguments = 1;
+            break;
+        case IrOpcode::add:
+        case IrOpcode::subtract:
+        case IrOpcode::multiply:
+        case IrOpcode::divide:
+        case IrOpcode::modulo:
+            expectedArguments = 2;
+            break;
+        default:
+            break;
+        }
+        if (instruction.argumentCount != expectedArguments)
+        {
+            fail(i, "wrong number of arguments");
+        }
+
+        for (int j = 0; j < instruction.argumentCount; j++)
+        {
+            int argument = instruction.arguments[j];
+            if (argument < 0 || argument >= i)
+            {
+                fail(i, "value " + std::to_string(argument) + " is used before it is defined");
+            }
+            if (function.instructions[argument].getType() != IrType::integer)
+            {
+                fail(i, "value " + std::to_string(argument) + " has no type");
+            }
+        }
+
+        switch (instruction.opcode)
+        {
+        case IrOpcode::load_global:
+        case IrOpcode::store_global:
+        case IrOpcode::read_global:
+            if (instruction.operand < 0 || instruction.operand >= (long long)variables.size())
+            {
+                fail(i, "unknown global");
+            }
+            break;
+        case IrOpcode::call:
+            if (instruction.operand < 0 || instruction.operand >= (long long)functions.size())
+            {
+                fail(i, "unknown function");
+            }
+            break;
+        case IrOpcode::define_function:
+            if (instruction.operand < 0 || instruction.operand >= (long long)definitions.size())
+            {
+                fail(i, "unknown definition");
+            }
+            break;
+        case IrOpcode::parameter:
+            if (isMain)
+            {
+                fail(i, "the main program has no parameter");
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (!isMain && instruction.isStatement())
+        {
+            fail(i, "statement in a function");
+        }
+
+        // A value that can fail is computed for its error, so it can't be left unused
+        bool canFail = instruction.opcode == IrOpcode::load_global || instruction.opcode == IrOpcode::call
+            || instruction.opcode == IrOpcode::divide || instruction.opcode == IrOpcode::modulo;
+        if (canFail && useCounts[i] == 0)
+        {
+            fail(i, "unused value that can fail");
+        }
+    }
+
+    if (isMain)
+    {
+        std::vector<int> statementNumbers = function.getStatementNumbers();
+        std::vector<int> holders = function.getArgumentHolders();
+        for (int i = 0; i < function.instructions.size(); i++)
+        {
+            const IrInstruction& instruction = function.instructions[i];
+            for (int j = 0; j < instruction.argumentCount; j++)
+            {
+                int argument = instruction.arguments[j];
+                if (statementNumbers[argument] != statementNumbers[i] && function.instructions[argument].opcode != IrOpcode::constant
+                    && holders[i * 2 + j] < 0)
+                {
+                    fail(i, "value " + std::to_string(argument) + " of an earlier statement is not held by a global");
+                }
+            }
+        }
+    }
+    else
+    {
+        if (function.function < 0 || function.function >= functions.size())
+        {
+            fail(-1, "unknown function");
+        }
+        if (function.result < 0 || function.result >= function.instructions.size()
+            || function.instructions[function.result].getType() != IrType::integer)
+        {
+            fail(-1, "invalid result");
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "IrOpcode.h"
+#include <string>
+#include <vector>
+
+/// @brief Type of the value an IR instruction defines
+enum class IrType
+{
+    /// @brief The instruction only has side effects
+    none,
+    /// @brief The instruction defines a 64 bit integer
+    integer,
+};
+
+/// @brief Single instruction of the SSA IR, its value is defined once and referred to by the index of the instruction
+class IrInstruction
+{
+public:
+    /// @brief The operation
+    IrOpcode opcode;
+    /// @brief The number of a constant, the symbol id of a global or a function, or the index of a definition (0 for the other instructions)
+    long long operand;
+    /// @brief The values used by the instruction (the indexes of the instructions that define them)
+    int arguments[2];
+    /// @brief Number of used values
+    int argumentCount;
+    /// @brief Constructor for creating an instruction
+    /// @param opcode The operation
+    /// @param operand The operand
+    /// @param left The first used value (-1 if none)
+    /// @param right The second used value (-1 if none)
+    IrInstruction(IrOpcode opcode, long long operand = 0, int left = -1, int right = -1)
+        : opcode(opcode), operand(operand), arguments{ left, right }, argumentCount(left < 0 ? 0 : (right < 0 ? 1 : 2)) {}
+
+    /// @brief Gets the type of the defined value
+    /// @return The type of the value
+    IrType getType() const;
+
+    /// @brief Checks if the instruction is a statement of the main program (it is executed for its side effect)
+    /// @return True for stores, reads, prints and function definitions, otherwise false
+    bool isStatement() const;
+};
+
+/// @brief Straight line sequence of instructions, the main program or the body of a function definition
+class IrFunction
+{
+public:
+    /// @brief The instructions (every value is defined before it is used)
+    std::vector<IrInstruction> instructions;
+    /// @brief The symbol id of the defined function (-1 for the main program)
+    int function = -1;
+    /// @brief The symbol id of the parameter (-1 for the main program)
+    long long parameter = -1;
+    /// @brief The value returned by the function (-1 for the main program)
+    int result = -1;
+
+    /// @brief Adds an instruction
+    /// @param instruction The instruction
+    /// @return The index of its value
+    int add(const IrInstruction& instruction);
+
+    /// @brief Replaces the uses of values and removes the replaced instructions
+    /// @param replacements The value every value is replaced by (the value itself to keep it, an earlier value to replace it, -1 to remove an unused value)
+    /// @return The number of removed instructions
+    int replaceValues(const std::vector<int>& replacements);
+
+    /// @brief Counts the uses of every value
+    /// @return The number of uses by value
+    std::vector<int> getUseCounts() const;
+
+    /// @brief Gets the statement every instruction of the main program belongs to
+    /// (the instructions before a statement compute the values it uses)
+    /// @return The statement number by instruction
+    std::vector<int> getStatementNumbers() const;
+
+    /// @brief Finds the global that holds each value of the main program that is used by a later statement
+    /// (the later statement reads the global instead of computing the value again)
+    /// @return The symbol id of the holding global by instruction and argument (index instruction * 2 + argument),
+    /// -1 for the values used by their own statement and the constants
+    std::vector<int> getArgumentHolders() const;
+};
+
+/// @brief Program in the SSA IR: the main program and the bodies of the function definitions
+class IrProgram
+{
+public:
+    /// @brief The main program
+    IrFunction main;
+    /// @brief The function definitions in program order
+    std::vector<IrFunction> definitions;
+    /// @brief Names of the variables by symbol id
+    std::vector<std::string> variables;
+    /// @brief Names of the functions by symbol id
+    std::vector<std::string> functions;
+
+    /// @brief Gets the number of instructions in the program
+    /// @return The number of instructions
+    int getInstructionCount() const;
+
+    /// @brief Checks the invariants of the IR (every value is defined before it is used and has the integer type,
+    /// the operands are valid symbols, the statements are only in the main program, a value used by a later statement is held by a global,
+    /// and only values that can't fail are unused)
+    /// @throws std::invalid_argument If an invariant doesn't hold
+    void verify() const;
+
+private:
+    /// @brief Checks the invariants of a function
+    /// @param function The function
+    /// @param isMain True for the main program
+    void verifyFunction(const IrFunction& function, bool isMain) const;
+};
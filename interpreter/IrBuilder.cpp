@@ -0,0 +1,202 @@
+#include "IrBuilder.h"
+
+#include <stdexcept>
+
+IrProgram IrBuilder::build(const Ast& ast)
+{
+    IrProgram program;
+    program.variables = ast.variables;
+    program.functions = ast.functions;
+
+    if (ast.root < 0)
+    {
+        return program;
+    }
+
+    const AstNode& root = ast.nodes[ast.root];
+    for (int i = 0; i < root.childCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+        const AstNode& statementNode = ast.nodes[statement];
+
+        switch (statementNode.type)
+        {
+        case NodeType::operation_assign:
+        {
+            int value = buildExpression(ast, ast.getChild(statement, 1), -1, program.main);
+            program.main.add(IrInstruction(IrOpcode::store_global, ast.nodes[ast.getChild(statement, 0)].value, value));
+        }
+        break;
+        case NodeType::operation_read:
+            program.main.add(IrInstruction(IrOpcode::read_global, ast.nodes[ast.getChild(statement, 0)].value));
+            break;
+        case NodeType::operation_print:
+            program.main.add(IrInstruction(IrOpcode::print, 0, buildExpression(ast, ast.getChild(statement, 0), -1, program.main)));
+            break;
+        case NodeType::define_function:
+        {
+            IrFunction definition;
+            definition.function = (int)statementNode.value;
+            definition.parameter = ast.nodes[ast.getChild(statement, 0)].value;
+            definition.result = buildExpression(ast, ast.getChild(statement, 1), definition.parameter, definition);
+
+            program.definitions.push_back(definition);
+            program.main.add(IrInstruction(IrOpcode::define_function, (long long)program.definitions.size() - 1));
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    return program;
+}
+
+Ast IrBuilder::lower(const IrProgram& program)
+{
+    Ast ast;
+
+    // The names are interned in the same order, so the symbol ids stay the same
+    for (const std::string& variable : program.variables)
+    {
+        ast.getVariableId(variable);
+    }
+    for (const std::string& function : program.functions)
+    {
+        ast.getFunctionId(function);
+    }
+
+    // Every value of a function body is a node, the values used more than once are shared until the AST is unshared
+    std::vector<int> bodies;
+    for (const IrFunction& definition : program.definitions)
+    {
+        std::vector<int> nodes(definition.instructions.size(), -1);
+        for (int i = 0; i < definition.instructions.size(); i++)
+        {
+            const IrInstruction& instruction = definition.instructions[i];
+
+            std::vector<int> arguments;
+            for (int j = 0; j < instruction.argumentCount; j++)
+            {
+                arguments.push_back(nodes[instruction.arguments[j]]);
+            }
+            nodes[i] = lowerValue(instruction, definition.parameter, arguments, ast);
+        }
+        bodies.push_back(nodes[definition.result]);
+    }
+
+    // The values of the main program are nodes of their own statement, the later statements read them from the globals holding them
+    const std::vector<IrInstruction>& instructions = program.main.instructions;
+    std::vector<int> holders = program.main.getArgumentHolders();
+    std::vector<int> nodes(instructions.size(), -1);
+    std::vector<int> statements;
+
+    for (int i = 0; i < instructions.size(); i++)
+    {
+        const IrInstruction& instruction = instructions[i];
+
+        std::vector<int> arguments;
+        for (int j = 0; j < instruction.argumentCount; j++)
+        {
+            int holder = holders[i * 2 + j];
+            arguments.push_back(holder >= 0 ? ast.addNode(NodeType::variable, holder) : nodes[instruction.arguments[j]]);
+        }
+
+        switch (instruction.opcode)
+        {
+        case IrOpcode::store_global:
+        {
+            int variable = ast.addNode(NodeType::variable, instruction.operand);
+            statements.push_back(ast.addNode(NodeType::operation_assign, 0, { variable, arguments[0] }));
+        }
+        break;
+        case IrOpcode::read_global:
+        {
+            int variable = ast.addNode(NodeType::variable, instruction.operand);
+            statements.push_back(ast.addNode(NodeType::operation_read, 0, { variable }));
+        }
+        break;
+        case IrOpcode::print:
+            statements.push_back(ast.addNode(NodeType::operation_print, 0, { arguments[0] }));
+            break;
+        case IrOpcode::define_function:
+        {
+            const IrFunction& definition = program.definitions[instruction.operand];
+            int parameter = ast.addNode(NodeType::variable, definition.parameter);
+            statements.push_back(ast.addNode(NodeType::define_function, definition.function, { parameter, bodies[instruction.operand] }));
+        }
+        break;
+        default:
+            nodes[i] = lowerValue(instruction, -1, arguments, ast);
+            break;
+        }
+    }
+
+    ast.root = ast.addNode(NodeType::root, 0, statements);
+
+    // The values used more than once are copied for every use, so the AST is a tree for the next passes
+    // (the unused values that can't fail are left out)
+    ast.unshare();
+
+    return ast;
+}
+
+int IrBuilder::buildExpression(const Ast& ast, int expression, long long parameter, IrFunction& function)
+{
+    // The nodes are converted in post order, so the values of the operands are known when their operator is converted
+    std::vector<int> values;
+    for (int node : ast.getPostOrder(expression))
+    {
+        const AstNode& astNode = ast.nodes[node];
+
+        switch (astNode.type)
+        {
+        case NodeType::number:
+            values.push_back(function.add(IrInstruction(IrOpcode::constant, astNode.value)));
+            break;
+        case NodeType::variable:
+            values.push_back(function.add(astNode.value == parameter ? IrInstruction(IrOpcode::parameter) : IrInstruction(IrOpcode::load_global, astNode.value)));
+            break;
+        case NodeType::function:
+            values.back() = function.add(IrInstruction(IrOpcode::call, astNode.value, values.back()));
+            break;
+        default:
+        {
+            IrOpcode opcode;
+            switch (astNode.type)
+            {
+            case NodeType::operation_add: opcode = IrOpcode::add; break;
+            case NodeType::operation_subtract: opcode = IrOpcode::subtract; break;
+            case NodeType::operation_multipy: opcode = IrOpcode::multiply; break;
+            case NodeType::operation_divide: opcode = IrOpcode::divide; break;
+            case NodeType::operation_modulo: opcode = IrOpcode::modulo; break;
+            default: throw std::invalid_argument("Unexpected node in expression");
+            }
+
+            int right = values.back();
+            values.pop_back();
+            values.back() = function.add(IrInstruction(opcode, 0, values.back(), right));
+        }
+        break;
+        }
+    }
+
+    return values.back();
+}
+
+int IrBuilder::lowerValue(const IrInstruction& instruction, long long parameter, const std::vector<int>& arguments, Ast& ast)
+{
+    switch (instruction.opcode)
+    {
+    case IrOpcode::constant: return ast.addNode(NodeType::number, instruction.operand);
+    case IrOpcode::parameter: return ast.addNode(NodeType::variable, parameter);
+    case IrOpcode::load_global: return ast.addNode(NodeType::variable, instruction.operand);
+    case IrOpcode::call: return ast.addNode(NodeType::function, instruction.operand, arguments);
+    case IrOpcode::add: return ast.addNode(NodeType::operation_add, 0, arguments);
+    case IrOpcode::subtract: return ast.addNode(NodeType::operation_subtract, 0, arguments);
+    case IrOpcode::multiply: return ast.addNode(NodeType::operation_multipy, 0, arguments);
+    case IrOpcode::divide: return ast.addNode(NodeType::operation_divide, 0, arguments);
+    case IrOpcode::modulo: return ast.addNode(NodeType::operation_modulo, 0, arguments);
+    default: throw std::invalid_argument("Unexpected instruction in expression");
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Ast.h"
+#include "Ir.h"
+
+/// @brief Class with methods that convert between the arena AST and the SSA IR
+class IrBuilder
+{
+public:
+    /// @brief Converts the AST to the IR (the expressions are flattened in evaluation order)
+    /// @param ast The arena AST
+    /// @return The program in the IR
+    static IrProgram build(const Ast& ast);
+
+    /// @brief Converts the IR back to an AST, so it can be executed by any engine.
+    /// A value used more than once in a statement is copied for every use (the AST is a tree) and a value of an earlier statement
+    /// is read from the global holding it
+    /// @param program The program in the IR
+    /// @return The arena AST
+    static Ast lower(const IrProgram& program);
+
+private:
+    /// @brief Adds the instructions of an expression in post order
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param function The function the instructions are added to
+    /// @return The value of the expression
+    static int buildExpression(const Ast& ast, int expression, long long parameter, IrFunction& function);
+
+    /// @brief Adds the node of a value computed by an instruction
+    /// @param instruction The instruction
+    /// @param parameter The symbol id of the parameter of the function (-1 for the main program)
+    /// @param arguments The nodes of the arguments
+    /// @param ast The arena AST the node is added to
+    /// @return The index of the node
+    static int lowerValue(const IrInstruction& instruction, long long parameter, const std::vector<int>& arguments, Ast& ast);
+};
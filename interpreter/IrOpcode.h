@@ -0,0 +1,27 @@
+#pragma once
+
+/// @brief Enumeration with the instructions of the SSA IR
+enum class IrOpcode
+{
+    /// @brief Defines the number operand
+    constant,
+    /// @brief Defines the parameter of the function
+    parameter,
+    /// @brief Defines the value of the global variable with symbol id operand
+    load_global,
+    /// @brief Stores the argument in the global variable with symbol id operand
+    store_global,
+    /// @brief Reads a number from the input, stores it in the global variable with symbol id operand and defines it
+    read_global,
+    /// @brief Prints the argument
+    print,
+    add,
+    subtract,
+    multiply,
+    divide,
+    modulo,
+    /// @brief Defines the result of the function with symbol id operand called with the argument
+    call,
+    /// @brief Defines the function with the definition index operand (fails if the function is already defined)
+    define_function,
+};
@@ -0,0 +1,267 @@
+#include "IrPasses.h"
+
+#include <climits>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+int IrPasses::forwardStores(IrProgram& program)
+{
+    int forwardedLoads = 0;
+
+    auto forward = [&forwardedLoads](IrFunction& function)
+    {
+        std::vector<int> replacements(function.instructions.size());
+        std::unordered_map<long long, int> heldValues;
+
+        for (int i = 0; i < function.instructions.size(); i++)
+        {
+            const IrInstruction& instruction = function.instructions[i];
+            replacements[i] = i;
+
+            switch (instruction.opcode)
+            {
+            case IrOpcode::load_global:
+            {
+                // The expressions don't assign globals, so a loaded value stays valid until the next store
+                auto heldValue = heldValues.find(instruction.operand);
+                if (heldValue != heldValues.end())
+                {
+                    replacements[i] = heldValue->second;
+                    forwardedLoads++;
+                }
+                else
+                {
+                    heldValues[instruction.operand] = i;
+                }
+            }
+            break;
+            case IrOpcode::store_global:
+                heldValues[instruction.operand] = replacements[instruction.arguments[0]];
+                break;
+            case IrOpcode::read_global:
+                heldValues[instruction.operand] = i;
+                break;
+            default:
+                break;
+            }
+        }
+
+        function.replaceValues(replacements);
+    };
+
+    forward(program.main);
+    for (IrFunction& definition : program.definitions)
+    {
+        forward(definition);
+    }
+
+    return forwardedLoads;
+}
+
+int IrPasses::foldConstants(IrProgram& program)
+{
+    int foldedOperations = 0;
+
+    auto fold = [&foldedOperations](IrFunction& function)
+    {
+        for (IrInstruction& instruction : function.instructions)
+        {
+            if (instruction.argumentCount != 2
+                || function.instructions[instruction.arguments[0]].opcode != IrOpcode::constant
+                || function.instructions[instruction.arguments[1]].opcode != IrOpcode::constant)
+            {
+                continue;
+            }
+
+            // The arithmetic wraps around like the hardware operations
+            unsigned long long left = (unsigned long long)function.instructions[instruction.arguments[0]].operand;
+            unsigned long long right = (unsigned long long)function.instructions[instruction.arguments[1]].operand;
+            long long leftValue = (long long)left;
+            long long rightValue = (long long)right;
+
+            long long result;
+            switch (instruction.opcode)
+            {
+            case IrOpcode::add:
+                result = (long long)(left + right);
+                break;
+            case IrOpcode::subtract:
+                result = (long long)(left - right);
+                break;
+            case IrOpcode::multiply:
+                result = (long long)(left * right);
+                break;
+            case IrOpcode::divide:
+            case IrOpcode::modulo:
+                if (rightValue == 0 || (rightValue == -1 && leftValue == LLONG_MIN))
+                {
+                    continue;
+                }
+                result = instruction.opcode == IrOpcode::divide ? leftValue / rightValue : leftValue % rightValue;
+                break;
+            default:
+                continue;
+            }
+
+            instruction = IrInstruction(IrOpcode::constant, result);
+            foldedOperations++;
+        }
+    };
+
+    fold(program.main);
+    for (IrFunction& definition : program.definitions)
+    {
+        fold(definition);
+    }
+
+    return foldedOperations;
+}
+
+int IrPasses::numberValues(IrProgram& program)
+{
+    int replacedValues = 0;
+
+    auto number = [&replacedValues](IrFunction& function)
+    {
+        std::vector<int> statementNumbers = function.getStatementNumbers();
+        std::vector<int> replacements(function.instructions.size());
+
+        // The key of a value is its statement (-1 for the constants, they are the same everywhere), operation, operand and arguments
+        std::map<std::tuple<int, int, long long, int, int>, int> values;
+
+        for (int i = 0; i < function.instructions.size(); i++)
+        {
+            const IrInstruction& instruction = function.instructions[i];
+            replacements[i] = i;
+
+            if (instruction.isStatement() || instruction.getType() != IrType::integer)
+            {
+                continue;
+            }
+
+            int left = instruction.argumentCount > 0 ? replacements[instruction.arguments[0]] : -1;
+            int right = instruction.argumentCount > 1 ? replacements[instruction.arguments[1]] : -1;
+            if ((instruction.opcode == IrOpcode::add || instruction.opcode == IrOpcode::multiply) && left > right)
+            {
+                std::swap(left, right);
+            }
+
+            int statement = instruction.opcode == IrOpcode::constant ? -1 : statementNumbers[i];
+            auto key = std::make_tuple(statement, (int)instruction.opcode, instruction.operand, left, right);
+
+            // The earlier value is computed first, so it fails first if the computation can fail
+            auto value = values.find(key);
+            if (value != values.end())
+            {
+                replacements[i] = value->second;
+                replacedValues++;
+            }
+            else
+            {
+                values.insert(std::make_pair(key, i));
+            }
+        }
+
+        function.replaceValues(replacements);
+    };
+
+    number(program.main);
+    for (IrFunction& definition : program.definitions)
+    {
+        number(definition);
+    }
+
+    return replacedValues;
+}
+
+int IrPasses::eliminateDeadValues(IrProgram& program)
+{
+    int removedValues = 0;
+
+    auto eliminate = [&removedValues, &program](IrFunction& function, bool isMain)
+    {
+        std::vector<int> useCounts = function.getUseCounts();
+        std::vector<int> replacements(function.instructions.size());
+
+        // A load in the main program can't fail if the global is assigned (or loaded successfully) before it
+        std::vector<char> isLoadSafe(function.instructions.size(), 0);
+        if (isMain)
+        {
+            std::vector<char> definedGlobals(program.variables.size(), 0);
+            for (int i = 0; i < function.instructions.size(); i++)
+            {
+                const IrInstruction& instruction = function.instructions[i];
+                replacements[i] = i;
+
+                if (instruction.opcode == IrOpcode::load_global)
+                {
+                    isLoadSafe[i] = definedGlobals[instruction.operand];
+                }
+                if (instruction.opcode == IrOpcode::load_global || instruction.opcode == IrOpcode::store_global
+                    || instruction.opcode == IrOpcode::read_global)
+                {
+                    definedGlobals[instruction.operand] = 1;
+                }
+            }
+        }
+
+        // The values are visited backwards, so the arguments of a removed value are visited after their uses are updated
+        for (int i = (int)function.instructions.size() - 1; i >= 0; i--)
+        {
+            const IrInstruction& instruction = function.instructions[i];
+            replacements[i] = i;
+
+            if (instruction.isStatement() || useCounts[i] > 0)
+            {
+                continue;
+            }
+
+            bool canFail;
+            switch (instruction.opcode)
+            {
+            case IrOpcode::constant:
+            case IrOpcode::parameter:
+            case IrOpcode::add:
+            case IrOpcode::subtract:
+            case IrOpcode::multiply:
+                canFail = false;
+                break;
+            case IrOpcode::divide:
+            case IrOpcode::modulo:
+            {
+                const IrInstruction& divisor = function.instructions[instruction.arguments[1]];
+                canFail = divisor.opcode != IrOpcode::constant || divisor.operand == 0 || divisor.operand == -1;
+            }
+            break;
+            case IrOpcode::load_global:
+                canFail = !isLoadSafe[i];
+                break;
+            default:
+                canFail = true;
+                break;
+            }
+
+            if (!canFail)
+            {
+                replacements[i] = -1;
+                for (int j = 0; j < instruction.argumentCount; j++)
+                {
+                    useCounts[instruction.arguments[j]]--;
+                }
+                removedValues++;
+            }
+        }
+
+        function.replaceValues(replacements);
+    };
+
+    eliminate(program.main, true);
+    for (IrFunction& definition : program.definitions)
+    {
+        eliminate(definition, false);
+    }
+
+    return removedValues;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Ir.h"
+
+/// @brief Class with the optimization passes of the SSA IR, every pass returns the number of changes it made
+class IrPasses
+{
+public:
+    /// @brief Replaces the loads of globals by the value the global is known to hold
+    /// (the last stored, read or loaded value in the main program and the first loaded value in a function body)
+    /// @param program The program in the IR
+    /// @return The number of forwarded loads
+    static int forwardStores(IrProgram& program);
+
+    /// @brief Computes the operations on constants (the divisions that trap are left for the runtime)
+    /// @param program The program in the IR
+    /// @return The number of folded operations
+    static int foldConstants(IrProgram& program);
+
+    /// @brief Replaces the values that repeat an earlier instruction of the same statement with the same arguments (value numbering)
+    /// @param program The program in the IR
+    /// @return The number of replaced values
+    static int numberValues(IrProgram& program);
+
+    /// @brief Removes the unused values that can't fail
+    /// @param program The program in the IR
+    /// @return The number of removed values
+    static int eliminateDeadValues(IrProgram& program);
+};
@@ -0,0 +1,469 @@
+#include "JitCompiler.h"
+#include "Executor.h"
+#include "SemanticAnalyzer.h"
+#include "DivisionByConstant.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace
+{
+    /// @brief Registers used by the generated code
+    enum Register
+    {
+        rax = 0,
+        rcx = 1,
+    };
+
+    /// @brief Buffer with methods that emit x86-64 instructions
+    class CodeBuffer
+    {
+    public:
+        std::vector<unsigned char> bytes;
+
+        void emit(std::initializer_list<unsigned char> code)
+        {
+            bytes.insert(bytes.end(), code);
+        }
+
+        void emit32(std::int32_t value)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                bytes.push_back((unsigned char)((std::uint32_t)value >> (i * 8)));
+            }
+        }
+
+        void emit64(long long value)
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                bytes.push_back((unsigned char)((unsigned long long)value >> (i * 8)));
+            }
+        }
+
+        // The function receives the globals pointer and the parameter,
+        // they are kept in the callee saved registers rbx and r12
+        void emitPrologue()
+        {
+            emit({ 0x53 });                     // push rbx
+            emit({ 0x41, 0x54 });               // push r12
+#ifdef _WIN32
+            emit({ 0x48, 0x89, 0xCB });         // mov rbx, rcx
+            emit({ 0x49, 0x89, 0xD4 });         // mov r12, rdx
+#else
+            emit({ 0x48, 0x89, 0xFB });         // mov rbx, rdi
+            emit({ 0x49, 0x89, 0xF4 });         // mov r12, rsi
+#endif
+        }
+
+        void emitEpilogue()
+        {
+            emit({ 0x41, 0x5C });               // pop r12
+            emit({ 0x5B });                     // pop rbx
+            emit({ 0xC3 });                     // ret
+        }
+
+        void emitLoadConstant(Register target, long long value)
+        {
+            if (value >= INT32_MIN && value <= INT32_MAX)
+            {
+                emit({ 0x48, 0xC7, (unsigned char)(0xC0 + target) });  // mov target, imm32
+                emit32((std::int32_t)value);
+            }
+            else
+            {
+                emit({ 0x48, (unsigned char)(0xB8 + target) });        // mov target, imm64
+                emit64(value);
+            }
+        }
+
+        void emitLoadGlobal(Register target, int slot)
+        {
+            emit({ 0x48, 0x8B, (unsigned char)(0x83 | (target << 3)) }); // mov target, [rbx + slot * 8]
+            emit32(slot * 8);
+        }
+
+        void emitLoadParameter(Register target)
+        {
+            emit({ 0x4C, 0x89, (unsigned char)(0xE0 + target) });  // mov target, r12
+        }
+
+        // Computes rax = rax (operation) rcx
+        void emitOperation(NodeType type)
+        {
+            switch (type)
+            {
+            case NodeType::operation_add:
+                emit({ 0x48, 0x01, 0xC8 });         // add rax, rcx
+                break;
+            case NodeType::operation_subtract:
+                emit({ 0x48, 0x29, 0xC8 });         // sub rax, rcx
+                break;
+            case NodeType::operation_multipy:
+                emit({ 0x48, 0x0F, 0xAF, 0xC1 });   // imul rax, rcx
+                break;
+            case NodeType::operation_divide:
+                emit({ 0x48, 0x99 });               // cqo
+                emit({ 0x48, 0xF7, 0xF9 });         // idiv rcx
+                break;
+            case NodeType::operation_modulo:
+                emit({ 0x48, 0x99 });               // cqo
+                emit({ 0x48, 0xF7, 0xF9 });         // idiv rcx
+                emit({ 0x48, 0x89, 0xD0 });         // mov rax, rdx
+                break;
+            default:
+                throw std::invalid_argument("Unexpected node in expression");
+            }
+        }
+
+        // Computes rax = rax (operation) constant, returns false if there is no short form for the operation
+        bool emitOperationWithConstant(NodeType type, long long value)
+        {
+            if (value < INT32_MIN || value > INT32_MAX)
+            {
+                return false;
+            }
+
+            switch (type)
+            {
+            case NodeType::operation_add:
+                emit({ 0x48, 0x05 });               // add rax, imm32
+                break;
+            case NodeType::operation_subtract:
+                emit({ 0x48, 0x2D });               // sub rax, imm32
+                break;
+            case NodeType::operation_multipy:
+                emit({ 0x48, 0x69, 0xC0 });         // imul rax, rax, imm32
+                break;
+            default:
+                return false;
+            }
+            emit32((std::int32_t)value);
+
+            return true;
+        }
+
+        // Computes rax = rax / constant or rax % constant with multiplication and shifts,
+        // returns false if the divisor has to be used by a hardware division
+        bool emitDivisionByConstant(NodeType type, long long value)
+        {
+            if ((type != NodeType::operation_divide && type != NodeType::operation_modulo) || !DivisionByConstant::isReducible(value))
+            {
+                return false;
+            }
+
+            DivisionByConstant divisor(value);
+
+            emit({ 0x48, 0x89, 0xC1 });             // mov rcx, rax (the dividend)
+
+            if (divisor.isPowerOfTwo())
+            {
+                // The negative dividends get the bias divisor - 1, so the shift rounds toward zero
+                emit({ 0x48, 0xC1, 0xF9, 0x3F });   // sar rcx, 63
+                emit({ 0x48, 0xC1, 0xE9, (unsigned char)(64 - divisor.shift) });  // shr rcx, 64 - shift
+                emit({ 0x48, 0x01, 0xC1 });         // add rcx, rax
+
+                if (type == NodeType::operation_divide)
+                {
+                    emit({ 0x48, 0xC1, 0xF9, (unsigned char)divisor.shift });  // sar rcx, shift
+                    emit({ 0x48, 0x89, 0xC8 });     // mov rax, rcx
+                    if (value < 0)
+                    {
+                        emit({ 0x48, 0xF7, 0xD8 }); // neg rax
+                    }
+                }
+                else
+                {
+                    emit({ 0x48, 0xBA });           // mov rdx, imm64
+                    emit64((long long)~(((unsigned long long)1 << divisor.shift) - 1));
+                    emit({ 0x48, 0x21, 0xD1 });     // and rcx, rdx
+                    emit({ 0x48, 0x29, 0xC8 });     // sub rax, rcx
+                }
+                return true;
+            }
+
+            emitLoadConstant(Register::rax, divisor.multiplier);
+            emit({ 0x48, 0xF7, 0xE9 });             // imul rcx (rdx = high half of the product)
+            if (value > 0 && divisor.multiplier < 0)
+            {
+                emit({ 0x48, 0x01, 0xCA });         // add rdx, rcx
+            }
+            else if (value < 0 && divisor.multiplier > 0)
+            {
+                emit({ 0x48, 0x29, 0xCA });         // sub rdx, rcx
+            }
+            if (divisor.shift > 0)
+            {
+                emit({ 0x48, 0xC1, 0xFA, (unsigned char)divisor.shift });  // sar rdx, shift
+            }
+            emit({ 0x48, 0x89, 0xD0 });             // mov rax, rdx
+            emit({ 0x48, 0xC1, 0xE8, 0x3F });       // shr rax, 63
+            emit({ 0x48, 0x01, 0xD0 });             // add rax, rdx
+
+            if (type == NodeType::operation_modulo)
+            {
+                // remainder = dividend - quotient * divisor
+                if (value >= INT32_MIN && value <= INT32_MAX)
+                {
+                    emit({ 0x48, 0x69, 0xC0 });     // imul rax, rax, imm32
+                    emit32((std::int32_t)value);
+                }
+                else
+                {
+                    emit({ 0x48, 0xBA });           // mov rdx, imm64
+                    emit64(value);
+                    emit({ 0x48, 0x0F, 0xAF, 0xC2 });  // imul rax, rdx
+                }
+                emit({ 0x48, 0x29, 0xC1 });         // sub rcx, rax
+                emit({ 0x48, 0x89, 0xC8 });         // mov rax, rcx
+            }
+
+            return true;
+        }
+
+        // Calls the function at the returned offset with the argument in rax
+        std::size_t emitCall()
+        {
+#ifdef _WIN32
+            emit({ 0x48, 0x89, 0xD9 });         // mov rcx, rbx
+            emit({ 0x48, 0x89, 0xC2 });         // mov rdx, rax
+            emit({ 0x48, 0x83, 0xEC, 0x20 });   // sub rsp, 32 (shadow space)
+#else
+            emit({ 0x48, 0x89, 0xDF });         // mov rdi, rbx
+            emit({ 0x48, 0x89, 0xC6 });         // mov rsi, rax
+#endif
+            emit({ 0xE8 });                     // call rel32
+            std::size_t patchOffset = bytes.size();
+            emit32(0);
+#ifdef _WIN32
+            emit({ 0x48, 0x83, 0xC4, 0x20 });   // add rsp, 32
+#endif
+            return patchOffset;
+        }
+    };
+
+    /// @brief Checks if the node is loaded directly to a register (without evaluating other nodes)
+    bool isLeaf(const AstNode& node)
+    {
+        return node.type == NodeType::number || node.type == NodeType::variable;
+    }
+
+    /// @brief Emits a native function that computes an expression
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param code The code buffer
+    /// @param calls The call instructions that have to be patched with the function offsets
+    void emitFunction(const Ast& ast, int expression, long long parameter, CodeBuffer& code, std::vector<std::pair<std::size_t, int>>& calls)
+    {
+        code.emitPrologue();
+
+        // The variable symbol ids are the global slots
+        auto emitLeaf = [&](const AstNode& node, Register target)
+        {
+            if (node.type == NodeType::number)
+            {
+                code.emitLoadConstant(target, node.value);
+            }
+            else if (node.value == parameter)
+            {
+                code.emitLoadParameter(target);
+            }
+            else
+            {
+                code.emitLoadGlobal(target, (int)node.value);
+            }
+        };
+
+        // Iterative dfs where the state shows which operands are already computed
+        // (0 - none, 1 - the left operand is in rax, 2 - the right operand is in rax and the left one is on the stack)
+        std::vector<std::pair<int, int>> emitStack{ std::pair<int, int>(expression, 0) };
+        while (!emitStack.empty())
+        {
+            int currIndex = emitStack.back().first;
+            const AstNode& currNode = ast.nodes[currIndex];
+            int state = emitStack.back().second;
+
+            if (isLeaf(currNode))
+            {
+                emitLeaf(currNode, Register::rax);
+                emitStack.pop_back();
+            }
+            else if (currNode.type == NodeType::function)
+            {
+                if (state == 0)
+                {
+                    emitStack.back().second = 1;
+                    emitStack.push_back(std::pair<int, int>(ast.getChild(currIndex, 0), 0));
+                }
+                else
+                {
+                    calls.push_back(std::pair<std::size_t, int>(code.emitCall(), (int)currNode.value));
+                    emitStack.pop_back();
+                }
+            }
+            else
+            {
+                int left = ast.getChild(currIndex, 0);
+                int right = ast.getChild(currIndex, 1);
+                const AstNode& rightNode = ast.nodes[right];
+
+                if (state == 0)
+                {
+                    emitStack.back().second = 1;
+                    emitStack.push_back(std::pair<int, int>(left, 0));
+                }
+                else if (state == 1 && isLeaf(rightNode))
+                {
+                    // Simple right operands are loaded directly without saving the left operand
+                    if (rightNode.type != NodeType::number
+                        || (!code.emitOperationWithConstant(currNode.type, rightNode.value)
+                            && !code.emitDivisionByConstant(currNode.type, rightNode.value)))
+                    {
+                        emitLeaf(rightNode, Register::rcx);
+                        code.emitOperation(currNode.type);
+                    }
+                    emitStack.pop_back();
+                }
+                else if (state == 1)
+                {
+                    code.emit({ 0x50 });                // push rax
+                    emitStack.back().second = 2;
+                    emitStack.push_back(std::pair<int, int>(right, 0));
+                }
+                else
+                {
+                    code.emit({ 0x48, 0x89, 0xC1 });    // mov rcx, rax
+                    code.emit({ 0x58 });                // pop rax
+                    code.emitOperation(currNode.type);
+                    emitStack.pop_back();
+                }
+            }
+        }
+
+        code.emitEpilogue();
+    }
+}
+
+bool JitCompiler::isAvailable()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool JitCompiler::compile(const Node& treeRoot, JitProgram& program)
+{
+    try
+    {
+        return compile(Ast(treeRoot), program);
+    }
+    catch (const std::invalid_argument&)
+    {
+        // Numbers that can't be parsed are reported by the interpreter when they are reached
+        return false;
+    }
+}
+
+bool JitCompiler::compile(const Ast& ast, JitProgram& program)
+{
+    if (!isAvailable() || !SemanticAnalyzer::isSafe(ast))
+    {
+        return false;
+    }
+
+    CodeBuffer code;
+    std::vector<std::size_t> functionOffsets(ast.functions.size(), 0);
+    std::vector<std::pair<std::size_t, int>> calls;
+
+    // The statements store the code offsets until the code is copied to executable memory
+    std::vector<std::size_t> statementOffsets;
+
+    program.globals = ast.variables;
+
+    const AstNode& root = ast.nodes[ast.root];
+    for (int i = 0; i < root.childCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+        const AstNode& statementNode = ast.nodes[statement];
+
+        switch (statementNode.type)
+        {
+        case NodeType::operation_assign:
+        case NodeType::operation_print:
+        {
+            int slot = statementNode.type == NodeType::operation_assign ? (int)ast.nodes[ast.getChild(statement, 0)].value : -1;
+
+            statementOffsets.push_back(code.bytes.size());
+            program.statements.push_back(JitStatement(statementNode.type, slot, nullptr));
+
+            emitFunction(ast, ast.getChild(statement, statementNode.childCount - 1), -1, code, calls);
+        }
+        break;
+        case NodeType::operation_read:
+            statementOffsets.push_back(0);
+            program.statements.push_back(JitStatement(statementNode.type, (int)ast.nodes[ast.getChild(statement, 0)].value, nullptr));
+            break;
+        case NodeType::define_function:
+            functionOffsets[statementNode.value] = code.bytes.size();
+            emitFunction(ast, ast.getChild(statement, 1), ast.nodes[ast.getChild(statement, 0)].value, code, calls);
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (const std::pair<std::size_t, int>& call : calls)
+    {
+        std::int32_t relativeOffset = (std::int32_t)(functionOffsets[call.second] - (call.first + 4));
+        for (int i = 0; i < 4; i++)
+        {
+            code.bytes[call.first + i] = (unsigned char)((std::uint32_t)relativeOffset >> (i * 8));
+        }
+    }
+
+    program.code.reset(new ExecutableMemory(code.bytes));
+
+    for (int i = 0; i < program.statements.size(); i++)
+    {
+        if (program.statements[i].type != NodeType::operation_read)
+        {
+            program.statements[i].function = reinterpret_cast<NativeFunction>(program.code->address(statementOffsets[i]));
+        }
+    }
+
+    return true;
+}
+
+void JitCompiler::execute(const JitProgram& program)
+{
+    execute(program, std::cout, std::cin);
+}
+
+void JitCompiler::execute(const JitProgram& program, std::ostream& out, std::istream& in)
+{
+    std::vector<long long> globals(program.globals.size() + 1, 0);
+
+    for (const JitStatement& statement : program.statements)
+    {
+        switch (statement.type)
+        {
+        case NodeType::operation_assign:
+            globals[statement.slot] = statement.function(globals.data(), 0);
+            break;
+        case NodeType::operation_read:
+            globals[statement.slot] = Executor::readNumber(in);
+            break;
+        case NodeType::operation_print:
+            out << statement.function(globals.data(), 0) << '\n';
+            break;
+        default:
+            break;
+        }
+    }
+
+    out.flush();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Node.h"
+#include "Ast.h"
+#include "ExecutableMemory.h"
+#include <iostream>
+#include <memory>
+
+/// @brief Native function compiled from an expression, it receives the global variables and the function parameter
+typedef long long (*NativeFunction)(long long* globals, long long parameter);
+
+/// @brief Statement of a natively compiled program
+class JitStatement
+{
+public:
+    /// @brief The statement type (operation_assign, operation_read or operation_print)
+    NodeType type;
+    /// @brief Slot of the assigned or read variable
+    int slot;
+    /// @brief The native code of the expression (null for read)
+    NativeFunction function;
+    /// @brief Constructor for creating a statement by type, slot and native code
+    /// @param type The statement type
+    /// @param slot The variable slot
+    /// @param function The native code of the expression
+    JitStatement(NodeType type, int slot, NativeFunction function) : type(type), slot(slot), function(function) {}
+};
+
+/// @brief Program whose expressions and function bodies are compiled to x86-64 machine code
+class JitProgram
+{
+public:
+    /// @brief The statements in execution order
+    std::vector<JitStatement> statements;
+    /// @brief Names of the global variables by slot
+    std::vector<std::string> globals;
+    /// @brief The memory with the machine code
+    std::unique_ptr<ExecutableMemory> code;
+};
+
+/// @brief Class with methods that compile an AST to x86-64 machine code and execute it
+class JitCompiler
+{
+public:
+    /// @brief Checks if the JIT can generate code for the current platform
+    /// @return True if the platform is x86-64, otherwise false
+    static bool isAvailable();
+
+    /// @brief Compiles the AST to machine code
+    /// @param treeRoot The root node of the AST
+    /// @param program The compiled program
+    /// @return True if the program was compiled, false if it has to be executed by an interpreter
+    /// (when it can fail with a runtime error or the platform is not x86-64)
+    static bool compile(const Node& treeRoot, JitProgram& program);
+
+    /// @brief Compiles the arena AST to machine code
+    /// @param ast The arena AST
+    /// @param program The compiled program
+    /// @return True if the program was compiled, false if it has to be executed by an interpreter
+    /// (when it can fail with a runtime error or the platform is not x86-64)
+    static bool compile(const Ast& ast, JitProgram& program);
+
+    /// @brief Executes a compiled program using the console output and input streams
+    /// @param program The compiled program
+    static void execute(const JitProgram& program);
+
+    /// @brief Executes a compiled program using the given output and input streams
+    /// @param program The compiled program
+    /// @param out The output stream
+    /// @param in The input stream
+    static void execute(const JitProgram& program, std::ostream& out, std::istream& in);
+};
@@ -13,6 +13,9 @@ public:
     std::string value;
     /// @brief Child nodes
     std::vector<Node>* children;
+    /// @brief Slot of the variable, index of the function or index of the constant divisor of a division,
+    /// set by the Resolver (-1 if not resolved)
+    int slot = -1;
     /// @brief Base constructor with default parameters
     Node() { type = NodeType::undefined; children = new std::vector<Node>(); }
     /// @brief Constructor for creating a node by type 
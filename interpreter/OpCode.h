@@ -0,0 +1,39 @@
+#pragma once
+
+/// @brief Enumeration with the instructions of the bytecode virtual machine
+enum class OpCode
+{
+    /// @brief Pushes the constant with index operand
+    push_constant,
+    /// @brief Pushes the value of the global variable in slot operand
+    load_global,
+    /// @brief Pushes the value of the global variable in slot operand without checking that it is assigned (the program is analyzed)
+    load_defined_global,
+    /// @brief Pushes the parameter of the currently executed function
+    load_parameter,
+    /// @brief Pops a value and stores it in the global variable in slot operand
+    store_global,
+    /// @brief Reads a number from the input and stores it in the global variable in slot operand
+    read_global,
+    /// @brief Pops a value and prints it
+    print,
+    add,
+    subtract,
+    multiply,
+    divide,
+    modulo,
+    /// @brief Divides the top of the stack by the constant divisor with index operand
+    divide_constant,
+    /// @brief Replaces the top of the stack by its remainder of the constant divisor with index operand
+    modulo_constant,
+    /// @brief Marks the function with index operand as defined
+    define_function,
+    /// @brief Pops the argument and calls the function with index operand
+    call,
+    /// @brief Pops the argument and calls the function with index operand without checking that it is defined (the program is analyzed)
+    call_defined,
+    /// @brief Returns from the current function (the result stays on the stack)
+    return_value,
+    /// @brief Stops the execution
+    halt,
+};
@@ -0,0 +1,93 @@
+#include "Optimizer.h"
+#include "Inliner.h"
+#include "ConstantFolder.h"
+#include "DeadCodeEliminator.h"
+#include "CommonSubexpressionEliminator.h"
+#include "IrBuilder.h"
+#include "IrPasses.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+Optimizer::Optimizer()
+    : astPasses([](const Ast& ast) { ast.verify(); }), irPasses([](const IrProgram& program) { program.verify(); })
+{
+    // The calls are expanded first, so the folding sees the arguments in the function bodies.
+    // The sharing makes the AST a DAG, so it runs last (the passes that rewrite the nodes in place unshare it if they run after it)
+    astPasses.addPass("inline", "calls expanded", [](Ast& ast) { return Inliner::inlineCalls(ast); });
+    astPasses.addPass("fold", "nodes eliminated", ConstantFolder::fold);
+    astPasses.addPass("dce", "statements eliminated", DeadCodeEliminator::eliminate);
+    astPasses.addPass("ssa", "instructions eliminated", [this](Ast& ast) { return optimizeIr(ast); });
+    astPasses.addPass("cse", "subexpressions shared", CommonSubexpressionEliminator::eliminate);
+
+    irPasses.addPass("forward", "loads forwarded", IrPasses::forwardStores);
+    irPasses.addPass("ssa-fold", "operations folded", IrPasses::foldConstants);
+    irPasses.addPass("gvn", "values numbered", IrPasses::numberValues);
+    irPasses.addPass("ssa-dce", "values eliminated", IrPasses::eliminateDeadValues);
+}
+
+void Optimizer::setPipeline(const std::vector<std::string>& names)
+{
+    std::vector<std::string> astNames;
+    std::vector<std::string> irNames;
+    for (const std::string& name : names)
+    {
+        if (irPasses.hasPass(name))
+        {
+            irNames.push_back(name);
+        }
+        else
+        {
+            astNames.push_back(name);
+        }
+    }
+
+    // The IR passes run only inside the "ssa" pass, without it they would be skipped silently
+    if (!irNames.empty() && std::find(astNames.begin(), astNames.end(), "ssa") == astNames.end())
+    {
+        throw std::invalid_argument("Optimization pass '" + irNames[0] + "' runs on the SSA IR, the pipeline needs the 'ssa' pass");
+    }
+
+    astPasses.setPipeline(astNames);
+    if (!irNames.empty())
+    {
+        irPasses.setPipeline(irNames);
+    }
+}
+
+void Optimizer::optimize(Ast& ast)
+{
+    astPasses.run(ast);
+}
+
+void Optimizer::printStats(std::ostream& out) const
+{
+    // The IR passes are nested in the "ssa" pass
+    bool isIrPrinted = false;
+    for (const PassResult& result : astPasses.getResults())
+    {
+        out << result.name << ": " << result.changes << " " << result.unit << " (" << result.time << " ms)" << std::endl;
+        if (result.name == "ssa" && !isIrPrinted)
+        {
+            irPasses.printStats(out, "    ");
+            isIrPrinted = true;
+        }
+    }
+}
+
+int Optimizer::optimizeIr(Ast& ast)
+{
+    if (ast.root < 0)
+    {
+        return 0;
+    }
+
+    IrProgram program = IrBuilder::build(ast);
+    int instructionCount = program.getInstructionCount();
+
+    irPasses.run(program);
+
+    ast = IrBuilder::lower(program);
+
+    return instructionCount - program.getInstructionCount();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Ast.h"
+#include "Ir.h"
+#include "PassManager.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// @brief The optimization pipeline of the compiled engines: the AST passes, with the SSA IR passes run as one of them
+class Optimizer
+{
+public:
+    /// @brief Constructor for creating the optimizer with all passes registered in their default order
+    Optimizer();
+
+    Optimizer(const Optimizer&) = delete;
+    Optimizer& operator=(const Optimizer&) = delete;
+
+    /// @brief Sets which passes run and in what order, the AST passes and the IR passes are ordered separately
+    /// (the IR passes run when the "ssa" pass runs, so a list with IR passes must have it)
+    /// @param names The names of the passes in running order
+    /// @throws std::invalid_argument If a pass is unknown or IR passes are given without the "ssa" pass
+    void setPipeline(const std::vector<std::string>& names);
+
+    /// @brief Runs the passes
+    /// @param ast The arena AST
+    void optimize(Ast& ast);
+
+    /// @brief Writes the changes and the time of every pass
+    /// @param out The stream the statistics are written to
+    void printStats(std::ostream& out) const;
+
+private:
+    /// @brief Converts the AST to the IR, runs the IR passes and converts it back
+    /// @param ast The arena AST
+    /// @return The number of eliminated instructions
+    int optimizeIr(Ast& ast);
+
+    /// @brief The passes over the AST
+    PassManager<Ast> astPasses;
+    /// @brief The passes over the IR
+    PassManager<IrProgram> irPasses;
+};
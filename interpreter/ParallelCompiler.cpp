@@ -0,0 +1,272 @@
+#include "ParallelCompiler.h"
+#include "Tokenizer.h"
+#include "Compiler.h"
+#include "Executor.h"
+
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// @brief The chunks of a source text and the errors of their compilation
+    class Chunks
+    {
+    public:
+        /// @brief The offsets of the first characters of the lines of the text
+        std::vector<unsigned int> lineStarts;
+        /// @brief The indexes of the first lines of the chunks, the last one is the number of lines
+        std::vector<int> chunkStarts;
+        /// @brief The errors of the chunks (empty for the compiled chunks)
+        std::vector<std::exception_ptr> errors;
+        /// @brief Flags for the errors found by the syntax check
+        std::vector<char> isSyntaxErrors;
+
+        /// @brief Gets the number of chunks
+        /// @return The number of chunks
+        int size() const { return (int)chunkStarts.size() - 1; }
+    };
+
+    /// @brief Gets the number of threads to use
+    /// @param threadCount The asked number of threads (0 for one per core)
+    /// @return The number of threads
+    int getThreadCount(int threadCount)
+    {
+        if (threadCount > 0)
+        {
+            return threadCount;
+        }
+
+        int cores = (int)std::thread::hardware_concurrency();
+        return cores > 0 ? cores : 1;
+    }
+
+    /// @brief Splits the lines of a source text into chunks
+    /// @param source The source text
+    /// @param threadCount The number of threads
+    /// @param minChunkLines The smallest number of lines in a chunk
+    /// @return The chunks
+    Chunks split(const SourceText& source, int threadCount, int minChunkLines)
+    {
+        Chunks chunks;
+        chunks.lineStarts = source.getLineStarts();
+
+        // There are a few chunks per thread, so a thread that gets the short lines takes another chunk
+        int lineCount = (int)chunks.lineStarts.size();
+        int chunkLines = lineCount / (threadCount * 4) + 1;
+        if (chunkLines < minChunkLines)
+        {
+            chunkLines = minChunkLines;
+        }
+
+        for (int line = 0; line < lineCount; line += chunkLines)
+        {
+            chunks.chunkStarts.push_back(line);
+        }
+        if (chunks.chunkStarts.empty())
+        {
+            chunks.chunkStarts.push_back(0);
+        }
+        chunks.chunkStarts.push_back(lineCount);
+
+        chunks.errors.resize(chunks.size());
+        chunks.isSyntaxErrors.resize(chunks.size(), 0);
+
+        return chunks;
+    }
+
+    /// @brief Tokenizes and compiles every chunk, the threads take the next chunk until all are done
+    /// @param source The source text
+    /// @param chunks The chunks, they get the errors
+    /// @param threadCount The number of threads
+    /// @param compileChunk Function that compiles the tokens of a chunk with the given index
+    template <typename CompileChunk>
+    void compileChunks(const std::shared_ptr<const SourceText>& source, Chunks& chunks, int threadCount, CompileChunk compileChunk)
+    {
+        std::atomic<int> nextChunk(0);
+
+        auto work = [&]()
+        {
+            for (int chunk = nextChunk++; chunk < chunks.size(); chunk = nextChunk++)
+            {
+                TokenBuffer tokens = Tokenizer::tokenizeLines(source, chunks.lineStarts, chunks.chunkStarts[chunk], chunks.chunkStarts[chunk + 1]);
+
+                try
+                {
+                    compileChunk(tokens, chunk);
+                }
+                catch (...)
+                {
+                    chunks.errors[chunk] = std::current_exception();
+
+                    // The whole text is checked before it is built, so the error must be known to be from the check or from the build
+                    try
+                    {
+                        Compiler::checkSyntax(tokens);
+                    }
+                    catch (...)
+                    {
+                        chunks.errors[chunk] = std::current_exception();
+                        chunks.isSyntaxErrors[chunk] = 1;
+                    }
+                }
+            }
+        };
+
+        // The calling thread is one of the threads
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threadCount && i < chunks.size(); i++)
+        {
+            workers.push_back(std::thread(work));
+        }
+        work();
+
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    /// @brief Gets the error that the compilation of the whole text would report
+    /// @param chunks The compiled chunks
+    /// @return The first syntax error, the first build error if there are no syntax errors (empty if there are no errors)
+    std::exception_ptr getFirstError(const Chunks& chunks)
+    {
+        for (int chunk = 0; chunk < chunks.size(); chunk++)
+        {
+            if (chunks.isSyntaxErrors[chunk])
+            {
+                return chunks.errors[chunk];
+            }
+        }
+
+        for (int chunk = 0; chunk < chunks.size(); chunk++)
+        {
+            if (chunks.errors[chunk])
+            {
+                return chunks.errors[chunk];
+            }
+        }
+
+        return nullptr;
+    }
+}
+
+Node ParallelCompiler::compile(std::shared_ptr<const SourceText> source, int threadCount, int minChunkLines)
+{
+    threadCount = getThreadCount(threadCount);
+    Chunks chunks = split(*source, threadCount, minChunkLines);
+
+    std::vector<std::vector<Node>*> chunkStatements(chunks.size(), nullptr);
+    compileChunks(source, chunks, threadCount, [&](const TokenBuffer& tokens, int chunk)
+    {
+        chunkStatements[chunk] = Compiler::compile(tokens).children;
+    });
+
+    std::exception_ptr error = getFirstError(chunks);
+    if (error)
+    {
+        for (std::vector<Node>* statements : chunkStatements)
+        {
+            if (statements != nullptr)
+            {
+                for (Node& statement : *statements)
+                {
+                    Executor::deleteTree(statement);
+                }
+                delete statements;
+            }
+        }
+
+        std::rethrow_exception(error);
+    }
+
+    // The statements of the chunks are moved to one root in the order of the lines
+    Node treeRoot(NodeType::root);
+    for (std::vector<Node>* statements : chunkStatements)
+    {
+        treeRoot.children->insert(treeRoot.children->end(), statements->begin(), statements->end());
+        delete statements;
+    }
+
+    return treeRoot;
+}
+
+Ast ParallelCompiler::compileAst(std::shared_ptr<const SourceText> source, int threadCount, int minChunkLines)
+{
+    threadCount = getThreadCount(threadCount);
+    Chunks chunks = split(*source, threadCount, minChunkLines);
+
+    std::vector<Ast> chunkAsts(chunks.size());
+    compileChunks(source, chunks, threadCount, [&](const TokenBuffer& tokens, int chunk)
+    {
+        chunkAsts[chunk] = Compiler::compileAst(tokens);
+    });
+
+    std::exception_ptr error = getFirstError(chunks);
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    if (chunkAsts.size() == 1)
+    {
+        return std::move(chunkAsts[0]);
+    }
+
+    // The arenas are joined in the order of the lines, the symbol ids are given again in the order the names are first used,
+    // so the AST is the same as the AST of the whole text
+    Ast ast;
+    std::vector<int> statements;
+    for (const Ast& chunkAst : chunkAsts)
+    {
+        std::vector<int> variableIds;
+        for (const std::string& name : chunkAst.variables)
+        {
+            variableIds.push_back(ast.getVariableId(name));
+        }
+
+        std::vector<int> functionIds;
+        for (const std::string& name : chunkAst.functions)
+        {
+            functionIds.push_back(ast.getFunctionId(name));
+        }
+
+        int nodeOffset = (int)ast.nodes.size();
+        int childOffset = (int)ast.childIndices.size();
+
+        // The root is the last node of a chunk and its children are the last child indexes
+        const AstNode& chunkRoot = chunkAst.nodes[chunkAst.root];
+        for (int i = 0; i < chunkAst.root; i++)
+        {
+            AstNode node = chunkAst.nodes[i];
+            node.firstChild += childOffset;
+
+            if (node.type == NodeType::variable)
+            {
+                node.value = variableIds[node.value];
+            }
+            else if (node.type == NodeType::function || node.type == NodeType::define_function)
+            {
+                node.value = functionIds[node.value];
+            }
+
+            ast.nodes.push_back(node);
+        }
+
+        for (int i = 0; i < chunkRoot.firstChild; i++)
+        {
+            ast.childIndices.push_back(chunkAst.childIndices[i] + nodeOffset);
+        }
+
+        for (int i = 0; i < chunkRoot.childCount; i++)
+        {
+            statements.push_back(chunkAst.getChild(chunkAst.root, i) + nodeOffset);
+        }
+    }
+
+    ast.root = ast.addNode(NodeType::root, 0, statements);
+
+    return ast;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Ast.h"
+#include "Node.h"
+#include "SourceText.h"
+#include <memory>
+
+/// @brief Class with methods for tokenizing and compiling a program in chunks of lines on many threads.
+/// Every statement ends at the end of its line, so the chunks are compiled on their own and their statements are joined in order
+class ParallelCompiler
+{
+public:
+    /// @brief Builds an AST from the source text, the syntax errors are the same as for the whole text
+    /// @param source The source text
+    /// @param threadCount The number of threads (0 for one per core)
+    /// @param minChunkLines The smallest number of lines in a chunk, so the small programs are compiled on one thread
+    /// @return The AST root
+    static Node compile(std::shared_ptr<const SourceText> source, int threadCount = 0, int minChunkLines = 4096);
+
+    /// @brief Builds an arena AST from the source text, it is the same as the AST of the whole text
+    /// @param source The source text
+    /// @param threadCount The number of threads (0 for one per core)
+    /// @param minChunkLines The smallest number of lines in a chunk, so the small programs are compiled on one thread
+    /// @return The arena AST
+    static Ast compileAst(std::shared_ptr<const SourceText> source, int threadCount = 0, int minChunkLines = 4096);
+};
@@ -0,0 +1,409 @@
+#include "PartialEvaluator.h"
+
+#include <climits>
+#include <utility>
+
+namespace
+{
+    /// @brief The values known while the program is specialized
+    class StaticState
+    {
+    public:
+        /// @brief The values of the globals
+        std::vector<long long> values;
+        /// @brief Flags showing which globals have a known value
+        std::vector<char> isKnown;
+        /// @brief The first definition of every function executed so far (-1 if the function is not defined yet)
+        std::vector<int> definitions;
+        /// @brief The number of nodes computed for the current statement
+        long long steps = 0;
+        /// @brief The maximum number of nodes computed for one statement
+        long long stepBudget = 0;
+        /// @brief The number of the current statement, the node facts below are valid only for the nodes stamped with it
+        int stamp = 0;
+        /// @brief The statement number the node facts were computed for (indexed by node)
+        std::vector<int> stamps;
+        /// @brief Flags showing which nodes of the current statement have a known value (indexed by node)
+        std::vector<char> isComputed;
+        /// @brief The values of the nodes of the current statement (indexed by node)
+        std::vector<long long> computedValues;
+        /// @brief The residual nodes of the nodes of the current statement (indexed by node, -1 while the node is rebuilt)
+        std::vector<int> residuals;
+    };
+
+    /// @brief The maximum depth of the function calls computed at specialization time
+    const int maxCallDepth = 256;
+
+    /// @brief Computes an arithmetic operation, the arithmetic wraps around like the hardware operations
+    /// @param type The type of the operation
+    /// @param left The value of the left operand
+    /// @param right The value of the right operand
+    /// @param result The value of the operation
+    /// @return False if the operation would trap at runtime (the divisions are left for the runtime), otherwise true
+    bool computeOperation(NodeType type, long long left, long long right, long long& result)
+    {
+        switch (type)
+        {
+        case NodeType::operation_add:
+            result = (long long)((unsigned long long)left + (unsigned long long)right);
+            return true;
+        case NodeType::operation_subtract:
+            result = (long long)((unsigned long long)left - (unsigned long long)right);
+            return true;
+        case NodeType::operation_multipy:
+            result = (long long)((unsigned long long)left * (unsigned long long)right);
+            return true;
+        case NodeType::operation_divide:
+        case NodeType::operation_modulo:
+            if (right == 0 || (right == -1 && left == LLONG_MIN))
+            {
+                return false;
+            }
+            result = type == NodeType::operation_divide ? left / right : left % right;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /// @brief Computes an expression from the known values, the nodes and the function calls are kept on explicit stacks,
+    /// so deep expressions and call chains don't overflow the native stack
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param argument The value of the parameter
+    /// @param depth The depth of the function calls
+    /// @param state The known values
+    /// @param result The value of the expression
+    /// @return False if the expression uses an unknown value, it would fail or it takes too long, otherwise true
+    bool evaluate(const Ast& ast, int expression, long long parameter, long long argument, int depth, StaticState& state, long long& result)
+    {
+        // Every entry holds a node and its stage: 0 - not visited, 1 - the operands are computed, 2 - the called body is computed
+        std::vector<std::pair<int, int>> stack = { { expression, 0 } };
+        // The parameter and the argument of every call in progress
+        std::vector<std::pair<long long, long long>> calls = { { parameter, argument } };
+        std::vector<long long> values;
+
+        while (!stack.empty())
+        {
+            int node = stack.back().first;
+            int stage = stack.back().second;
+            stack.pop_back();
+
+            const AstNode& expressionNode = ast.nodes[node];
+
+            if (stage == 0)
+            {
+                if (++state.steps > state.stepBudget)
+                {
+                    return false;
+                }
+
+                switch (expressionNode.type)
+                {
+                case NodeType::number:
+                    values.push_back(expressionNode.value);
+                    break;
+                case NodeType::variable:
+                    if (expressionNode.value == calls.back().first)
+                    {
+                        values.push_back(calls.back().second);
+                    }
+                    else if (state.isKnown[expressionNode.value])
+                    {
+                        values.push_back(state.values[expressionNode.value]);
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                    break;
+                default:
+                    stack.push_back({ node, 1 });
+                    for (int i = expressionNode.childCount - 1; i >= 0; i--)
+                    {
+                        stack.push_back({ ast.getChild(node, i), 0 });
+                    }
+                    break;
+                }
+            }
+            else if (stage == 1 && expressionNode.type == NodeType::function)
+            {
+                // Only the functions defined by the earlier statements can be called
+                int definition = state.definitions[expressionNode.value];
+                if (definition < 0 || depth + (int)calls.size() > maxCallDepth)
+                {
+                    return false;
+                }
+
+                calls.push_back({ ast.nodes[ast.getChild(definition, 0)].value, values.back() });
+                values.pop_back();
+
+                stack.push_back({ node, 2 });
+                stack.push_back({ ast.getChild(definition, 1), 0 });
+            }
+            else if (stage == 1)
+            {
+                long long right = values.back();
+                values.pop_back();
+
+                if (!computeOperation(expressionNode.type, values.back(), right, values.back()))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                // The value of the body is the value of the call
+                calls.pop_back();
+            }
+        }
+
+        result = values.back();
+        return true;
+    }
+
+    /// @brief Replaces the largest subexpressions that can be computed from the known values by numbers.
+    /// The values are computed bottom-up once per node and the residual expression is built top-down from them, both with explicit stacks
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression (in the main program)
+    /// @param state The known values
+    /// @param computedExpressions The number of replaced expressions
+    /// @return The index of the residual expression
+    int residualize(Ast& ast, int expression, StaticState& state, int& computedExpressions)
+    {
+        state.stamp++;
+        if (state.stamps.size() < ast.nodes.size())
+        {
+            state.stamps.resize(ast.nodes.size(), 0);
+            state.isComputed.resize(ast.nodes.size(), 0);
+            state.computedValues.resize(ast.nodes.size(), 0);
+            state.residuals.resize(ast.nodes.size(), -1);
+        }
+
+        // The values of the nodes, the children are computed before their parents
+        std::vector<std::pair<int, bool>> stack = { { expression, false } };
+        while (!stack.empty())
+        {
+            int node = stack.back().first;
+            bool isVisited = stack.back().second;
+            stack.pop_back();
+
+            const AstNode& expressionNode = ast.nodes[node];
+
+            if (!isVisited)
+            {
+                // A node with more than one parent is computed once
+                if (state.stamps[node] == state.stamp)
+                {
+                    continue;
+                }
+                state.stamps[node] = state.stamp;
+                state.residuals[node] = -1;
+
+                stack.push_back({ node, true });
+                for (int i = expressionNode.childCount - 1; i >= 0; i--)
+                {
+                    stack.push_back({ ast.getChild(node, i), false });
+                }
+                continue;
+            }
+
+            bool isComputed = ++state.steps <= state.stepBudget;
+            long long value = 0;
+
+            switch (expressionNode.type)
+            {
+            case NodeType::number:
+                value = expressionNode.value;
+                break;
+            case NodeType::variable:
+                value = state.values[expressionNode.value];
+                isComputed = isComputed && state.isKnown[expressionNode.value] != 0;
+                break;
+            case NodeType::function:
+            {
+                // Only the functions defined by the earlier statements can be called, the body is computed with the value of the argument
+                int argument = ast.getChild(node, 0);
+                int definition = state.definitions[expressionNode.value];
+                isComputed = isComputed && definition >= 0 && state.isComputed[argument]
+                    && evaluate(ast, ast.getChild(definition, 1), ast.nodes[ast.getChild(definition, 0)].value, state.computedValues[argument], 1, state, value);
+            }
+            break;
+            default:
+            {
+                int left = ast.getChild(node, 0);
+                int right = ast.getChild(node, 1);
+                isComputed = isComputed && state.isComputed[left] && state.isComputed[right]
+                    && computeOperation(expressionNode.type, state.computedValues[left], state.computedValues[right], value);
+            }
+            break;
+            }
+
+            state.isComputed[node] = isComputed;
+            state.computedValues[node] = value;
+        }
+
+        // The residual nodes, the computed subexpressions are replaced without visiting their children
+        stack.push_back({ expression, false });
+        while (!stack.empty())
+        {
+            int node = stack.back().first;
+            bool isVisited = stack.back().second;
+            stack.pop_back();
+
+            if (!isVisited && state.residuals[node] >= 0)
+            {
+                continue;
+            }
+
+            if (state.isComputed[node])
+            {
+                if (ast.nodes[node].type == NodeType::number)
+                {
+                    state.residuals[node] = node;
+                }
+                else
+                {
+                    computedExpressions++;
+                    state.residuals[node] = ast.addNode(NodeType::number, state.computedValues[node]);
+                }
+                continue;
+            }
+
+            // The node is copied, because adding nodes moves the node array
+            AstNode expressionNode = ast.nodes[node];
+
+            if (!isVisited)
+            {
+                stack.push_back({ node, true });
+                for (int i = expressionNode.childCount - 1; i >= 0; i--)
+                {
+                    stack.push_back({ ast.getChild(node, i), false });
+                }
+                continue;
+            }
+
+            std::vector<int> children;
+            bool isChanged = false;
+            for (int i = 0; i < expressionNode.childCount; i++)
+            {
+                int child = ast.getChild(node, i);
+                children.push_back(state.residuals[child]);
+                isChanged = isChanged || children.back() != child;
+            }
+
+            state.residuals[node] = isChanged ? ast.addNode(expressionNode.type, expressionNode.value, children) : node;
+        }
+
+        return state.residuals[expression];
+    }
+}
+
+int PartialEvaluator::specialize(Ast& ast, const std::vector<long long>& knownInputs, long long stepBudget)
+{
+    if (ast.root < 0)
+    {
+        return 0;
+    }
+
+    StaticState state;
+    state.values.assign(ast.variables.size(), 0);
+    state.isKnown.assign(ast.variables.size(), 0);
+    state.definitions.assign(ast.functions.size(), -1);
+    state.stepBudget = stepBudget;
+
+    int statementCount = ast.nodes[ast.root].childCount;
+    std::vector<int> statements(statementCount);
+    for (int i = 0; i < statementCount; i++)
+    {
+        statements[i] = ast.getChild(ast.root, i);
+    }
+
+    std::vector<int> newStatements;
+    int nextInput = 0;
+    int computedExpressions = 0;
+    bool isReachable = true;
+
+    for (int statement : statements)
+    {
+        // The statements after a second definition of a function are never executed, they are kept as they are
+        if (!isReachable)
+        {
+            newStatements.push_back(statement);
+            continue;
+        }
+
+        AstNode statementNode = ast.nodes[statement];
+        state.steps = 0;
+
+        switch (statementNode.type)
+        {
+        case NodeType::operation_read:
+        {
+            int variable = ast.getChild(statement, 0);
+            long long global = ast.nodes[variable].value;
+
+            if (nextInput < (int)knownInputs.size())
+            {
+                // The known input is assigned, so the functions and the residual statements still see it in the global
+                state.values[global] = knownInputs[nextInput++];
+                state.isKnown[global] = 1;
+
+                int number = ast.addNode(NodeType::number, state.values[global]);
+                newStatements.push_back(ast.addNode(NodeType::operation_assign, 0, { variable, number }));
+            }
+            else
+            {
+                state.isKnown[global] = 0;
+                newStatements.push_back(statement);
+            }
+        }
+        break;
+        case NodeType::operation_assign:
+        {
+            int variable = ast.getChild(statement, 0);
+            long long global = ast.nodes[variable].value;
+
+            int expression = residualize(ast, ast.getChild(statement, 1), state, computedExpressions);
+            if (ast.nodes[expression].type == NodeType::number)
+            {
+                state.values[global] = ast.nodes[expression].value;
+                state.isKnown[global] = 1;
+            }
+            else
+            {
+                state.isKnown[global] = 0;
+            }
+
+            newStatements.push_back(ast.addNode(NodeType::operation_assign, 0, { variable, expression }));
+        }
+        break;
+        case NodeType::operation_print:
+        {
+            int expression = residualize(ast, ast.getChild(statement, 0), state, computedExpressions);
+            newStatements.push_back(ast.addNode(NodeType::operation_print, 0, { expression }));
+        }
+        break;
+        case NodeType::define_function:
+            if (state.definitions[statementNode.value] < 0)
+            {
+                state.definitions[statementNode.value] = statement;
+            }
+            else
+            {
+                isReachable = false;
+            }
+            newStatements.push_back(statement);
+            break;
+        default:
+            newStatements.push_back(statement);
+            break;
+        }
+    }
+
+    ast.root = ast.addNode(NodeType::root, 0, newStatements);
+    ast.compact();
+
+    return computedExpressions;
+}
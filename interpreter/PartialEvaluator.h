@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Ast.h"
+#include <vector>
+
+/// @brief Class with methods that specialize a program for known values of its first inputs
+class PartialEvaluator
+{
+public:
+    /// @brief Replaces the first reads with assignments of the known values and computes every expression that depends only on known values,
+    /// the residual program reads the remaining inputs and prints the same output as the original program.
+    /// The expressions that would fail at runtime are left to fail at the same place
+    /// @param ast The arena AST (it is rewritten to the residual program)
+    /// @param knownInputs The values of the first reads in order
+    /// @param stepBudget The maximum number of nodes computed for one statement (function calls can be very deep)
+    /// @return The number of computed expressions
+    static int specialize(Ast& ast, const std::vector<long long>& knownInputs, long long stepBudget = 1000000);
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief The result of one run of an optimization pass
+class PassResult
+{
+public:
+    /// @brief The name of the pass
+    std::string name;
+    /// @brief What the pass counts ("calls expanded", "nodes eliminated")
+    std::string unit;
+    /// @brief The number of changes the pass made
+    int changes;
+    /// @brief The time the pass took in milliseconds (without the verification)
+    double time;
+    /// @brief Constructor for creating a pass result
+    /// @param name The name of the pass
+    /// @param unit What the pass counts
+    /// @param changes The number of changes
+    /// @param time The time in milliseconds
+    PassResult(std::string name, std::string unit, int changes, double time) : name(name), unit(unit), changes(changes), time(time) {}
+};
+
+/// @brief Runs optimization passes over a program in a configurable order, times them and verifies the program between them
+/// @tparam Program The type of the optimized program (the AST or the IR)
+template <typename Program>
+class PassManager
+{
+public:
+    /// @brief A pass, it returns the number of changes it made
+    using Pass = std::function<int(Program&)>;
+    /// @brief A verifier, it throws std::invalid_argument if the program is broken
+    using Verifier = std::function<void(const Program&)>;
+
+    /// @brief Constructor for creating a pass manager
+    /// @param verifier The verifier run before the first pass and after every pass (empty to skip the verification)
+    explicit PassManager(Verifier verifier = Verifier()) : verifier(std::move(verifier)) {}
+
+    /// @brief Registers a pass and adds it at the end of the pipeline
+    /// @param name The unique name of the pass
+    /// @param unit What the pass counts
+    /// @param pass The pass
+    void addPass(const std::string& name, const std::string& unit, Pass pass)
+    {
+        passes.push_back(RegisteredPass{ name, unit, pass });
+        pipeline.push_back((int)passes.size() - 1);
+    }
+
+    /// @brief Checks if a pass is registered
+    /// @param name The name of the pass
+    /// @return True if the pass is registered, otherwise false
+    bool hasPass(const std::string& name) const
+    {
+        return findPass(name) >= 0;
+    }
+
+    /// @brief Sets which passes run and in what order (a pass can run more than once)
+    /// @param names The names of the passes in running order
+    void setPipeline(const std::vector<std::string>& names)
+    {
+        std::vector<int> newPipeline;
+        for (const std::string& name : names)
+        {
+            int pass = findPass(name);
+            if (pass < 0)
+            {
+                throw std::invalid_argument("Unknown optimization pass '" + name + "'");
+            }
+            newPipeline.push_back(pass);
+        }
+        pipeline = newPipeline;
+    }
+
+    /// @brief Runs the passes of the pipeline in order
+    /// @param program The optimized program
+    void run(Program& program)
+    {
+        verify(program, "before the first pass");
+
+        for (int pass : pipeline)
+        {
+            auto passStart = std::chrono::steady_clock::now();
+            int changes = passes[pass].pass(program);
+            auto passEnd = std::chrono::steady_clock::now();
+
+            results.push_back(PassResult(passes[pass].name, passes[pass].unit, changes,
+                std::chrono::duration<double, std::milli>(passEnd - passStart).count()));
+
+            verify(program, "after pass '" + passes[pass].name + "'");
+        }
+    }
+
+    /// @brief Gets the results of the passes run so far
+    /// @return The results in running order
+    const std::vector<PassResult>& getResults() const { return results; }
+
+    /// @brief Writes the changes and the time of every pass run so far
+    /// @param out The stream the statistics are written to
+    /// @param indent The text written before every line
+    void printStats(std::ostream& out, const std::string& indent = "") const
+    {
+        for (const PassResult& result : results)
+        {
+            out << indent << result.name << ": " << result.changes << " " << result.unit << " (" << result.time << " ms)" << std::endl;
+        }
+    }
+
+private:
+    /// @brief A registered pass
+    class RegisteredPass
+    {
+    public:
+        std::string name;
+        std::string unit;
+        Pass pass;
+    };
+
+    /// @brief Finds a registered pass
+    /// @param name The name of the pass
+    /// @return The index of the pass; -1 if it is not registered
+    int findPass(const std::string& name) const
+    {
+        for (int i = 0; i < passes.size(); i++)
+        {
+            if (passes[i].name == name)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /// @brief Runs the verifier
+    /// @param program The verified program
+    /// @param position Description of the position in the pipeline for the error message
+    void verify(const Program& program, const std::string& position) const
+    {
+        if (!verifier)
+        {
+            return;
+        }
+
+        try
+        {
+            verifier(program);
+        }
+        catch (const std::invalid_argument& ex)
+        {
+            throw std::invalid_argument("Verification failed " + position + ": " + ex.what());
+        }
+    }
+
+    /// @brief The registered passes
+    std::vector<RegisteredPass> passes;
+    /// @brief The indexes of the passes in running order
+    std::vector<int> pipeline;
+    /// @brief The verifier
+    Verifier verifier;
+    /// @brief The results of the passes run so far
+    std::vector<PassResult> results;
+};
@@ -0,0 +1,406 @@
+#include "Pipeline.h"
+#include "SpscQueue.h"
+#include "StreamExecutor.h"
+#include "Tokenizer.h"
+#include "Compiler.h"
+#include "Executor.h"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// @brief Lines of the program read by the reader
+    class TextBatch
+    {
+    public:
+        /// @brief The text of the lines, every line after the first line of the program starts with the end of the previous line
+        std::string text;
+        /// @brief The number of the first line
+        int firstLine = 1;
+        /// @brief The number of lines
+        int lineCount = 0;
+        /// @brief True if it is the last batch of the program
+        bool isLast = false;
+    };
+
+    /// @brief Lines of the program tokenized by the tokenizer
+    class TokenBatch
+    {
+    public:
+        /// @brief The tokens with the text of the lines
+        TokenBuffer tokens;
+        /// @brief The number of the first line
+        int firstLine = 1;
+        /// @brief The number of lines
+        int lineCount = 0;
+        /// @brief True if it is the last batch of the program
+        bool isLast = false;
+    };
+
+    /// @brief Lines of the program compiled by the compiler
+    class StatementBatch
+    {
+    public:
+        /// @brief The statements of the lines (owned by the batch until they are executed)
+        std::vector<Node>* statements = nullptr;
+        /// @brief The syntax error after the statements (empty if the lines are valid)
+        std::exception_ptr error;
+        /// @brief The number of lines
+        int lineCount = 0;
+        /// @brief True if it is the last batch of the program
+        bool isLast = false;
+    };
+
+    /// @brief The throughput and the stalls of one stage
+    class StageStats
+    {
+    public:
+        /// @brief The name of the stage
+        const char* name;
+        /// @brief The number of processed lines
+        long long lines = 0;
+        /// @brief The number of times the stage waited for a batch of the previous stage
+        long long inputStalls = 0;
+        /// @brief The number of times the stage waited for space in the queue of the next stage
+        long long outputStalls = 0;
+        /// @brief The time spent waiting on the queues in milliseconds
+        double waitMs = 0;
+        /// @brief The time from the start to the end of the stage in milliseconds
+        double totalMs = 0;
+    };
+
+    /// @brief Gets the milliseconds since a time point
+    /// @param start The time point
+    /// @return The milliseconds
+    double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// @brief Adds a batch to a queue, waits while the queue is full
+    /// @param queue The queue
+    /// @param batch The batch
+    /// @param isStopped Flag that is set when the pipeline stops
+    /// @param stats The stats of the stage that adds the batch
+    /// @return True if the batch is added, false if the pipeline stopped
+    template <typename T>
+    bool push(SpscQueue<T>& queue, T& batch, const std::atomic<bool>& isStopped, StageStats& stats)
+    {
+        if (queue.tryPush(batch))
+        {
+            return true;
+        }
+
+        stats.outputStalls++;
+        auto waitStart = std::chrono::steady_clock::now();
+        while (!queue.tryPush(batch))
+        {
+            if (isStopped.load(std::memory_order_relaxed))
+            {
+                stats.waitMs += millisecondsSince(waitStart);
+                return false;
+            }
+
+            std::this_thread::yield();
+        }
+
+        stats.waitMs += millisecondsSince(waitStart);
+        return true;
+    }
+
+    /// @brief Removes the next batch from a queue, waits while the queue is empty
+    /// @param queue The queue
+    /// @param batch The batch that receives the next batch
+    /// @param isStopped Flag that is set when the pipeline stops
+    /// @param stats The stats of the stage that removes the batch
+    /// @return True if a batch is removed, false if the pipeline stopped
+    template <typename T>
+    bool pop(SpscQueue<T>& queue, T& batch, const std::atomic<bool>& isStopped, StageStats& stats)
+    {
+        if (queue.tryPop(batch))
+        {
+            return true;
+        }
+
+        stats.inputStalls++;
+        auto waitStart = std::chrono::steady_clock::now();
+        while (!queue.tryPop(batch))
+        {
+            if (isStopped.load(std::memory_order_relaxed))
+            {
+                stats.waitMs += millisecondsSince(waitStart);
+                return false;
+            }
+
+            std::this_thread::yield();
+        }
+
+        stats.waitMs += millisecondsSince(waitStart);
+        return true;
+    }
+
+    /// @brief Deletes statements that are not executed
+    /// @param statements The statements
+    void deleteStatements(std::vector<Node>* statements)
+    {
+        for (Node& statement : *statements)
+        {
+            Executor::deleteTree(statement);
+        }
+
+        delete statements;
+    }
+
+    /// @brief Compiles the lines of a batch one at a time, so the lines before a syntax error are executed like in streaming mode
+    /// @param batch The tokenized batch
+    /// @param error The first syntax error (unchanged if the lines are valid)
+    /// @return The statements of the lines before the error
+    std::vector<Node>* compileLines(const TokenBatch& batch, std::exception_ptr& error)
+    {
+        std::vector<Node>* statements = new std::vector<Node>();
+
+        const char* text = batch.tokens.source->data();
+        std::size_t textLength = batch.tokens.source->size();
+        std::size_t start = batch.firstLine == 1 ? 0 : 1;
+        for (int i = 0; i < batch.lineCount; i++)
+        {
+            std::size_t end = start;
+            while (end < textLength && text[end] != '\n')
+            {
+                end++;
+            }
+
+            try
+            {
+                Node statementRoot = StreamExecutor::compileLine(std::string(text + start, end - start), batch.firstLine + i);
+                statements->insert(statements->end(), statementRoot.children->begin(), statementRoot.children->end());
+                delete statementRoot.children;
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+                break;
+            }
+
+            start = end + 1;
+        }
+
+        return statements;
+    }
+
+    /// @brief Reads the lines of the program into batches
+    /// @param program The stream with the program
+    /// @param texts The queue of the tokenizer
+    /// @param batchLines The number of lines in a batch
+    /// @param isStopped Flag that is set when the pipeline stops
+    /// @param stats The stats of the reader
+    void readBatches(std::istream& program, SpscQueue<TextBatch>& texts, int batchLines, const std::atomic<bool>& isStopped, StageStats& stats)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        int lineNumber = 1;
+        std::string line;
+        bool isLast = false;
+        while (!isLast)
+        {
+            TextBatch batch;
+            batch.firstLine = lineNumber;
+            while (batch.lineCount < batchLines)
+            {
+                if (!std::getline(program, line))
+                {
+                    isLast = true;
+                    break;
+                }
+
+                // The end of the previous line is tokenized with the line, so the first token is checked like in the whole program
+                if (lineNumber != 1)
+                {
+                    batch.text += '\n';
+                }
+                batch.text += line;
+
+                batch.lineCount++;
+                lineNumber++;
+            }
+            batch.isLast = isLast;
+
+            stats.lines += batch.lineCount;
+            if (!push(texts, batch, isStopped, stats))
+            {
+                break;
+            }
+        }
+
+        stats.totalMs = millisecondsSince(start);
+    }
+
+    /// @brief Tokenizes the batches of the reader
+    /// @param texts The queue of the tokenizer
+    /// @param tokenBatches The queue of the compiler
+    /// @param isStopped Flag that is set when the pipeline stops
+    /// @param stats The stats of the tokenizer
+    void tokenizeBatches(SpscQueue<TextBatch>& texts, SpscQueue<TokenBatch>& tokenBatches, const std::atomic<bool>& isStopped, StageStats& stats)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        TextBatch text;
+        do
+        {
+            if (!pop(texts, text, isStopped, stats))
+            {
+                break;
+            }
+
+            TokenBatch batch;
+            batch.tokens = Tokenizer::tokenizeBuffer(std::make_shared<const SourceText>(std::move(text.text)));
+            batch.tokens.firstLine = text.firstLine == 1 ? 1 : text.firstLine - 1;
+            batch.firstLine = text.firstLine;
+            batch.lineCount = text.lineCount;
+            batch.isLast = text.isLast;
+
+            stats.lines += batch.lineCount;
+            if (!push(tokenBatches, batch, isStopped, stats))
+            {
+                break;
+            }
+        } while (!text.isLast);
+
+        stats.totalMs = millisecondsSince(start);
+    }
+
+    /// @brief Compiles the batches of the tokenizer
+    /// @param tokenBatches The queue of the compiler
+    /// @param statementBatches The queue of the executor
+    /// @param isStopped Flag that is set when the pipeline stops
+    /// @param stats The stats of the compiler
+    void compileBatches(SpscQueue<TokenBatch>& tokenBatches, SpscQueue<StatementBatch>& statementBatches, const std::atomic<bool>& isStopped, StageStats& stats)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        TokenBatch tokens;
+        do
+        {
+            if (!pop(tokenBatches, tokens, isStopped, stats))
+            {
+                break;
+            }
+
+            StatementBatch batch;
+            try
+            {
+                batch.statements = Compiler::compile(tokens.tokens).children;
+            }
+            catch (...)
+            {
+                // The error of the batch may be on a later line than the first error of streaming mode
+                batch.statements = compileLines(tokens, batch.error);
+            }
+            batch.lineCount = tokens.lineCount;
+            batch.isLast = tokens.isLast;
+
+            stats.lines += batch.lineCount;
+            if (!push(statementBatches, batch, isStopped, stats))
+            {
+                deleteStatements(batch.statements);
+                break;
+            }
+        } while (!tokens.isLast);
+
+        stats.totalMs = millisecondsSince(start);
+    }
+
+    /// @brief Writes the stats of a stage
+    /// @param stats The stats
+    /// @param out The output stream
+    void printStats(const StageStats& stats, std::ostream& out)
+    {
+        double busyMs = stats.totalMs - stats.waitMs;
+        out << "pipeline " << stats.name << ": " << stats.lines << " lines, " << busyMs << " ms busy, "
+            << (busyMs > 0 ? (long long)(stats.lines * 1000 / busyMs) : 0) << " lines/s, "
+            << stats.inputStalls << " input stalls, " << stats.outputStalls << " output stalls, "
+            << stats.waitMs << " ms waiting" << std::endl;
+    }
+}
+
+int Pipeline::execute(std::istream& program, std::ostream& out, std::istream& in, std::ostream* stats, int batchLines, int queueCapacity)
+{
+    SpscQueue<TextBatch> texts(queueCapacity);
+    SpscQueue<TokenBatch> tokenBatches(queueCapacity);
+    SpscQueue<StatementBatch> statementBatches(queueCapacity);
+    std::atomic<bool> isStopped(false);
+
+    StageStats readerStats;
+    readerStats.name = "reader";
+    StageStats tokenizerStats;
+    tokenizerStats.name = "tokenizer";
+    StageStats compilerStats;
+    compilerStats.name = "compiler";
+    StageStats executorStats;
+    executorStats.name = "executor";
+
+    std::thread reader([&]() { readBatches(program, texts, batchLines, isStopped, readerStats); });
+    std::thread tokenizer([&]() { tokenizeBatches(texts, tokenBatches, isStopped, tokenizerStats); });
+    std::thread compiler([&]() { compileBatches(tokenBatches, statementBatches, isStopped, compilerStats); });
+
+    // The executor runs on the calling thread, so the output and the input are used by one thread
+    auto start = std::chrono::steady_clock::now();
+    try
+    {
+        StreamExecutor executor(out, in);
+
+        StatementBatch batch;
+        do
+        {
+            pop(statementBatches, batch, isStopped, executorStats);
+
+            std::vector<Node>* statements = batch.statements;
+            batch.statements = nullptr;
+            executor.executeStatements(statements);
+
+            if (batch.error)
+            {
+                std::rethrow_exception(batch.error);
+            }
+
+            executorStats.lines += batch.lineCount;
+        } while (!batch.isLast);
+    }
+    catch (...)
+    {
+        // The other stages are stopped and the statements that are not executed are deleted
+        isStopped.store(true);
+        reader.join();
+        tokenizer.join();
+        compiler.join();
+
+        StatementBatch batch;
+        while (statementBatches.tryPop(batch))
+        {
+            deleteStatements(batch.statements);
+        }
+
+        throw;
+    }
+    executorStats.totalMs = millisecondsSince(start);
+
+    reader.join();
+    tokenizer.join();
+    compiler.join();
+
+    if (stats != nullptr)
+    {
+        printStats(readerStats, *stats);
+        printStats(tokenizerStats, *stats);
+        printStats(compilerStats, *stats);
+        printStats(executorStats, *stats);
+    }
+
+    return (int)executorStats.lines;
+}
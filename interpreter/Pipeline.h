@@ -0,0 +1,19 @@
+#pragma once
+
+#include <iostream>
+
+/// @brief Class that executes a program stream with the reader, the tokenizer, the compiler and the executor on separate threads.
+/// The stages pass batches of lines through bounded lock-free queues and the program is executed like in streaming mode
+class Pipeline
+{
+public:
+    /// @brief Executes every line of a program stream, the syntax errors are reported when their line is reached
+    /// @param program The stream with the program
+    /// @param out The output stream
+    /// @param in The input stream
+    /// @param stats The stream for the throughput and the stalls of the stages (nullptr if they aren't written)
+    /// @param batchLines The number of lines in a batch
+    /// @param queueCapacity The number of batches that fit between two stages
+    /// @return The number of executed lines
+    static int execute(std::istream& program, std::ostream& out, std::istream& in, std::ostream* stats, int batchLines = 256, int queueCapacity = 16);
+};
@@ -1,10 +1,14 @@
 #include "Reader.h"
 
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
 std::vector<std::string> Reader::readAllLines(std::string filePath)
 {
 	std::ifstream programFile(filePath);
 	if (!programFile.is_open())
-		throw std::exception("Couldn't open file for reading");
+		throw std::runtime_error("Couldn't open file for reading");
 
 	std::vector<std::string> lines = readAllLines(programFile);
 
@@ -13,6 +17,36 @@ std::vector<std::string> Reader::readAllLines(std::string filePath)
 	return lines;
 }
 
+std::string Reader::readAllText(const std::string& filePath)
+{
+	std::ifstream programFile(filePath);
+	if (!programFile.is_open())
+		throw std::runtime_error("Couldn't open file for reading");
+
+	// The file is opened in text mode like for reading lines, so the line endings are the same
+	std::string text((std::istreambuf_iterator<char>(programFile)), std::istreambuf_iterator<char>());
+
+	programFile.close();
+
+	return text;
+}
+
+std::shared_ptr<const SourceText> Reader::readSource(const std::string& filePath)
+{
+	if (filePath == "-")
+	{
+		return std::make_shared<const SourceText>(std::string((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>()));
+	}
+
+	std::shared_ptr<SourceText> source = std::make_shared<SourceText>();
+	if (SourceText::map(filePath, *source))
+	{
+		return source;
+	}
+
+	return std::make_shared<const SourceText>(readAllText(filePath));
+}
+
 std::vector<std::string> Reader::readAllLines(std::istream& in)
 {
 	std::vector<std::string> lines;
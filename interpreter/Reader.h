@@ -3,6 +3,9 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <memory>
+
+#include "SourceText.h"
 
 /// @brief Reader class with methods for reading from files and streams
 class Reader
@@ -13,6 +16,17 @@ public:
 	/// @return A vector with strings of the lines in the file
 	static std::vector<std::string> readAllLines(std::string filePath);
 
+	/// @brief Reads the whole file into one string, so it can be tokenized without splitting it into lines first
+	/// @param filePath The path of the file
+	/// @return A string with the text of the file
+	static std::string readAllText(const std::string& filePath);
+
+	/// @brief Loads the whole file as one block without copying it: regular files are mapped read-only,
+	/// pipes and devices are read as streams, and the path "-" reads the standard input
+	/// @param filePath The path of the file
+	/// @return The source text
+	static std::shared_ptr<const SourceText> readSource(const std::string& filePath);
+
 private:
 	/// @brief Reads all lines from a stream
 	/// @param in The input stream
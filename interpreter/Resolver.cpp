@@ -0,0 +1,110 @@
+#include "Resolver.h"
+#include "Executor.h"
+
+#include <stdexcept>
+#include <unordered_map>
+
+SymbolTable Resolver::resolve(Node& treeRoot)
+{
+    SymbolTable symbols;
+
+    std::unordered_map<std::string, int> globals;
+    std::unordered_map<std::string, int> functions;
+
+    auto getFunctionIndex = [&symbols, &functions](const std::string& name) -> int
+    {
+        auto index = functions.find(name);
+        if (index != functions.end())
+        {
+            return index->second;
+        }
+
+        symbols.functions.push_back(name);
+        functions.insert(std::pair<std::string, int>(name, (int)symbols.functions.size() - 1));
+
+        return (int)symbols.functions.size() - 1;
+    };
+
+    // The parameter slots come after the globals, so they get their slots when all globals are known
+    std::vector<std::pair<Node*, int>> parameterNodes;
+
+    for (Node& statement : *treeRoot.children)
+    {
+        std::string parameter;
+        int functionIndex = -1;
+
+        if (statement.type == NodeType::define_function)
+        {
+            functionIndex = getFunctionIndex(statement.value);
+            parameter = (*statement.children)[0].value;
+
+            statement.slot = functionIndex;
+        }
+
+        // Resolve the nodes of the statement with an iterative dfs
+        std::vector<Node*> nodes{ &statement };
+        while (!nodes.empty())
+        {
+            Node* currNode = nodes.back();
+            nodes.pop_back();
+
+            if (currNode->type == NodeType::variable)
+            {
+                if (functionIndex >= 0 && currNode->value == parameter)
+                {
+                    parameterNodes.push_back(std::pair<Node*, int>(currNode, functionIndex));
+                }
+                else
+                {
+                    auto slot = globals.find(currNode->value);
+                    if (slot == globals.end())
+                    {
+                        symbols.variables.push_back(currNode->value);
+                        slot = globals.insert(std::pair<std::string, int>(currNode->value, (int)symbols.variables.size() - 1)).first;
+                    }
+                    currNode->slot = slot->second;
+                }
+            }
+            else if (currNode->type == NodeType::function)
+            {
+                currNode->slot = getFunctionIndex(currNode->value);
+            }
+            else if ((currNode->type == NodeType::operation_divide || currNode->type == NodeType::operation_modulo)
+                && (*currNode->children)[1].type == NodeType::number)
+            {
+                // Invalid numbers are not resolved, they are reported by the executor when they are reached
+                try
+                {
+                    long long divisor = Executor::parseNumber((*currNode->children)[1].value);
+                    if (DivisionByConstant::isReducible(divisor))
+                    {
+                        symbols.divisors.push_back(DivisionByConstant(divisor));
+                        currNode->slot = (int)symbols.divisors.size() - 1;
+                    }
+                }
+                catch (const std::invalid_argument&)
+                {
+                }
+            }
+
+            for (Node& child : *currNode->children)
+            {
+                nodes.push_back(&child);
+            }
+        }
+    }
+
+    symbols.globalCount = (int)symbols.variables.size();
+    for (const std::string& function : symbols.functions)
+    {
+        symbols.variables.push_back(function + "[]");
+    }
+
+    for (const std::pair<Node*, int>& parameterNode : parameterNodes)
+    {
+        parameterNode.first->slot = symbols.getParameterSlot(parameterNode.second);
+        symbols.variables[parameterNode.first->slot] = parameterNode.first->value;
+    }
+
+    return symbols;
+}
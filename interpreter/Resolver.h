@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Node.h"
+#include "SymbolTable.h"
+
+/// @brief Class with methods that resolve the names in an AST to integer slots
+class Resolver
+{
+public:
+    /// @brief Interns every identifier in the AST and sets the slot of every variable and function node
+    /// (the globals get dense slots, every function parameter gets the slot after the globals given by its function index).
+    /// The divisions and modulos by a constant get the index of their precomputed divisor
+    /// @param treeRoot The root node of the AST
+    /// @return The symbol table with the names of the slots
+    static SymbolTable resolve(Node& treeRoot);
+};
@@ -0,0 +1,367 @@
+#include "SemanticAnalyzer.h"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace
+{
+    /// @brief The position after every statement, used for the symbols that are never defined
+    const int never = INT_MAX;
+
+    /// @brief The kinds of errors that make a call fail
+    enum class CauseKind
+    {
+        undefined_function,
+        undefined_variable,
+        recursion,
+    };
+
+    /// @brief The error of a call of a function that is called too early
+    class Cause
+    {
+    public:
+        /// @brief The kind of the error
+        CauseKind kind;
+        /// @brief The symbol id of the undefined function or variable, or of the function that is called again
+        int symbol;
+        /// @brief The symbol id of the function that calls it again (-1 if the error isn't a recursion)
+        int caller;
+    };
+
+    /// @brief The symbol tables and the call graph of a program
+    class Symbols
+    {
+    public:
+        /// @brief The position of the first definition of every function (never if it is not defined)
+        std::vector<int> definitions;
+        /// @brief The position of the first assignment or read of every global (never if it is not assigned)
+        std::vector<int> assignments;
+        /// @brief The functions called by the body of every function (the edges of the call graph)
+        std::vector<std::vector<int>> callees;
+        /// @brief The globals used by the body of every function
+        std::vector<std::vector<int>> globals;
+        /// @brief The first position where every function can be called (never if it can't be called)
+        std::vector<int> ready;
+        /// @brief The error of every function if it is called before it is ready
+        std::vector<Cause> causes;
+    };
+
+    /// @brief Collects the nodes of an expression in post order, a node shared by its parents is collected once
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param stamp The number of the walk
+    /// @param stamps The number of the last walk that collected every node
+    /// @param postOrder The vector that gets the nodes
+    void walk(const Ast& ast, int expression, int stamp, std::vector<int>& stamps, std::vector<int>& postOrder)
+    {
+        postOrder.clear();
+
+        // The flag shows whether the children of the node are already added
+        std::vector<std::pair<int, bool>> walkStack{ std::pair<int, bool>(expression, false) };
+        while (!walkStack.empty())
+        {
+            int node = walkStack.back().first;
+            bool childrenAdded = walkStack.back().second;
+            walkStack.pop_back();
+
+            if (childrenAdded)
+            {
+                postOrder.push_back(node);
+                continue;
+            }
+
+            if (stamps[node] == stamp)
+            {
+                continue;
+            }
+            stamps[node] = stamp;
+
+            walkStack.push_back(std::pair<int, bool>(node, true));
+            for (int i = ast.nodes[node].childCount - 1; i >= 0; i--)
+            {
+                walkStack.push_back(std::pair<int, bool>(ast.getChild(node, i), false));
+            }
+        }
+    }
+
+    /// @brief Builds the symbol tables and the call graph in one pass over the statements and the function bodies
+    /// @param ast The arena AST
+    /// @param stamps The number of the last walk that collected every node
+    /// @return The symbols
+    Symbols collectSymbols(const Ast& ast, std::vector<int>& stamps)
+    {
+        Symbols symbols;
+        symbols.definitions.assign(ast.functions.size(), never);
+        symbols.assignments.assign(ast.variables.size(), never);
+        symbols.callees.resize(ast.functions.size());
+        symbols.globals.resize(ast.functions.size());
+
+        std::vector<int> postOrder;
+        const AstNode& root = ast.nodes[ast.root];
+        for (int position = 0; position < root.childCount; position++)
+        {
+            int statement = ast.getChild(ast.root, position);
+            const AstNode& statementNode = ast.nodes[statement];
+
+            switch (statementNode.type)
+            {
+            case NodeType::operation_assign:
+            case NodeType::operation_read:
+            {
+                int& assignment = symbols.assignments[ast.nodes[ast.getChild(statement, 0)].value];
+                if (assignment == never)
+                {
+                    assignment = position;
+                }
+            }
+            break;
+            case NodeType::define_function:
+            {
+                // Only the first definition can be called, the other ones fail when they are executed
+                int function = (int)statementNode.value;
+                if (symbols.definitions[function] != never)
+                {
+                    break;
+                }
+                symbols.definitions[function] = position;
+
+                long long parameter = ast.nodes[ast.getChild(statement, 0)].value;
+                walk(ast, ast.getChild(statement, 1), -2 - position, stamps, postOrder);
+                for (int node : postOrder)
+                {
+                    if (ast.nodes[node].type == NodeType::variable && ast.nodes[node].value != parameter)
+                    {
+                        symbols.globals[function].push_back((int)ast.nodes[node].value);
+                    }
+                    else if (ast.nodes[node].type == NodeType::function)
+                    {
+                        symbols.callees[function].push_back((int)ast.nodes[node].value);
+                    }
+                }
+            }
+            break;
+            default:
+                break;
+            }
+        }
+
+        return symbols;
+    }
+
+    /// @brief Starts the computation of the first position where a function can be called, from its definition and the globals it uses
+    /// @param symbols The symbols
+    /// @param function The function symbol id
+    void startReady(Symbols& symbols, int function)
+    {
+        symbols.ready[function] = symbols.definitions[function];
+
+        for (int global : symbols.globals[function])
+        {
+            if (symbols.assignments[global] > symbols.ready[function])
+            {
+                symbols.ready[function] = symbols.assignments[global];
+                symbols.causes[function] = Cause{ CauseKind::undefined_variable, global, -1 };
+            }
+        }
+    }
+
+    /// @brief Adds a called function to the first position where a function can be called
+    /// @param symbols The symbols
+    /// @param function The function symbol id
+    /// @param callee The symbol id of the called function
+    void addCallee(Symbols& symbols, int function, int callee)
+    {
+        if (symbols.ready[callee] > symbols.ready[function])
+        {
+            symbols.ready[function] = symbols.ready[callee];
+            symbols.causes[function] = symbols.causes[callee];
+        }
+    }
+
+    /// @brief Computes the first position where every function can be called with an iterative dfs of the call graph,
+    /// a call of a function that is still on the stack is a recursion
+    /// @param symbols The symbols
+    void computeReady(Symbols& symbols)
+    {
+        int functionCount = (int)symbols.definitions.size();
+        symbols.ready.assign(functionCount, never);
+        for (int function = 0; function < functionCount; function++)
+        {
+            symbols.causes.push_back(Cause{ CauseKind::undefined_function, function, -1 });
+        }
+
+        // State of every function (0 - not visited, 1 - on the stack, 2 - done)
+        std::vector<char> states(functionCount, 0);
+        // The functions on the stack with the number of their visited callees
+        std::vector<std::pair<int, int>> dfsStack;
+
+        // The dfs starts from the functions in the order of their definitions, so a recursion is found
+        // from the same function as in the executor (the symbol ids depend on the order of the first uses)
+        std::vector<int> starts;
+        for (int function = 0; function < functionCount; function++)
+        {
+            // The functions that are never defined can't be called, they keep their error
+            if (symbols.definitions[function] != never)
+            {
+                starts.push_back(function);
+            }
+        }
+        std::sort(starts.begin(), starts.end(), [&symbols](int first, int second)
+        {
+            return symbols.definitions[first] < symbols.definitions[second];
+        });
+
+        for (int start : starts)
+        {
+            if (states[start] != 0)
+            {
+                continue;
+            }
+
+            states[start] = 1;
+            startReady(symbols, start);
+            dfsStack.push_back(std::pair<int, int>(start, 0));
+
+            while (!dfsStack.empty())
+            {
+                int function = dfsStack.back().first;
+                if (dfsStack.back().second < (int)symbols.callees[function].size())
+                {
+                    int callee = symbols.callees[function][dfsStack.back().second++];
+
+                    if (states[callee] == 1)
+                    {
+                        symbols.ready[function] = never;
+                        symbols.causes[function] = Cause{ CauseKind::recursion, callee, function };
+                    }
+                    else if (states[callee] == 0 && symbols.definitions[callee] != never)
+                    {
+                        states[callee] = 1;
+                        startReady(symbols, callee);
+                        dfsStack.push_back(std::pair<int, int>(callee, 0));
+                    }
+                    else
+                    {
+                        addCallee(symbols, function, callee);
+                    }
+                    continue;
+                }
+
+                states[function] = 2;
+                dfsStack.pop_back();
+
+                if (!dfsStack.empty())
+                {
+                    addCallee(symbols, dfsStack.back().first, function);
+                }
+            }
+        }
+    }
+
+    /// @brief Gets the message of an error, the messages are the same as the ones of the engines
+    /// @param ast The arena AST
+    /// @param cause The error
+    /// @return The message
+    std::string getMessage(const Ast& ast, const Cause& cause)
+    {
+        switch (cause.kind)
+        {
+        case CauseKind::undefined_function:
+            return "Function " + ast.functions[cause.symbol] + " is not defined!";
+        case CauseKind::undefined_variable:
+            return "Use of undefined variable '" + ast.variables[cause.symbol] + "'";
+        default:
+            return "Recursion is not supported! Function '" + ast.functions[cause.symbol] + "' is called again from '" + ast.functions[cause.caller] + "'";
+        }
+    }
+}
+
+std::vector<std::string> SemanticAnalyzer::analyze(const Ast& ast)
+{
+    std::vector<std::string> messages;
+    if (ast.root < 0)
+    {
+        return messages;
+    }
+
+    std::vector<int> stamps(ast.nodes.size(), -1);
+    Symbols symbols = collectSymbols(ast, stamps);
+    computeReady(symbols);
+
+    // A statement can use a global or call a function only if it is ready before the statement
+    std::unordered_set<std::string> reported;
+    auto report = [&](const std::string& message)
+    {
+        if (reported.insert(message).second)
+        {
+            messages.push_back(message);
+        }
+    };
+
+    std::vector<int> postOrder;
+    const AstNode& root = ast.nodes[ast.root];
+    for (int position = 0; position < root.childCount; position++)
+    {
+        int statement = ast.getChild(ast.root, position);
+        const AstNode& statementNode = ast.nodes[statement];
+
+        switch (statementNode.type)
+        {
+        case NodeType::operation_assign:
+        case NodeType::operation_print:
+            // The nodes are checked in the order they are computed
+            walk(ast, ast.getChild(statement, statementNode.childCount - 1), position, stamps, postOrder);
+            for (int node : postOrder)
+            {
+                const AstNode& currNode = ast.nodes[node];
+                if (currNode.type == NodeType::variable && symbols.assignments[currNode.value] >= position)
+                {
+                    report("Use of undefined variable '" + ast.variables[currNode.value] + "'");
+                }
+                else if (currNode.type == NodeType::function && symbols.ready[currNode.value] >= position)
+                {
+                    report(getMessage(ast, symbols.causes[currNode.value]));
+                }
+            }
+            break;
+        case NodeType::define_function:
+        {
+            int function = (int)statementNode.value;
+            // The calls in the body fail only when the function is called, so they are checked at the calls
+            if (symbols.definitions[function] != position)
+            {
+                report("Function " + ast.functions[function] + " already defined!");
+            }
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    return messages;
+}
+
+void SemanticAnalyzer::check(const Ast& ast)
+{
+    std::vector<std::string> messages = analyze(ast);
+    if (messages.empty())
+    {
+        return;
+    }
+
+    std::string errors = messages[0];
+    for (int i = 1; i < messages.size(); i++)
+    {
+        errors += "\n" + messages[i];
+    }
+
+    throw std::invalid_argument(errors);
+}
+
+bool SemanticAnalyzer::isSafe(const Ast& ast)
+{
+    return analyze(ast).empty();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Ast.h"
+#include <string>
+#include <vector>
+
+/// @brief Class with methods that check the symbols of a program before it is executed.
+/// The program has no branches, so a call or a use of a global fails at runtime exactly when the analysis finds it
+class SemanticAnalyzer
+{
+public:
+    /// @brief Finds the uses of undefined globals, the calls of functions that aren't defined yet (also through the functions they call),
+    /// the functions defined twice and the recursion through other functions (the calls in a function that is never called aren't errors). The call graph and the symbol tables are built in linear time
+    /// @param ast The arena AST
+    /// @return The messages of the errors in the order of the statements (every message is given once)
+    static std::vector<std::string> analyze(const Ast& ast);
+
+    /// @brief Checks the program before it is executed
+    /// @param ast The arena AST
+    /// @throws std::invalid_argument With every error on its own line if the program has errors
+    static void check(const Ast& ast);
+
+    /// @brief Checks if the program can run without any of the runtime errors of the symbols,
+    /// so the engines can execute it without checking the definitions
+    /// @param ast The arena AST
+    /// @return True if the analysis finds no errors, otherwise false
+    static bool isSafe(const Ast& ast);
+};
@@ -0,0 +1,122 @@
+#include "SourceText.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceText::~SourceText()
+{
+    if (mapping == nullptr)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+#else
+    munmap(mapping, mappingSize);
+#endif
+}
+
+bool SourceText::map(const std::string& filePath, SourceText& source)
+{
+    // Pipes, devices and empty files can't be mapped, they are read as streams
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 || fileSize.QuadPart >= 0xFFFFFFFFLL)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (fileMapping == nullptr)
+    {
+        return false;
+    }
+
+    // The view keeps the file open, so the handles are closed at once
+    void* view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(fileMapping);
+    if (view == nullptr)
+    {
+        return false;
+    }
+
+    // The streams read in text mode turn "\r\n" into '\n', so the files with '\r' are read as streams to get the same lines
+    if (std::memchr(view, '\r', (std::size_t)fileSize.QuadPart) != nullptr)
+    {
+        UnmapViewOfFile(view);
+        return false;
+    }
+
+    source.mapping = view;
+    source.mappingSize = (std::size_t)fileSize.QuadPart;
+#else
+    int file = open(filePath.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode) || fileStatus.st_size == 0 || fileStatus.st_size >= 0xFFFFFFFFLL)
+    {
+        close(file);
+        return false;
+    }
+
+    // The mapping keeps the file open, so the descriptor is closed at once
+    void* view = mmap(nullptr, (std::size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    madvise(view, (std::size_t)fileStatus.st_size, MADV_SEQUENTIAL);
+
+    source.mapping = view;
+    source.mappingSize = (std::size_t)fileStatus.st_size;
+#endif
+
+    return true;
+}
+
+std::vector<unsigned int> SourceText::getLineStarts() const
+{
+    std::vector<unsigned int> lineStarts;
+
+    const char* text = data();
+    std::size_t length = size();
+
+    std::size_t lineStart = 0;
+    while (lineStart < length)
+    {
+        lineStarts.push_back((unsigned int)lineStart);
+
+        const char* lineEnd = (const char*)std::memchr(text + lineStart, '\n', length - lineStart);
+        if (lineEnd == nullptr)
+        {
+            break;
+        }
+
+        lineStart = lineEnd - text + 1;
+    }
+
+    return lineStarts;
+}
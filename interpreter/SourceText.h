@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief The text of a program as one contiguous block, either a read-only mapping of the file or a string
+class SourceText
+{
+public:
+    /// @brief Constructor for creating an empty text
+    SourceText() : mapping(nullptr), mappingSize(0) {}
+    /// @brief Constructor for creating a text that owns a string
+    /// @param text The text
+    explicit SourceText(std::string text) : text(std::move(text)), mapping(nullptr), mappingSize(0) {}
+    /// @brief Destructor that releases the mapping
+    ~SourceText();
+
+    SourceText(const SourceText&) = delete;
+    SourceText& operator=(const SourceText&) = delete;
+
+    /// @brief Maps a file read-only, only regular files that are not empty are mapped
+    /// @param filePath The path of the file
+    /// @param source The text that gets the mapping
+    /// @return True if the file is mapped, false if it has to be read as a stream
+    static bool map(const std::string& filePath, SourceText& source);
+
+    /// @brief Gets the first character of the text
+    /// @return Pointer to the first character
+    const char* data() const { return mapping != nullptr ? (const char*)mapping : text.data(); }
+
+    /// @brief Gets the number of characters in the text
+    /// @return The number of characters
+    std::size_t size() const { return mapping != nullptr ? mappingSize : text.size(); }
+
+    /// @brief Checks if the text is a mapping of a file
+    /// @return True if the text is mapped
+    bool isMapped() const { return mapping != nullptr; }
+
+    /// @brief Finds the lines of the text, they are separated by '\n' (a '\n' at the end doesn't start a new line)
+    /// @return The offsets of the first characters of the lines
+    std::vector<unsigned int> getLineStarts() const;
+
+private:
+    /// @brief The text when it is not mapped
+    std::string text;
+    /// @brief The mapped view of the file
+    void* mapping;
+    /// @brief The size of the mapped view
+    std::size_t mappingSize;
+};
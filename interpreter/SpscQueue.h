@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+/// @brief Bounded lock-free queue with one producer thread and one consumer thread
+/// @tparam T The type of the items
+template <typename T>
+class SpscQueue
+{
+public:
+    /// @brief Constructor for creating an empty queue
+    /// @param capacity The maximum number of items in the queue
+    SpscQueue(int capacity) : items(capacity + 1), head(0), tail(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /// @brief Moves an item to the end of the queue, called only by the producer
+    /// @param item The item, it is moved only if there is space
+    /// @return True if the item is added, false if the queue is full
+    bool tryPush(T& item)
+    {
+        int currentTail = tail.load(std::memory_order_relaxed);
+        int nextTail = next(currentTail);
+        if (nextTail == head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        items[currentTail] = std::move(item);
+        tail.store(nextTail, std::memory_order_release);
+
+        return true;
+    }
+
+    /// @brief Moves the item at the front of the queue out of it, called only by the consumer
+    /// @param item The item that receives the front of the queue
+    /// @return True if an item is removed, false if the queue is empty
+    bool tryPop(T& item)
+    {
+        int currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        item = std::move(items[currentHead]);
+        head.store(next(currentHead), std::memory_order_release);
+
+        return true;
+    }
+
+private:
+    /// @brief Gets the index after an index in the ring
+    /// @param index The index
+    /// @return The next index
+    int next(int index) const
+    {
+        return index + 1 == (int)items.size() ? 0 : index + 1;
+    }
+
+    /// @brief The ring with the items, one place is always empty so a full queue is told from an empty one
+    std::vector<T> items;
+    /// @brief The index of the front item, written only by the consumer
+    alignas(64) std::atomic<int> head;
+    /// @brief The index after the last item, written only by the producer
+    alignas(64) std::atomic<int> tail;
+};
@@ -0,0 +1,319 @@
+#include "StreamExecutor.h"
+#include "Tokenizer.h"
+#include "Compiler.h"
+#include "Executor.h"
+
+#include <stack>
+
+namespace
+{
+    /// @brief The slot of the variables that are the parameter of the function they are in
+    const int parameterSlot = -2;
+
+    /// @brief Deletes the trees of executed statements, the kept function definitions are deleted with the executor
+    /// @param statements The statements
+    /// @param isKept Flags for the kept statements
+    void deleteStatements(std::vector<Node>* statements, const std::vector<char>& isKept)
+    {
+        for (int i = 0; i < statements->size(); i++)
+        {
+            if (!isKept[i])
+            {
+                Executor::deleteTree((*statements)[i]);
+            }
+        }
+
+        delete statements;
+    }
+}
+
+StreamExecutor::~StreamExecutor()
+{
+    for (Node& function : functions)
+    {
+        Executor::deleteTree(function);
+    }
+}
+
+int StreamExecutor::execute(std::istream& program, std::ostream& out, std::istream& in)
+{
+    StreamExecutor executor(out, in);
+
+    std::string line;
+    while (std::getline(program, line))
+    {
+        executor.executeLine(line);
+    }
+
+    return executor.lineNumber - 1;
+}
+
+void StreamExecutor::executeLine(const std::string& line)
+{
+    Node statementRoot = compileLine(line, lineNumber++);
+
+    executeStatements(statementRoot.children);
+}
+
+Node StreamExecutor::compileLine(const std::string& line, int lineNumber)
+{
+    // The end of the previous line is tokenized with the line, so the first token is checked like in the whole program
+    TokenBuffer tokens = lineNumber == 1 ? Tokenizer::tokenizeBuffer(line) : Tokenizer::tokenizeBuffer("\n" + line);
+    tokens.firstLine = lineNumber == 1 ? 1 : lineNumber - 1;
+
+    return Compiler::compile(tokens);
+}
+
+void StreamExecutor::executeStatements(std::vector<Node>* statements)
+{
+    std::vector<char> isKept(statements->size(), 0);
+    try
+    {
+        for (int i = 0; i < statements->size(); i++)
+        {
+            Node& statement = (*statements)[i];
+
+            resolve(statement);
+            isKept[i] = executeStatement(statement) ? 1 : 0;
+        }
+    }
+    catch (...)
+    {
+        deleteStatements(statements, isKept);
+        throw;
+    }
+
+    deleteStatements(statements, isKept);
+}
+
+void StreamExecutor::resolve(Node& statement)
+{
+    // The parameter of a function definition is resolved to the argument of the call, the other variables are globals
+    const std::string* parameter = nullptr;
+    if (statement.type == NodeType::define_function)
+    {
+        statement.slot = getFunctionSlot(statement.value);
+        parameter = &(*statement.children)[0].value;
+    }
+
+    std::stack<Node*> resolveStack;
+    for (int i = statement.type == NodeType::define_function ? 1 : 0; i < statement.children->size(); i++)
+    {
+        resolveStack.push(&(*statement.children)[i]);
+    }
+
+    while (!resolveStack.empty())
+    {
+        Node* node = resolveStack.top();
+        resolveStack.pop();
+
+        if (node->type == NodeType::variable)
+        {
+            node->slot = parameter != nullptr && node->value == *parameter ? parameterSlot : getGlobalSlot(node->value);
+        }
+        else if (node->type == NodeType::function)
+        {
+            node->slot = getFunctionSlot(node->value);
+        }
+
+        for (Node& child : *node->children)
+        {
+            resolveStack.push(&child);
+        }
+    }
+}
+
+long long StreamExecutor::evaluate(const Node& expression)
+{
+    // The expression is evaluated with an iterative dfs like in the executor
+    evaluationStack.clear();
+    results.clear();
+    arguments.clear();
+
+    // A failed evaluation can leave functions marked as called
+    for (int function : calledFunctions)
+    {
+        activeFunctions[function] = 0;
+    }
+    calledFunctions.clear();
+
+    evaluationStack.push_back(Frame{ &expression, 0 });
+
+    while (!evaluationStack.empty())
+    {
+        Frame& frame = evaluationStack.back();
+        const Node& node = *frame.node;
+
+        switch (node.type)
+        {
+        case NodeType::number:
+            results.push_back(Executor::parseNumber(node.value));
+            evaluationStack.pop_back();
+            break;
+        case NodeType::variable:
+            if (node.slot == parameterSlot)
+            {
+                results.push_back(arguments.back());
+            }
+            else
+            {
+                if (!definedGlobals[node.slot])
+                {
+                    throw std::invalid_argument("Use of undefined variable '" + node.value + "'");
+                }
+                results.push_back(globals[node.slot]);
+            }
+            evaluationStack.pop_back();
+            break;
+        case NodeType::function:
+            // The argument is evaluated first, then the body of the definition with the argument, then the argument is removed
+            if (frame.next == 0)
+            {
+                frame.next = 1;
+                evaluationStack.push_back(Frame{ &(*node.children)[0], 0 });
+            }
+            else if (frame.next == 1)
+            {
+                if (!definedFunctions[node.slot])
+                {
+                    throw std::invalid_argument("Function " + node.value + " is not defined!");
+                }
+
+                // The definitions are checked only when they arrive, so a cycle of calls through other functions is found when it is called
+                if (activeFunctions[node.slot])
+                {
+                    throw std::invalid_argument("Recursion is not supported! Function '" + node.value + "' is called again from '"
+                        + functions[calledFunctions.back()].value + "'");
+                }
+                activeFunctions[node.slot] = 1;
+                calledFunctions.push_back(node.slot);
+
+                arguments.push_back(results.back());
+                results.pop_back();
+
+                frame.next = 2;
+                evaluationStack.push_back(Frame{ &(*functions[node.slot].children)[1], 0 });
+            }
+            else
+            {
+                activeFunctions[calledFunctions.back()] = 0;
+                calledFunctions.pop_back();
+                arguments.pop_back();
+                evaluationStack.pop_back();
+            }
+            break;
+        default:
+            if (frame.next < 2)
+            {
+                int child = frame.next++;
+                evaluationStack.push_back(Frame{ &(*node.children)[child], 0 });
+            }
+            else
+            {
+                long long right = results.back();
+                results.pop_back();
+                long long left = results.back();
+                results.pop_back();
+
+                long long result = 0;
+                switch (node.type)
+                {
+                case NodeType::operation_add:
+                    result = left + right;
+                    break;
+                case NodeType::operation_subtract:
+                    result = left - right;
+                    break;
+                case NodeType::operation_multipy:
+                    result = left * right;
+                    break;
+                case NodeType::operation_divide:
+                    result = left / right;
+                    break;
+                case NodeType::operation_modulo:
+                    result = left % right;
+                    break;
+                default:
+                    break;
+                }
+                results.push_back(result);
+
+                evaluationStack.pop_back();
+            }
+            break;
+        }
+    }
+
+    return results.back();
+}
+
+bool StreamExecutor::executeStatement(const Node& statement)
+{
+    switch (statement.type)
+    {
+    case NodeType::operation_assign:
+    {
+        long long value = evaluate((*statement.children)[1]);
+
+        int slot = (*statement.children)[0].slot;
+        globals[slot] = value;
+        definedGlobals[slot] = 1;
+    }
+    break;
+    case NodeType::operation_print:
+        out << evaluate((*statement.children)[0]) << std::endl;
+        break;
+    case NodeType::operation_read:
+    {
+        int slot = (*statement.children)[0].slot;
+        globals[slot] = Executor::readNumber(in);
+        definedGlobals[slot] = 1;
+    }
+    break;
+    case NodeType::define_function:
+        if (definedFunctions[statement.slot])
+        {
+            throw std::invalid_argument("Function " + statement.value + " already defined!");
+        }
+        // The slot has an empty node until the function is defined
+        delete functions[statement.slot].children;
+        functions[statement.slot] = statement;
+        definedFunctions[statement.slot] = 1;
+        return true;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+int StreamExecutor::getGlobalSlot(const std::string& name)
+{
+    auto slot = globalSlots.find(name);
+    if (slot != globalSlots.end())
+    {
+        return slot->second;
+    }
+
+    globals.push_back(0);
+    definedGlobals.push_back(0);
+    globalSlots.insert(std::pair<std::string, int>(name, (int)globals.size() - 1));
+
+    return (int)globals.size() - 1;
+}
+
+int StreamExecutor::getFunctionSlot(const std::string& name)
+{
+    auto slot = functionSlots.find(name);
+    if (slot != functionSlots.end())
+    {
+        return slot->second;
+    }
+
+    functions.push_back(Node(NodeType::undefined));
+    definedFunctions.push_back(0);
+    activeFunctions.push_back(0);
+    functionSlots.insert(std::pair<std::string, int>(name, (int)functions.size() - 1));
+
+    return (int)functions.size() - 1;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Node.h"
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Class that reads, compiles and executes a program one statement at a time,
+/// so the memory is bounded by the globals and the function definitions instead of the length of the program
+class StreamExecutor
+{
+public:
+    /// @brief Constructor for creating an executor with empty state
+    /// @param out The output stream
+    /// @param in The input stream
+    StreamExecutor(std::ostream& out, std::istream& in) : out(out), in(in) {}
+    /// @brief Destructor that deletes the function definitions
+    ~StreamExecutor();
+
+    StreamExecutor(const StreamExecutor&) = delete;
+    StreamExecutor& operator=(const StreamExecutor&) = delete;
+
+    /// @brief Executes every line of a program stream, the syntax errors are reported when their line is reached
+    /// @param program The stream with the program
+    /// @param out The output stream
+    /// @param in The input stream
+    /// @return The number of executed lines
+    static int execute(std::istream& program, std::ostream& out, std::istream& in);
+
+    /// @brief Tokenizes, checks, compiles and executes the next line of the program
+    /// @param line The text of the line
+    void executeLine(const std::string& line);
+
+    /// @brief Tokenizes, checks and compiles one line of a program
+    /// @param line The text of the line
+    /// @param lineNumber The number of the line in the program
+    /// @return The root node with the statement of the line
+    static Node compileLine(const std::string& line, int lineNumber);
+
+    /// @brief Executes compiled statements in order, the executor owns the statements and deletes them
+    /// except for the kept function definitions
+    /// @param statements The children of the root node with the statements
+    void executeStatements(std::vector<Node>* statements);
+
+    /// @brief Gets the number of globals that have a slot
+    /// @return The number of globals
+    int getGlobalCount() const { return (int)globals.size(); }
+
+    /// @brief Gets the number of functions that have a slot
+    /// @return The number of functions
+    int getFunctionCount() const { return (int)functions.size(); }
+
+private:
+    /// @brief A node in the evaluation stack with the number of its children that are evaluated
+    class Frame
+    {
+    public:
+        /// @brief The node
+        const Node* node;
+        /// @brief The number of the evaluated children
+        int next;
+    };
+
+    /// @brief Sets the slots of the variables and the functions in a statement
+    /// @param statement The statement node
+    void resolve(Node& statement);
+
+    /// @brief Evaluates an expression, a call of a function that is already being called is reported as a recursion
+    /// @param expression The root node of the expression
+    /// @return The value of the expression
+    long long evaluate(const Node& expression);
+
+    /// @brief Executes one statement
+    /// @param statement The statement node
+    /// @return True if the statement is a function definition that is kept, otherwise false
+    bool executeStatement(const Node& statement);
+
+    /// @brief Gets the slot of a global, a new global gets the next slot
+    /// @param name The name of the global
+    /// @return The slot
+    int getGlobalSlot(const std::string& name);
+
+    /// @brief Gets the slot of a function, a new function gets the next slot
+    /// @param name The name of the function
+    /// @return The slot
+    int getFunctionSlot(const std::string& name);
+
+    /// @brief The output stream
+    std::ostream& out;
+    /// @brief The input stream
+    std::istream& in;
+    /// @brief The number of the next line
+    int lineNumber = 1;
+
+    /// @brief The values of the globals by slot
+    std::vector<long long> globals;
+    /// @brief Flags for the assigned globals
+    std::vector<char> definedGlobals;
+    /// @brief The slots of the globals by name
+    std::unordered_map<std::string, int> globalSlots;
+
+    /// @brief The definition nodes of the functions by slot
+    std::vector<Node> functions;
+    /// @brief Flags for the defined functions
+    std::vector<char> definedFunctions;
+    /// @brief The slots of the functions by name
+    std::unordered_map<std::string, int> functionSlots;
+
+    /// @brief The nodes that are evaluated (kept between the statements, so they are allocated once)
+    std::vector<Frame> evaluationStack;
+    /// @brief The results of the evaluated nodes
+    std::vector<long long> results;
+    /// @brief The arguments of the function calls that are evaluated
+    std::vector<long long> arguments;
+    /// @brief The functions of the calls that are evaluated (the last one is the function the evaluated node is in)
+    std::vector<int> calledFunctions;
+    /// @brief Flags for the functions that are being called, a call of such a function is a recursion through other functions
+    std::vector<char> activeFunctions;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "DivisionByConstant.h"
+#include <string>
+#include <vector>
+
+/// @brief Table with the slots and function indexes assigned by the Resolver
+class SymbolTable
+{
+public:
+    /// @brief Names of the variables by slot (the globals are first, followed by one parameter slot per function)
+    std::vector<std::string> variables;
+    /// @brief Number of global variable slots
+    int globalCount = 0;
+    /// @brief Names of the functions by index
+    std::vector<std::string> functions;
+    /// @brief The constant divisors of the divisions and modulos, by the slot of their operation node
+    std::vector<DivisionByConstant> divisors;
+
+    /// @brief Gets the slot of the parameter of a function
+    /// @param functionIndex The function index
+    /// @return The parameter slot
+    int getParameterSlot(int functionIndex) const { return globalCount + functionIndex; }
+};
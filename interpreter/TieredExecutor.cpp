@@ -0,0 +1,321 @@
+#include "TieredExecutor.h"
+#include "Executor.h"
+
+#include <chrono>
+#include <utility>
+#include <stdexcept>
+
+TieredExecutor::TieredExecutor(const Node& treeRoot, long long functionThreshold, long long statementThreshold)
+    : TieredExecutor(Ast(treeRoot), functionThreshold, statementThreshold)
+{
+}
+
+TieredExecutor::TieredExecutor(const Ast& ast, long long functionThreshold, long long statementThreshold)
+    : ast(ast), program(ast), functionThreshold(functionThreshold), statementThreshold(statementThreshold)
+{
+    // The symbols are interned by the AST, so the runtime state already has a slot for everything the program uses
+    functionDefinitions.assign(program.functions.size(), -1);
+    functionCalls.assign(program.functions.size(), 0);
+    compiledFunctions.assign(program.functions.size(), ClosureExpression());
+
+    const AstNode& root = ast.nodes[ast.root];
+    for (int i = 0; i < root.childCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+        statements.push_back(statement);
+
+        if (ast.nodes[statement].type == NodeType::define_function)
+        {
+            int index = (int)ast.nodes[statement].value;
+            if (functionDefinitions[index] < 0)
+            {
+                functionDefinitions[index] = statement;
+
+                // Every function starts in the interpreter, compiled code calls it through the same table
+                program.functionBodies[index] = [this, index](ClosureContext& context) -> long long
+                {
+                    return interpretFunction(index, context);
+                };
+            }
+        }
+    }
+
+    // The interpreter computes the divisions by a constant with the precomputed multiplier and shift, like the compiled tier
+    divisorIndexes.assign(ast.nodes.size(), -1);
+    for (int i = 0; i < ast.nodes.size(); i++)
+    {
+        if ((ast.nodes[i].type == NodeType::operation_divide || ast.nodes[i].type == NodeType::operation_modulo)
+            && ast.nodes[ast.getChild(i, 1)].type == NodeType::number
+            && DivisionByConstant::isReducible(ast.nodes[ast.getChild(i, 1)].value))
+        {
+            divisors.push_back(DivisionByConstant(ast.nodes[ast.getChild(i, 1)].value));
+            divisorIndexes[i] = (int)divisors.size() - 1;
+        }
+    }
+
+    statementRuns.assign(statements.size(), 0);
+    compiledStatements.assign(statements.size(), ClosureStatement());
+}
+
+void TieredExecutor::execute()
+{
+    execute(std::cout, std::cin);
+}
+
+void TieredExecutor::execute(std::ostream& out, std::istream& in)
+{
+    ClosureContext context(program, out, in);
+
+    // A failed run can leave entries on the evaluation stacks
+    pendingNodes.clear();
+    operands.clear();
+
+    for (int i = 0; i < statements.size(); i++)
+    {
+        if (compiledStatements[i])
+        {
+            compiledStatements[i](context);
+            stats.compiledStatements++;
+        }
+        else
+        {
+            interpretStatement(statements[i], context);
+            stats.interpretedStatements++;
+
+            if (++statementRuns[i] == statementThreshold)
+            {
+                auto compileStart = std::chrono::steady_clock::now();
+                compiledStatements[i] = ClosureExecutor::compileStatement(ast, statements[i], program);
+                auto compileEnd = std::chrono::steady_clock::now();
+
+                stats.promotions.push_back(TierPromotion("statement " + std::to_string(i + 1), statementRuns[i],
+                    std::chrono::duration<double, std::milli>(compileEnd - compileStart).count()));
+            }
+        }
+
+        installPromotedFunctions();
+    }
+
+    out.flush();
+
+    stats.runs++;
+}
+
+void TieredExecutor::printStats(std::ostream& out) const
+{
+    out << "runs: " << stats.runs << std::endl;
+    out << "statements: " << stats.interpretedStatements << " interpreted, " << stats.compiledStatements << " compiled" << std::endl;
+    out << "interpreted function calls: " << stats.interpretedCalls << std::endl;
+
+    for (const TierPromotion& promotion : stats.promotions)
+    {
+        out << "promoted " << promotion.name << " after " << promotion.executions << " executions (compiled in " << promotion.compileTime << " ms)" << std::endl;
+    }
+
+    for (int i = 0; i < functionDefinitions.size(); i++)
+    {
+        if (functionDefinitions[i] >= 0)
+        {
+            out << "function " << program.functions[i] << ": " << (compiledFunctions[i] ? "compiled" : "interpreted")
+                << ", " << functionCalls[i] << " interpreted calls" << std::endl;
+        }
+    }
+
+    long long compiledStatementCount = 0;
+    for (const ClosureStatement& statement : compiledStatements)
+    {
+        compiledStatementCount += statement ? 1 : 0;
+    }
+    out << "statements in the compiled tier: " << compiledStatementCount << " of " << statements.size() << std::endl;
+}
+
+void TieredExecutor::interpretStatement(int statement, ClosureContext& context)
+{
+    const AstNode& statementNode = ast.nodes[statement];
+
+    switch (statementNode.type)
+    {
+    case NodeType::operation_assign:
+    {
+        long long value = interpretExpression(ast.getChild(statement, 1), -1, context);
+
+        int slot = (int)ast.nodes[ast.getChild(statement, 0)].value;
+        context.globals[slot] = value;
+        context.definedGlobals[slot] = 1;
+    }
+    break;
+    case NodeType::operation_read:
+    {
+        int slot = (int)ast.nodes[ast.getChild(statement, 0)].value;
+        context.globals[slot] = Executor::readNumber(*context.in);
+        context.definedGlobals[slot] = 1;
+    }
+    break;
+    case NodeType::operation_print:
+        *context.out << interpretExpression(ast.getChild(statement, 0), -1, context) << '\n';
+        break;
+    case NodeType::define_function:
+    {
+        // The calls of an analyzed program don't check the definitions, so they aren't tracked
+        if (program.isAnalyzed)
+        {
+            break;
+        }
+
+        int index = (int)statementNode.value;
+        if (context.definedFunctions[index])
+        {
+            throw std::invalid_argument("Function " + program.functions[index] + " already defined!");
+        }
+        context.definedFunctions[index] = 1;
+    }
+    break;
+    default:
+        break;
+    }
+}
+
+long long TieredExecutor::interpretExpression(int expression, long long parameter, ClosureContext& context)
+{
+    // The nodes and the operands are kept on explicit stacks, so deep expressions don't overflow the native stack.
+    // The stacks are shared by the nested calls, every call uses only the entries above the ones it found
+    size_t stackBase = pendingNodes.size();
+    pendingNodes.push_back({ expression, false });
+
+    while (pendingNodes.size() > stackBase)
+    {
+        int node = pendingNodes.back().first;
+        bool isVisited = pendingNodes.back().second;
+        pendingNodes.pop_back();
+
+        const AstNode& expressionNode = ast.nodes[node];
+
+        switch (expressionNode.type)
+        {
+        case NodeType::number:
+            operands.push_back(expressionNode.value);
+            break;
+        case NodeType::variable:
+        {
+            if (expressionNode.value == parameter)
+            {
+                operands.push_back(context.parameter);
+                break;
+            }
+
+            int slot = (int)expressionNode.value;
+            if (!program.isAnalyzed && !context.definedGlobals[slot])
+            {
+                throw std::invalid_argument("Use of undefined variable '" + program.globals[slot] + "'");
+            }
+            operands.push_back(context.globals[slot]);
+        }
+        break;
+        case NodeType::function:
+        {
+            if (!isVisited)
+            {
+                pendingNodes.push_back({ node, true });
+                pendingNodes.push_back({ ast.getChild(node, 0), false });
+                break;
+            }
+
+            int index = (int)expressionNode.value;
+            if (!program.isAnalyzed && !context.definedFunctions[index])
+            {
+                throw std::invalid_argument("Function " + program.functions[index] + " is not defined!");
+            }
+
+            long long callerParameter = context.parameter;
+            context.parameter = operands.back();
+
+            // The call can grow the stacks, so the result is stored after it
+            long long result = program.functionBodies[index](context);
+
+            context.parameter = callerParameter;
+
+            operands.back() = result;
+        }
+        break;
+        default:
+        {
+            if (!isVisited)
+            {
+                // The divisions by a constant need only the left operand
+                pendingNodes.push_back({ node, true });
+                if (divisorIndexes[node] < 0)
+                {
+                    pendingNodes.push_back({ ast.getChild(node, 1), false });
+                }
+                pendingNodes.push_back({ ast.getChild(node, 0), false });
+                break;
+            }
+
+            if (divisorIndexes[node] >= 0)
+            {
+                const DivisionByConstant& divisor = divisors[divisorIndexes[node]];
+                operands.back() = expressionNode.type == NodeType::operation_divide ? divisor.divide(operands.back()) : divisor.modulo(operands.back());
+                break;
+            }
+
+            long long right = operands.back();
+            operands.pop_back();
+            long long left = operands.back();
+
+            switch (expressionNode.type)
+            {
+            case NodeType::operation_add: operands.back() = left + right; break;
+            case NodeType::operation_subtract: operands.back() = left - right; break;
+            case NodeType::operation_multipy: operands.back() = left * right; break;
+            case NodeType::operation_divide: operands.back() = left / right; break;
+            case NodeType::operation_modulo: operands.back() = left % right; break;
+            default: throw std::invalid_argument("Unexpected node in expression");
+            }
+        }
+        break;
+        }
+    }
+
+    long long result = operands.back();
+    operands.pop_back();
+
+    return result;
+}
+
+long long TieredExecutor::interpretFunction(int index, ClosureContext& context)
+{
+    // A function promoted during the current statement is already compiled,
+    // but it replaces the interpreter in the function table only after the statement
+    if (compiledFunctions[index])
+    {
+        return compiledFunctions[index](context);
+    }
+
+    int definition = functionDefinitions[index];
+    int body = ast.getChild(definition, 1);
+    long long parameter = ast.nodes[ast.getChild(definition, 0)].value;
+
+    stats.interpretedCalls++;
+    if (++functionCalls[index] == functionThreshold)
+    {
+        auto compileStart = std::chrono::steady_clock::now();
+        compiledFunctions[index] = ClosureExecutor::compileExpression(ast, body, parameter, program);
+        auto compileEnd = std::chrono::steady_clock::now();
+
+        stats.promotions.push_back(TierPromotion("function " + program.functions[index], functionCalls[index],
+            std::chrono::duration<double, std::milli>(compileEnd - compileStart).count()));
+
+        pendingFunctions.push_back(index);
+    }
+
+    return interpretExpression(body, parameter, context);
+}
+
+void TieredExecutor::installPromotedFunctions()
+{
+    for (int index : pendingFunctions)
+    {
+        program.functionBodies[index] = compiledFunctions[index];
+    }
+    pendingFunctions.clear();
+}
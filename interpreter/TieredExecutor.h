@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Node.h"
+#include "Ast.h"
+#include "ClosureExecutor.h"
+#include "DivisionByConstant.h"
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief Promotion of a function or a statement from the interpreter to the compiled tier
+class TierPromotion
+{
+public:
+    /// @brief Description of the promoted code ("function D" or "statement 3")
+    std::string name;
+    /// @brief Number of executions in the interpreter before the promotion
+    long long executions;
+    /// @brief Time spent compiling the promoted code in milliseconds
+    double compileTime;
+    /// @brief Constructor for creating a promotion event
+    /// @param name Description of the promoted code
+    /// @param executions Number of executions before the promotion
+    /// @param compileTime Compile time in milliseconds
+    TierPromotion(std::string name, long long executions, double compileTime) : name(name), executions(executions), compileTime(compileTime) {}
+};
+
+/// @brief Execution statistics of the tiered executor
+class TieredStats
+{
+public:
+    /// @brief Number of completed runs of the program
+    long long runs = 0;
+    /// @brief Top level statements executed by the interpreter
+    long long interpretedStatements = 0;
+    /// @brief Top level statements executed as compiled closures
+    long long compiledStatements = 0;
+    /// @brief Function calls executed by the interpreter
+    long long interpretedCalls = 0;
+    /// @brief The promotion events in the order they happened
+    std::vector<TierPromotion> promotions;
+};
+
+/// @brief Executor that starts in a tree walking interpreter and promotes hot functions and statements to closures
+class TieredExecutor
+{
+public:
+    /// @brief Constructor for creating the executor of a program
+    /// @param treeRoot The root node of the AST
+    /// @param functionThreshold Number of calls after which a function is compiled
+    /// @param statementThreshold Number of runs after which a top level statement is compiled
+    TieredExecutor(const Node& treeRoot, long long functionThreshold = 64, long long statementThreshold = 16);
+
+    /// @brief Constructor for creating the executor of a program (the executor keeps a copy of the AST)
+    /// @param ast The arena AST
+    /// @param functionThreshold Number of calls after which a function is compiled
+    /// @param statementThreshold Number of runs after which a top level statement is compiled
+    TieredExecutor(const Ast& ast, long long functionThreshold = 64, long long statementThreshold = 16);
+
+    TieredExecutor(const TieredExecutor&) = delete;
+    TieredExecutor& operator=(const TieredExecutor&) = delete;
+
+    /// @brief Executes the program once using the console output and input streams
+    void execute();
+
+    /// @brief Executes the program once using the given output and input streams
+    /// (the call counters are kept between runs, so repeated runs reach the compiled tier)
+    /// @param out The output stream
+    /// @param in The input stream
+    void execute(std::ostream& out, std::istream& in);
+
+    /// @brief Gets the execution statistics
+    /// @return The statistics of all runs so far
+    const TieredStats& getStats() const { return stats; }
+
+    /// @brief Writes the execution statistics and the tier of every function and statement
+    /// @param out The stream the statistics are written to
+    void printStats(std::ostream& out) const;
+
+private:
+    /// @brief Executes a statement with the interpreter
+    /// @param statement The index of the statement node
+    /// @param context The runtime state
+    void interpretStatement(int statement, ClosureContext& context);
+
+    /// @brief Computes an expression with the interpreter, the nodes and the operands are kept on explicit stacks
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param context The runtime state
+    /// @return The value of the expression
+    long long interpretExpression(int expression, long long parameter, ClosureContext& context);
+
+    /// @brief Executes a function that is not promoted yet (counts the call and promotes the function when it gets hot)
+    /// @param index The function index
+    /// @param context The runtime state with the argument in the parameter
+    /// @return The result of the function
+    long long interpretFunction(int index, ClosureContext& context);
+
+    /// @brief Installs the functions promoted during the last statement in the function table
+    void installPromotedFunctions();
+
+    /// @brief The executed AST
+    Ast ast;
+    /// @brief The indexes of the top level statements
+    std::vector<int> statements;
+    /// @brief The program with the variable and function tables and the function bodies
+    ClosureProgram program;
+    /// @brief The index of the precomputed divisor of every division by a constant (-1 for the other nodes)
+    std::vector<int> divisorIndexes;
+    /// @brief The precomputed constant divisors
+    std::vector<DivisionByConstant> divisors;
+    /// @brief Number of runs of every statement
+    std::vector<long long> statementRuns;
+    /// @brief The compiled statements (empty until a statement is promoted)
+    std::vector<ClosureStatement> compiledStatements;
+    /// @brief The index of the first definition of every function (-1 if it is never defined)
+    std::vector<int> functionDefinitions;
+    /// @brief Number of interpreted calls of every function
+    std::vector<long long> functionCalls;
+    /// @brief The compiled functions (empty until a function is promoted)
+    std::vector<ClosureExpression> compiledFunctions;
+    /// @brief Functions compiled during the current statement, they replace the interpreter after the statement
+    std::vector<int> pendingFunctions;
+    /// @brief The nodes left to compute by the interpreter (a node and a flag showing if its operands are computed)
+    std::vector<std::pair<int, bool>> pendingNodes;
+    /// @brief The computed operands of the interpreter
+    std::vector<long long> operands;
+    /// @brief Number of calls after which a function is compiled
+    long long functionThreshold;
+    /// @brief Number of runs after which a statement is compiled
+    long long statementThreshold;
+    /// @brief The execution statistics
+    TieredStats stats;
+};
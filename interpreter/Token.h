@@ -1,6 +1,7 @@
 #pragma once
 #include "TokenType.h"
 #include <string>
+#include <utility>
 
 /// @brief Token object representing the tokenized elements
 class Token
@@ -24,5 +25,5 @@ public:
     /// @param value Token value
     /// @param line Line number of token occurence
     /// @param column Column number of token occurence
-    Token(TokenType type, std::string value, int line, int column) : type(type), value(value), line(line), column(column) {}
+    Token(TokenType type, std::string value, int line, int column) : type(type), value(std::move(value)), line(line), column(column) {}
 };
\ No newline at end of file
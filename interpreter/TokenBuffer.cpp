@@ -0,0 +1,149 @@
+#include "TokenBuffer.h"
+#include "Executor.h"
+
+#include <algorithm>
+
+TokenBuffer::TokenBuffer(const std::vector<Token>& tokens)
+{
+    // The text is rebuilt with every token at its column, so the offsets give the same lines and columns
+    std::string text;
+    std::vector<unsigned int> tokenOffsets;
+    std::vector<unsigned int> tokenLineStarts;
+
+    int line = 0;
+    for (const Token& token : tokens)
+    {
+        while (line < token.line)
+        {
+            if (line > 0)
+            {
+                text += '\n';
+            }
+
+            tokenLineStarts.push_back((unsigned int)text.size());
+            line++;
+        }
+
+        unsigned int offset = tokenLineStarts.back() + token.column - 1;
+        if (token.type != TokenType::end_of_line)
+        {
+            if (text.size() < offset)
+            {
+                text.append(offset - text.size(), ' ');
+            }
+
+            text.replace(offset, std::min(token.value.size(), text.size() - offset), token.value);
+        }
+
+        tokenOffsets.push_back(offset);
+    }
+
+    // The tokens are added when the text is done, because the names and the numbers are read from it
+    source = std::make_shared<SourceText>(std::move(text));
+
+    line = 0;
+    for (int i = 0; i < (int)tokens.size(); i++)
+    {
+        while (line < tokens[i].line)
+        {
+            addLine(tokenLineStarts[line++]);
+        }
+
+        addToken(tokens[i].type, tokenOffsets[i], (unsigned int)tokens[i].value.size());
+    }
+}
+
+void TokenBuffer::addLine(unsigned int start)
+{
+    lineStarts.push_back(start);
+    lineFirstTokens.push_back(size());
+}
+
+void TokenBuffer::addToken(TokenType type, unsigned int offset, unsigned int length)
+{
+    int value = -1;
+
+    if (type == TokenType::variable || type == TokenType::function)
+    {
+        std::string name(source->data() + offset, length);
+
+        auto id = nameIds.find(name);
+        if (id == nameIds.end())
+        {
+            names.push_back(name);
+            id = nameIds.insert(std::pair<std::string, int>(names.back(), (int)names.size() - 1)).first;
+        }
+
+        value = id->second;
+    }
+    else if (type == TokenType::number)
+    {
+        // The numbers that can't be parsed are reported when they are compiled or executed
+        try
+        {
+            numbers.push_back(Executor::parseNumber(std::string(source->data() + offset, length)));
+            value = (int)numbers.size() - 1;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+    }
+
+    types.push_back(type);
+    offsets.push_back(offset);
+    lengths.push_back(length);
+    values.push_back(value);
+}
+
+int TokenBuffer::getLine(int token) const
+{
+    return getLineIndex(token) + firstLine;
+}
+
+int TokenBuffer::getColumn(int token) const
+{
+    return (int)(offsets[token] - lineStarts[getLineIndex(token)]) + 1;
+}
+
+std::string TokenBuffer::getValue(int token) const
+{
+    if (lengths[token] == 0)
+    {
+        return std::string();
+    }
+
+    return std::string(source->data() + offsets[token], lengths[token]);
+}
+
+int TokenBuffer::getLineIndex(int token) const
+{
+    // The last line that starts at or before the token (the lines without tokens start at the same index as the next line)
+    return (int)(std::upper_bound(lineFirstTokens.begin(), lineFirstTokens.end(), token) - lineFirstTokens.begin()) - 1;
+}
+
+std::vector<Token> TokenBuffer::toTokens() const
+{
+    std::vector<Token> tokens;
+    tokens.reserve(types.size());
+
+    int line = 0;
+    for (int i = 0; i < size(); i++)
+    {
+        while (line < (int)lineFirstTokens.size() && lineFirstTokens[line] <= i)
+        {
+            line++;
+        }
+
+        int column = (int)(offsets[i] - lineStarts[line - 1]) + 1;
+        if (types[i] == TokenType::end_of_line)
+        {
+            tokens.push_back(Token(types[i], line + firstLine - 1, column));
+        }
+        else
+        {
+            tokens.push_back(Token(types[i], getValue(i), line + firstLine - 1, column));
+        }
+    }
+
+    return tokens;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Token.h"
+#include "SourceText.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Compact token stream with one array per field of the tokens (the tokens are referenced by their index)
+class TokenBuffer
+{
+public:
+    /// @brief The source text the tokens are in (shared, so the buffer can be copied without copying the text)
+    std::shared_ptr<const SourceText> source;
+    /// @brief The types of the tokens
+    std::vector<TokenType> types;
+    /// @brief The offsets of the tokens in the text (the end of line is after the last token and its space)
+    std::vector<unsigned int> offsets;
+    /// @brief The numbers of characters of the tokens
+    std::vector<unsigned int> lengths;
+    /// @brief The name ids of the variables and the functions, the indexes of the parsed numbers (-1 for the numbers that can't be parsed)
+    std::vector<int> values;
+    /// @brief The offsets of the first characters of the lines
+    std::vector<unsigned int> lineStarts;
+    /// @brief The indexes of the first tokens of the lines
+    std::vector<int> lineFirstTokens;
+    /// @brief The names of the variables and the functions by name id
+    std::vector<std::string> names;
+    /// @brief The values of the number literals
+    std::vector<long long> numbers;
+    /// @brief The number of the first line of the text (a buffer with a part of a file starts at its line in the file)
+    int firstLine = 1;
+
+    /// @brief Constructor for creating an empty buffer
+    TokenBuffer() {}
+
+    /// @brief Constructor for creating a buffer from a vector of tokens
+    /// @param tokens Vector with the tokens
+    explicit TokenBuffer(const std::vector<Token>& tokens);
+
+    /// @brief Starts a new line
+    /// @param start The offset of the first character of the line
+    void addLine(unsigned int start);
+
+    /// @brief Adds a token that is in the text, the names are interned and the numbers are parsed
+    /// @param type The type of the token
+    /// @param offset The offset of the token in the text
+    /// @param length The number of characters of the token
+    void addToken(TokenType type, unsigned int offset, unsigned int length);
+
+    /// @brief Gets the number of tokens
+    /// @return The number of tokens
+    int size() const { return (int)types.size(); }
+
+    /// @brief Gets the line of a token
+    /// @param token The index of the token
+    /// @return The line number (starting from 1)
+    int getLine(int token) const;
+
+    /// @brief Gets the column of a token
+    /// @param token The index of the token
+    /// @return The column number (starting from 1)
+    int getColumn(int token) const;
+
+    /// @brief Gets the text of a token
+    /// @param token The index of the token
+    /// @return The text (empty for the end of line)
+    std::string getValue(int token) const;
+
+    /// @brief Gets the name of a variable or a function
+    /// @param token The index of the token
+    /// @return The name
+    const std::string& getName(int token) const { return names[values[token]]; }
+
+    /// @brief Converts the buffer to a vector of tokens
+    /// @return Vector with the tokens
+    std::vector<Token> toTokens() const;
+
+private:
+    /// @brief Gets the index of the line of a token in the line table
+    /// @param token The index of the token
+    /// @return The index of the line
+    int getLineIndex(int token) const;
+
+    /// @brief The name ids by name
+    std::unordered_map<std::string, int> nameIds;
+};
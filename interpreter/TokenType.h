@@ -1,7 +1,7 @@
 #pragma once
 
 /// @brief Enumeration for the possible types the tokenizer uses
-enum class TokenType
+enum class TokenType : unsigned char
 {
     undefined,
     function,
@@ -1,224 +1,168 @@
 #include "Tokenizer.h"
+#include "CharacterScanner.h"
 
-std::vector<Token> Tokenizer::tokenize(std::vector<std::string> lines)
+namespace
 {
-    std::vector<Token> tokens;
+    /// @brief Gets the type of a token of one character
+    /// @param symbol The character
+    /// @return The type of the token; undefined if the symbol is not recognised
+    TokenType getSymbolType(char symbol)
+    {
+        switch (symbol)
+        {
+        case '=':
+            return TokenType::equals;
+        case '+':
+            return TokenType::add;
+        case '-':
+            return TokenType::subtract;
+        case '*':
+            return TokenType::multiply;
+        case '/':
+            return TokenType::division;
+        case '%':
+            return TokenType::modulo;
+        case '[':
+            return TokenType::left_bracket;
+        case ']':
+            return TokenType::right_bracket;
+        case '(':
+            return TokenType::left_parenthesis;
+        case ')':
+            return TokenType::right_parenthesis;
+        default:
+            return TokenType::undefined;
+        }
+    }
+}
 
-    for (int lineIndex = 0; lineIndex < lines.size(); lineIndex++)
+std::vector<Token> Tokenizer::tokenize(const std::vector<std::string>& lines)
+{
+    // The lines are joined, so they are tokenized like the lines of a file
+    size_t textLength = 0;
+    for (const std::string& line : lines)
     {
-        std::string line = lines[lineIndex];
+        textLength += line.size() + 1;
+    }
 
-        int columnIndex = 0;
+    std::string text;
+    text.reserve(textLength);
+    for (const std::string& line : lines)
+    {
+        text += line;
+        text += '\n';
+    }
 
-        // Split in parts (for easier tokeization)
-        std::vector<std::string> textElements = stringSplit(line, ' ');
+    return tokenizeBuffer(std::move(text)).toTokens();
+}
 
-        // Tokenize
-        for (std::string el : textElements)
-        {
-            // Needed to compute the column index of the current token
-            int lastElementLength = el.size();
+std::vector<Token> Tokenizer::tokenizeText(const std::string& text)
+{
+    return tokenizeBuffer(text).toTokens();
+}
 
-            std::string remainingText = el;
+TokenBuffer Tokenizer::tokenizeBuffer(std::string text)
+{
+    return tokenizeBuffer(std::make_shared<const SourceText>(std::move(text)));
+}
 
-            while (remainingText.length() > 0)
-            {
-                // Update current column index
-                if (remainingText.length() < lastElementLength)
-                {
-                    columnIndex += lastElementLength - remainingText.length();
-
-                    lastElementLength = remainingText.length();
-                }
-
-                // Variable check / read / print
-                if (remainingText[0] >= 'a' && remainingText[0] <= 'z')
-                {
-                    std::string varName;
-
-                    int firstNonLowercaseLetterIndex = stringIndexOf(remainingText, [](char c) -> bool { return c < 'a' || c > 'z'; });
-                    if (firstNonLowercaseLetterIndex < 0)
-                    {
-                        varName = remainingText;
-                        remainingText = "";
-                    }
-                    else
-                    {
-                        varName = remainingText.substr(0, firstNonLowercaseLetterIndex);
-                        remainingText = remainingText.substr(firstNonLowercaseLetterIndex);
-                    }
-
-                    if (varName == "read")
-                    {
-                        tokens.push_back(Token(TokenType::read, varName, lineIndex + 1, columnIndex + 1));
-                    }
-                    else if (varName == "print")
-                    {
-                        tokens.push_back(Token(TokenType::print, varName, lineIndex + 1, columnIndex + 1));
-                    }
-                    else
-                    {
-                        tokens.push_back(Token(TokenType::variable, varName, lineIndex + 1, columnIndex + 1));
-                    }
-                }
-                // Function check
-                else if (remainingText[0] >= 'A' && remainingText[0] <= 'Z')
-                {
-                    std::string funcName;
-
-                    int firstNonUppercaseLetterIndex = stringIndexOf(remainingText, [](char c) -> bool { return c < 'A' || c > 'Z'; });
-                    if (firstNonUppercaseLetterIndex < 0)
-                    {
-                        funcName = remainingText;
-                        remainingText = "";
-                    }
-                    else
-                    {
-                        funcName = remainingText.substr(0, firstNonUppercaseLetterIndex);
-                        remainingText = remainingText.substr(firstNonUppercaseLetterIndex);
-                    }
-
-                    tokens.push_back(Token(TokenType::function, funcName, lineIndex + 1, columnIndex + 1));
-                }
-                // Number check
-                else if (remainingText[0] >= '0' && remainingText[0] <= '9')
-                {
-                    std::string numText;
-
-                    int firstNonNumberIndex = stringIndexOf(remainingText, [](char c) -> bool { return c < '0' || c > '9'; });
-                    if (firstNonNumberIndex < 0)
-                    {
-                        numText = remainingText;
-                        remainingText = "";
-                    }
-                    else
-                    {
-                        numText = remainingText.substr(0, firstNonNumberIndex);
-                        remainingText = remainingText.substr(firstNonNumberIndex);
-                    }
-
-                    tokens.push_back(Token(TokenType::number, numText, lineIndex + 1, columnIndex + 1));
-                }
-                // Operator =
-                else if (remainingText[0] == '=')
-                {
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::equals, "=", lineIndex + 1, columnIndex + 1));
-                }
-                // Operator +
-                else if (remainingText[0] == '+')
-                {
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::add, "+", lineIndex + 1, columnIndex + 1));
-                }
-                // Operator -
-                else if (remainingText[0] == '-')
-                {
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::subtract, "-", lineIndex + 1, columnIndex + 1));
-                }
-                // Operator *
-                else if (remainingText[0] == '*')
-                {
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::multiply, "*", lineIndex + 1, columnIndex + 1));
-                }
-                // Operator /
-                else if (remainingText[0] == '/')
-                {
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::division, "/", lineIndex + 1, columnIndex + 1));
-                }
-                // Operator %
-                else if (remainingText[0] == '%')
-                {
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::modulo, "%", lineIndex + 1, columnIndex + 1));
-                }
-                // Left bracket
-                else if (remainingText[0] == '[')
-                {
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::left_bracket, "[", lineIndex + 1, columnIndex + 1));
-                }
-                // Right bracket
-                else if (remainingText[0] == ']')
-                {
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::right_bracket, "]", lineIndex + 1, columnIndex + 1));
-                }
-                //  Left parenthesis
-                else if (remainingText[0] == '(')
-                {
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::left_parenthesis, "(", lineIndex + 1, columnIndex + 1));
-                }
-                //  Right parenthesis
-                else if (remainingText[0] == ')')
-                {
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::right_parenthesis, ")", lineIndex + 1, columnIndex + 1));
-                }
-                // Undefined (if the symbol was not recognised)
-                else
-                {
-                    std::string symbol = remainingText.substr(0, 1);
-
-                    remainingText = remainingText.substr(1);
-
-                    tokens.push_back(Token(TokenType::undefined, symbol, lineIndex + 1, columnIndex + 1));
-                }
-            }
+TokenBuffer Tokenizer::tokenizeBuffer(std::shared_ptr<const SourceText> source)
+{
+    // The lines are split like std::getline splits them, so a '\n' at the end of the text doesn't start a new line
+    std::vector<unsigned int> lineStarts = source->getLineStarts();
 
-            // Update current column index
-            if (remainingText.length() < lastElementLength)
-            {
-                columnIndex += lastElementLength - remainingText.length();
+    return tokenizeLines(std::move(source), lineStarts, 0, (int)lineStarts.size());
+}
 
-                lastElementLength = remainingText.length();
-            }
+TokenBuffer Tokenizer::tokenizeLines(std::shared_ptr<const SourceText> source, const std::vector<unsigned int>& lineStarts, int firstLine, int lastLine)
+{
+    TokenBuffer tokens;
+    tokens.source = std::move(source);
 
-            // Add space after token to the column index (because we split the the initial line by spaces)
-            columnIndex += 1;
-        }
+    unsigned int textLength = (unsigned int)tokens.source->size();
+    unsigned int textEnd = textLength > 0 && tokens.source->data()[textLength - 1] == '\n' ? textLength - 1 : textLength;
+
+    // The end of the previous line is an empty line in front of the others, so the first token is checked like in the whole text
+    if (firstLine > 0)
+    {
+        unsigned int previousEnd = lineStarts[firstLine] - 1;
 
-        tokens.push_back(Token(TokenType::end_of_line, lineIndex + 1, columnIndex + 1));
+        tokens.firstLine = firstLine;
+        tokens.addLine(previousEnd);
+        tokenizeLine(previousEnd, 0, (int)(textLength - previousEnd), tokens);
     }
 
-    return tokens;
-}
+    for (int i = firstLine; i < lastLine; i++)
+    {
+        // Every line ends before the '\n' that starts the next one
+        unsigned int lineEnd = i + 1 < (int)lineStarts.size() ? lineStarts[i + 1] - 1 : textEnd;
 
-std::vector<std::string> Tokenizer::stringSplit(const std::string& str, char delimeter)
-{
-    std::vector<std::string> segments;
-    std::istringstream stream(str);
-    std::string segment;
+        tokens.addLine(lineStarts[i]);
 
-    while (std::getline(stream, segment, delimeter))
-    {
-        segments.push_back(segment);
+        // The scanner can read the blocks after the end of the line, they are in the same buffer
+        tokenizeLine(lineStarts[i], (int)(lineEnd - lineStarts[i]), (int)(textLength - lineStarts[i]), tokens);
     }
 
-    return segments;
+    return tokens;
 }
 
-int Tokenizer::stringIndexOf(const std::string& str, std::function<bool(char)> predicate)
+void Tokenizer::tokenizeLine(unsigned int lineStart, int length, int readable, TokenBuffer& tokens)
 {
-    for (int i = 0; i < str.length(); i++)
+    const char* line = tokens.source->data() + lineStart;
+    int position = 0;
+
+    while (position < length)
     {
-        if (predicate(str[i]))
-            return i;
+        char symbol = line[position];
+        int start = position;
+
+        // Spaces only separate the tokens
+        if (symbol == ' ')
+        {
+            position = CharacterScanner::skipRange(line, position, length, readable, ' ', ' ');
+        }
+        // Variable check / read / print
+        else if (symbol >= 'a' && symbol <= 'z')
+        {
+            position = CharacterScanner::skipRange(line, position, length, readable, 'a', 'z');
+
+            TokenType type = TokenType::variable;
+            if (position - start == 4 && line[start] == 'r' && line[start + 1] == 'e' && line[start + 2] == 'a' && line[start + 3] == 'd')
+            {
+                type = TokenType::read;
+            }
+            else if (position - start == 5 && line[start] == 'p' && line[start + 1] == 'r' && line[start + 2] == 'i' && line[start + 3] == 'n' && line[start + 4] == 't')
+            {
+                type = TokenType::print;
+            }
+
+            tokens.addToken(type, lineStart + start, position - start);
+        }
+        // Function check
+        else if (symbol >= 'A' && symbol <= 'Z')
+        {
+            position = CharacterScanner::skipRange(line, position, length, readable, 'A', 'Z');
+
+            tokens.addToken(TokenType::function, lineStart + start, position - start);
+        }
+        // Number check
+        else if (symbol >= '0' && symbol <= '9')
+        {
+            position = CharacterScanner::skipRange(line, position, length, readable, '0', '9');
+
+            tokens.addToken(TokenType::number, lineStart + start, position - start);
+        }
+        // Operators, brackets, parentheses and the symbols that are not recognised (undefined)
+        else
+        {
+            position++;
+
+            tokens.addToken(getSymbolType(symbol), lineStart + start, 1);
+        }
     }
 
-    return -1;
+    // The end of the line is one column after the last token and its space (a line that ends with a space doesn't get another one)
+    int endColumn = length > 0 && line[length - 1] != ' ' ? length + 1 : length;
+
+    tokens.addToken(TokenType::end_of_line, lineStart + endColumn, 0);
 }
@@ -1,11 +1,10 @@
 #pragma once
 
 #include "Token.h"
+#include "TokenBuffer.h"
 
 #include <vector>
-#include <iostream>
-#include <functional>
-#include <sstream>
+#include <string>
 
 /// @brief Class with methods for tokenizing text
 class Tokenizer
@@ -14,18 +13,37 @@ public:
     /// @brief Converts the text to tokens
     /// @param Lines vector with strings of the text to tokenize
     /// @return Vector with tokens
-    static std::vector<Token> tokenize(std::vector<std::string> lines);
+    static std::vector<Token> tokenize(const std::vector<std::string>& lines);
+
+    /// @brief Converts the text to tokens, the lines are separated by '\n' (like the lines read from a file)
+    /// @param text The whole text to tokenize
+    /// @return Vector with tokens
+    static std::vector<Token> tokenizeText(const std::string& text);
+
+    /// @brief Converts the text to a compact token buffer, the lines are separated by '\n' (like the lines read from a file)
+    /// @param text The whole text to tokenize (it is kept in the buffer)
+    /// @return The token buffer
+    static TokenBuffer tokenizeBuffer(std::string text);
+
+    /// @brief Converts the source text to a compact token buffer without copying the text
+    /// @param source The source text (it is shared with the buffer)
+    /// @return The token buffer
+    static TokenBuffer tokenizeBuffer(std::shared_ptr<const SourceText> source);
+
+    /// @brief Converts a range of lines of the source text to a compact token buffer, the buffer has the line numbers of the whole text.
+    /// A range after the first line starts with the end of the previous line, so the syntax errors are the same as in the whole text
+    /// @param source The source text (it is shared with the buffer)
+    /// @param lineStarts The offsets of the first characters of the lines of the text
+    /// @param firstLine The index of the first line in the range
+    /// @param lastLine The index after the last line in the range
+    /// @return The token buffer
+    static TokenBuffer tokenizeLines(std::shared_ptr<const SourceText> source, const std::vector<unsigned int>& lineStarts, int firstLine, int lastLine);
 
 private:
-    /// @brief Splits the string into vector with strings by a delimeter
-    /// @param str The string to split
-    /// @param delimeter The delimeter to use for splitting
-    /// @return Vector of the splited strings
-    static std::vector<std::string> stringSplit(const std::string& str, char delimeter);
-
-    /// @brief Finds the index of the first occurence determined by a predicate
-    /// @param str The string to search
-    /// @param predicate The predicate used for searching
-    /// @return The index of the first occurence; -1 if not found
-    static int stringIndexOf(const std::string& str, std::function<bool(char)> predicate);
-};
\ No newline at end of file
+    /// @brief Converts one line to tokens, the text is scanned once and only the token arrays are allocated
+    /// @param lineStart The offset of the first character of the line in the text of the buffer
+    /// @param length The number of characters in the line
+    /// @param readable The number of characters that can be read from the start of the line (at least the length)
+    /// @param tokens The buffer the tokens are added to
+    static void tokenizeLine(unsigned int lineStart, int length, int readable, TokenBuffer& tokens);
+};
@@ -0,0 +1,296 @@
+#include "Transpiler.h"
+#include "SemanticAnalyzer.h"
+
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    /// @brief Runtime support code of the generated program
+    const char* runtimeSource = R"(#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT
+#endif
+
+/* Reads the next word from the input and converts it like std::stoul, returns 0 on success */
+static int read_number(long long* value)
+{
+    static char* buffer = NULL;
+    static size_t capacity = 0;
+    size_t length = 0;
+    char* end;
+    int c = getchar();
+
+    while (c != EOF && isspace(c))
+        c = getchar();
+
+    while (c != EOF && !isspace(c))
+    {
+        if (length + 1 >= capacity)
+        {
+            capacity = capacity * 2 + 64;
+            buffer = (char*)realloc(buffer, capacity);
+        }
+        buffer[length++] = (char)c;
+        c = getchar();
+    }
+
+    if (length == 0)
+        return 1;
+    buffer[length] = '\0';
+
+    errno = 0;
+    *value = (long long)strtoul(buffer, &end, 10);
+
+    return end == buffer || errno == ERANGE;
+}
+)";
+}
+
+std::string Transpiler::transpile(const Node& treeRoot)
+{
+    return transpile(Ast(treeRoot));
+}
+
+std::string Transpiler::transpile(const Ast& ast)
+{
+    if (!SemanticAnalyzer::isSafe(ast))
+    {
+        throw std::invalid_argument("The program uses a variable or function before it is defined and can't be transpiled");
+    }
+
+    UsageAnalysis analysis(ast);
+
+    std::ostringstream source;
+    source << "/* Generated by the interpreter transpiler */" << std::endl;
+    source << runtimeSource << std::endl;
+
+    const AstNode& root = ast.nodes[ast.root];
+
+    // Functions read the globals at the time they are called,
+    // so every function receives the current values of the globals it uses (directly or through other functions)
+    std::vector<int> definitions;
+    for (int i = 0; i < root.childCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+        if (ast.nodes[statement].type == NodeType::define_function)
+        {
+            definitions.push_back(statement);
+        }
+    }
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int definition : definitions)
+        {
+            int function = (int)ast.nodes[definition].value;
+
+            source << "static inline long long f_" << ast.functions[function] << "(long long p";
+            for (int global : analysis.getFunctionUses(function)->globals)
+            {
+                source << ", long long v_" << ast.variables[global];
+            }
+            source << ")";
+
+            // The first pass writes the prototypes, so functions can call functions defined after them
+            if (pass == 0)
+            {
+                source << ";" << std::endl;
+                continue;
+            }
+
+            source << std::endl << "{" << std::endl << "    return ";
+            writeExpression(ast, ast.getChild(definition, 1), ast.nodes[ast.getChild(definition, 0)].value, analysis, source);
+            source << ";" << std::endl << "}" << std::endl;
+        }
+        source << std::endl;
+    }
+
+    // The globals become locals of the program function
+    std::set<std::string> globals;
+    for (int i = 0; i < root.childCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+        if (ast.nodes[statement].type == NodeType::operation_assign
+            || ast.nodes[statement].type == NodeType::operation_read)
+        {
+            globals.insert(ast.variables[ast.nodes[ast.getChild(statement, 0)].value]);
+        }
+    }
+
+    source << "EXPORT int run_program(void)" << std::endl << "{" << std::endl;
+    for (const std::string& global : globals)
+    {
+        source << "    long long v_" << global << " = 0;" << std::endl;
+    }
+
+    bool hasRead = false;
+    for (int i = 0; i < root.childCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+        switch (ast.nodes[statement].type)
+        {
+        case NodeType::operation_assign:
+            source << "    v_" << ast.variables[ast.nodes[ast.getChild(statement, 0)].value] << " = ";
+            writeExpression(ast, ast.getChild(statement, 1), -1, analysis, source);
+            source << ";" << std::endl;
+            break;
+        case NodeType::operation_read:
+            source << "    if (read_number(&v_" << ast.variables[ast.nodes[ast.getChild(statement, 0)].value] << ")) goto invalid_input;" << std::endl;
+            hasRead = true;
+            break;
+        case NodeType::operation_print:
+            source << "    printf(\"%lld\\n\", ";
+            writeExpression(ast, ast.getChild(statement, 0), -1, analysis, source);
+            source << ");" << std::endl;
+            break;
+        default:
+            break;
+        }
+    }
+
+    source << "    return 0;" << std::endl;
+    if (hasRead)
+    {
+        source << "invalid_input:" << std::endl;
+        source << "    printf(\"Invalid number is entered\\n\");" << std::endl;
+        source << "    return 0;" << std::endl;
+    }
+    source << "}" << std::endl << std::endl;
+
+    source << "#ifndef TRANSPILED_LIBRARY" << std::endl;
+    source << "int main(void)" << std::endl << "{" << std::endl << "    return run_program();" << std::endl << "}" << std::endl;
+    source << "#endif" << std::endl;
+
+    return source.str();
+}
+
+void Transpiler::build(const std::string& source, const std::string& outputPath, bool isSharedLibrary)
+{
+    std::string sourcePath = outputPath + ".c";
+
+    std::ofstream sourceFile(sourcePath);
+    if (!sourceFile.is_open())
+    {
+        throw std::runtime_error("Couldn't open file for writing");
+    }
+    sourceFile << source;
+    sourceFile.close();
+
+    const char* compilerVariable = std::getenv("CC");
+
+#ifdef _WIN32
+    std::string compiler = compilerVariable != nullptr ? compilerVariable : "cl";
+    std::string command = compiler + " /nologo /O2 /TC \"" + sourcePath + "\" /Fe\"" + outputPath + "\"";
+    if (isSharedLibrary)
+    {
+        command += " /LD /DTRANSPILED_LIBRARY";
+    }
+#else
+    std::string compiler = compilerVariable != nullptr ? compilerVariable : "cc";
+    std::string command = compiler + " -O2 -fwrapv -o \"" + outputPath + "\" \"" + sourcePath + "\"";
+    if (isSharedLibrary)
+    {
+        command += " -shared -fPIC -DTRANSPILED_LIBRARY";
+    }
+#endif
+
+    int exitCode = std::system(command.c_str());
+    if (exitCode != 0)
+    {
+        throw std::runtime_error("The C compiler failed with exit code " + std::to_string(exitCode));
+    }
+}
+
+void Transpiler::writeExpression(const Ast& ast, int expression, long long parameter, UsageAnalysis& analysis, std::ostream& out)
+{
+    // The expression is written in order with an iterative dfs,
+    // the stack contains either a node or a text that has to be written (when the node is -1)
+    std::vector<std::pair<int, std::string>> writeStack;
+    writeStack.push_back(std::pair<int, std::string>(expression, ""));
+
+    while (!writeStack.empty())
+    {
+        std::pair<int, std::string> item = writeStack.back();
+        writeStack.pop_back();
+
+        if (item.first < 0)
+        {
+            out << item.second;
+            continue;
+        }
+
+        const AstNode& currNode = ast.nodes[item.first];
+        switch (currNode.type)
+        {
+        case NodeType::number:
+            writeNumber(currNode.value, out);
+            break;
+        case NodeType::variable:
+            out << (currNode.value == parameter ? "p" : "v_" + ast.variables[currNode.value]);
+            break;
+        case NodeType::function:
+        {
+            // The globals the function uses are passed after the argument
+            std::string closingText;
+            for (int global : analysis.getFunctionUses((int)currNode.value)->globals)
+            {
+                closingText += ", v_" + ast.variables[global];
+            }
+            closingText += ")";
+
+            out << "f_" << ast.functions[currNode.value] << "(";
+            writeStack.push_back(std::pair<int, std::string>(-1, closingText));
+            writeStack.push_back(std::pair<int, std::string>(ast.getChild(item.first, 0), ""));
+        }
+        break;
+        default:
+        {
+            std::string operation = " + ";
+            switch (currNode.type)
+            {
+            case NodeType::operation_subtract: operation = " - "; break;
+            case NodeType::operation_multipy: operation = " * "; break;
+            case NodeType::operation_divide: operation = " / "; break;
+            case NodeType::operation_modulo: operation = " % "; break;
+            default: break;
+            }
+
+            out << "(";
+            writeStack.push_back(std::pair<int, std::string>(-1, ")"));
+            writeStack.push_back(std::pair<int, std::string>(ast.getChild(item.first, 1), ""));
+            writeStack.push_back(std::pair<int, std::string>(-1, operation));
+            writeStack.push_back(std::pair<int, std::string>(ast.getChild(item.first, 0), ""));
+        }
+        break;
+        }
+    }
+}
+
+void Transpiler::writeNumber(long long value, std::ostream& out)
+{
+    // The smallest value can't be written as a negated literal
+    if (value == LLONG_MIN)
+    {
+        out << "(-9223372036854775807LL - 1)";
+    }
+    else if (value < 0)
+    {
+        out << "(" << value << "LL)";
+    }
+    else
+    {
+        out << value << "LL";
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Node.h"
+#include "Ast.h"
+#include "UsageAnalysis.h"
+#include <ostream>
+#include <string>
+
+/// @brief Class with methods that translate an AST to C and build it with the system compiler
+class Transpiler
+{
+public:
+    /// @brief Translates the AST to a standalone C translation unit
+    /// (the program must not be able to fail with a runtime error other than invalid input)
+    /// @param treeRoot The root node of the AST
+    /// @return The C source code
+    static std::string transpile(const Node& treeRoot);
+
+    /// @brief Translates the arena AST to a standalone C translation unit
+    /// (the program must not be able to fail with a runtime error other than invalid input)
+    /// @param ast The arena AST
+    /// @return The C source code
+    static std::string transpile(const Ast& ast);
+
+    /// @brief Builds C source code with the system compiler (the CC environment variable overrides the compiler)
+    /// @param source The C source code
+    /// @param outputPath The path of the built file (the source is saved next to it with a .c extension)
+    /// @param isSharedLibrary True to build a shared library exporting run_program, false to build an executable
+    static void build(const std::string& source, const std::string& outputPath, bool isSharedLibrary);
+
+private:
+    /// @brief Writes the C code of an expression
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param analysis The usage analysis with the globals the functions receive
+    /// @param out The stream the code is written to
+    static void writeExpression(const Ast& ast, int expression, long long parameter, UsageAnalysis& analysis, std::ostream& out);
+
+    /// @brief Writes a number as a C constant
+    /// @param value The number
+    /// @param out The stream the code is written to
+    static void writeNumber(long long value, std::ostream& out);
+};
@@ -0,0 +1,218 @@
+#include "UsageAnalysis.h"
+
+#include <algorithm>
+
+UsageAnalysis::UsageAnalysis(const Ast& ast)
+    : ast(&ast), definitions(ast.functions.size(), -1), functionUses(ast.functions.size()),
+    functionStates(ast.functions.size(), 0), globalMarks(ast.variables.size(), -1)
+{
+    const AstNode& root = ast.nodes[ast.root];
+    for (int i = 0; i < root.childCount; i++)
+    {
+        int statement = ast.getChild(ast.root, i);
+        const AstNode& statementNode = ast.nodes[statement];
+
+        if (statementNode.type == NodeType::define_function && definitions[statementNode.value] < 0)
+        {
+            definitions[statementNode.value] = statement;
+        }
+    }
+}
+
+bool UsageAnalysis::markUses(int expression, long long parameter, std::vector<char>& usedGlobals, std::vector<char>& usedFunctions)
+{
+    std::vector<int> nodes{ expression };
+    std::vector<int> functionStack;
+    while (!nodes.empty())
+    {
+        int currIndex = nodes.back();
+        const AstNode& currNode = ast->nodes[currIndex];
+        nodes.pop_back();
+
+        if (currNode.type == NodeType::variable && currNode.value != parameter)
+        {
+            usedGlobals[currNode.value] = 1;
+        }
+        else if (currNode.type == NodeType::function)
+        {
+            const Uses* calledFunctionUses = getFunctionUses((int)currNode.value);
+            if (calledFunctionUses == nullptr)
+            {
+                return false;
+            }
+
+            for (int global : calledFunctionUses->globals)
+            {
+                usedGlobals[global] = 1;
+            }
+
+            // The globals of the called functions are already in the uses, only the functions are marked through the call graph
+            functionStack.push_back((int)currNode.value);
+            while (!functionStack.empty())
+            {
+                int function = functionStack.back();
+                functionStack.pop_back();
+
+                if (!usedFunctions[function])
+                {
+                    usedFunctions[function] = 1;
+                    functionStack.insert(functionStack.end(), functionUses[function].functions.begin(), functionUses[function].functions.end());
+                }
+            }
+        }
+
+        for (int i = 0; i < currNode.childCount; i++)
+        {
+            nodes.push_back(ast->getChild(currIndex, i));
+        }
+    }
+
+    return true;
+}
+
+const Uses* UsageAnalysis::getFunctionUses(int function)
+{
+    if (functionStates[function] == 0 && getDefinition(function) >= 0)
+    {
+        computeFunctionUses(function);
+    }
+
+    return functionStates[function] == 2 ? &functionUses[function] : nullptr;
+}
+
+int UsageAnalysis::getDefinition(int function) const
+{
+    return definitions[function];
+}
+
+void UsageAnalysis::computeFunctionUses(int function)
+{
+    // The functions on the stack with the number of their visited callees
+    std::vector<std::pair<int, int>> dfsStack;
+    auto push = [&](int pushedFunction)
+    {
+        int definition = getDefinition(pushedFunction);
+        long long parameter = ast->nodes[ast->getChild(definition, 0)].value;
+        Uses& uses = functionUses[pushedFunction];
+
+        // The body adds the globals it reads and the functions it calls
+        std::vector<int> nodes{ ast->getChild(definition, 1) };
+        while (!nodes.empty())
+        {
+            int currIndex = nodes.back();
+            const AstNode& currNode = ast->nodes[currIndex];
+            nodes.pop_back();
+
+            if (currNode.type == NodeType::variable && currNode.value != parameter)
+            {
+                uses.globals.push_back((int)currNode.value);
+            }
+            else if (currNode.type == NodeType::function)
+            {
+                uses.functions.push_back((int)currNode.value);
+            }
+
+            for (int i = 0; i < currNode.childCount; i++)
+            {
+                nodes.push_back(ast->getChild(currIndex, i));
+            }
+        }
+        std::sort(uses.functions.begin(), uses.functions.end());
+        uses.functions.erase(std::unique(uses.functions.begin(), uses.functions.end()), uses.functions.end());
+
+        functionStates[pushedFunction] = 1;
+        dfsStack.push_back(std::pair<int, int>(pushedFunction, 0));
+    };
+
+    push(function);
+    while (!dfsStack.empty())
+    {
+        int currFunction = dfsStack.back().first;
+        Uses& uses = functionUses[currFunction];
+
+        if (dfsStack.back().second < (int)uses.functions.size())
+        {
+            int calledFunction = uses.functions[dfsStack.back().second++];
+            if (functionStates[calledFunction] == 0 && getDefinition(calledFunction) >= 0)
+            {
+                push(calledFunction);
+            }
+            continue;
+        }
+        dfsStack.pop_back();
+
+        // A function is invalid if it calls a function that is not defined, invalid or still on the stack (a recursion)
+        bool isValid = true;
+        for (int calledFunction : uses.functions)
+        {
+            isValid = isValid && functionStates[calledFunction] == 2;
+        }
+        if (!isValid)
+        {
+            functionStates[currFunction] = 3;
+            continue;
+        }
+
+        // The called functions are finished, so their globals are merged without walking their bodies again
+        std::vector<int> globals;
+        for (int global : uses.globals)
+        {
+            if (globalMarks[global] != currFunction)
+            {
+                globalMarks[global] = currFunction;
+                globals.push_back(global);
+            }
+        }
+        for (int calledFunction : uses.functions)
+        {
+            for (int global : functionUses[calledFunction].globals)
+            {
+                if (globalMarks[global] != currFunction)
+                {
+                    globalMarks[global] = currFunction;
+                    globals.push_back(global);
+                }
+            }
+        }
+        std::sort(globals.begin(), globals.end());
+
+        uses.globals.swap(globals);
+        functionStates[currFunction] = 2;
+    }
+}
+
+bool UsageAnalysis::canFail(const Ast& ast, int expression, long long parameter, const std::vector<char>& definedGlobals,
+    const std::vector<char>& safeFunctions)
+{
+    for (int node : ast.getPostOrder(expression))
+    {
+        if (canNodeFail(ast, node, parameter, definedGlobals, safeFunctions))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool UsageAnalysis::canNodeFail(const Ast& ast, int node, long long parameter, const std::vector<char>& definedGlobals,
+    const std::vector<char>& safeFunctions)
+{
+    const AstNode& currNode = ast.nodes[node];
+    switch (currNode.type)
+    {
+    case NodeType::variable:
+        return currNode.value != parameter && !definedGlobals[currNode.value];
+    case NodeType::function:
+        return currNode.value >= safeFunctions.size() || !safeFunctions[currNode.value];
+    case NodeType::operation_divide:
+    case NodeType::operation_modulo:
+    {
+        // Division by zero and LLONG_MIN / -1 trap
+        const AstNode& divisor = ast.nodes[ast.getChild(node, 1)];
+        return divisor.type != NodeType::number || divisor.value == 0 || divisor.value == -1;
+    }
+    default:
+        return false;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Ast.h"
+#include <vector>
+
+/// @brief Global variables and functions used by a function
+class Uses
+{
+public:
+    /// @brief Symbol ids of the used global variables, including the ones used by the called functions (sorted)
+    std::vector<int> globals;
+    /// @brief Symbol ids of the functions called directly by the body (sorted)
+    std::vector<int> functions;
+};
+
+/// @brief Class that finds the global variables and functions used by expressions,
+/// including the ones used by the functions they call
+class UsageAnalysis
+{
+public:
+    /// @brief Constructor for creating the analysis of a program (the AST must outlive the analysis)
+    /// @param ast The arena AST
+    UsageAnalysis(const Ast& ast);
+
+    /// @brief Marks the globals and functions used by an expression, including the ones used by the functions it calls
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param usedGlobals Flags showing which globals are used
+    /// @param usedFunctions Flags showing which functions are used (the functions called by a marked function are already marked, so they aren't visited again)
+    /// @return False if a called function is not defined or there is recursion, otherwise true
+    bool markUses(int expression, long long parameter, std::vector<char>& usedGlobals, std::vector<char>& usedFunctions);
+
+    /// @brief Gets the uses of a function (they are computed once per function)
+    /// @param function The function symbol id
+    /// @return The uses of the function; null if it is not defined or it is recursive
+    const Uses* getFunctionUses(int function);
+
+    /// @brief Gets the definition of a function (the first one if it is defined more than once)
+    /// @param function The function symbol id
+    /// @return The index of the definition node; -1 if the function is not defined
+    int getDefinition(int function) const;
+
+    /// @brief Checks if an expression can fail with a runtime error
+    /// @param ast The arena AST
+    /// @param expression The index of the root node of the expression
+    /// @param parameter The symbol id of the parameter of the function the expression is in (-1 for the main program)
+    /// @param definedGlobals Flags showing which globals are surely assigned when the expression is computed
+    /// @param safeFunctions Flags showing which functions are surely defined and can't fail (the other calls can fail)
+    /// @return True if the expression uses a global that may be undefined, calls a function that may fail
+    /// or divides by a value that may trap, otherwise false
+    static bool canFail(const Ast& ast, int expression, long long parameter, const std::vector<char>& definedGlobals,
+        const std::vector<char>& safeFunctions);
+
+    /// @brief Checks if a node itself can fail with a runtime error (without its children),
+    /// so the passes can compute the errors of all subexpressions bottom-up
+    /// @param ast The arena AST
+    /// @param node The node index
+    /// @param parameter The symbol id of the parameter of the function the node is in (-1 for the main program)
+    /// @param definedGlobals Flags showing which globals are surely assigned when the node is computed
+    /// @param safeFunctions Flags showing which functions are surely defined and can't fail (the other calls can fail)
+    /// @return True if the node is a global that may be undefined, a call of a function that may fail
+    /// or a division by a value that may trap, otherwise false
+    static bool canNodeFail(const Ast& ast, int node, long long parameter, const std::vector<char>& definedGlobals,
+        const std::vector<char>& safeFunctions);
+
+private:
+    /// @brief Computes the uses of a function and of the functions it calls that aren't computed yet in the post order of an iterative dfs,
+    /// so every function merges the finished uses of its callees and every function is computed once
+    /// @param function The function symbol id
+    void computeFunctionUses(int function);
+
+    /// @brief The analyzed AST
+    const Ast* ast;
+    /// @brief The definition node of every function (-1 if it is not defined)
+    std::vector<int> definitions;
+    /// @brief The already computed uses of the functions
+    std::vector<Uses> functionUses;
+    /// @brief State of every function (0 - not computed, 1 - computed currently (used to find recursion), 2 - computed, 3 - invalid)
+    std::vector<char> functionStates;
+    /// @brief The function whose uses last got every global, so the merged globals have no duplicates
+    std::vector<int> globalMarks;
+};
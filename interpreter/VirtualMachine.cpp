@@ -0,0 +1,147 @@
+#include "VirtualMachine.h"
+#include "Executor.h"
+
+#include <stdexcept>
+
+void VirtualMachine::execute(const Bytecode& bytecode)
+{
+    execute(bytecode, std::cout, std::cin);
+}
+
+void VirtualMachine::execute(const Bytecode& bytecode, std::ostream& out, std::istream& in)
+{
+    // The global variables are stored in a flat array indexed by their slot,
+    // together with flags showing which of them are already assigned
+    std::vector<long long> globals(bytecode.globals.size(), 0);
+    std::vector<char> definedGlobals(bytecode.globals.size(), 0);
+    std::vector<char> definedFunctions(bytecode.functions.size(), 0);
+
+    // Value stack (the space needed for every expression is known from the compilation,
+    // so the capacity is checked only when a function is called)
+    std::vector<long long> valueStack(bytecode.maxStackDepth + 1);
+    long long* stackTop = valueStack.data();
+    long long* stackEnd = valueStack.data() + valueStack.size();
+
+    // Call stack with the return address and the parameter of the caller
+    std::vector<std::pair<int, long long>> callStack;
+    long long parameter = 0;
+
+    const Instruction* instructions = bytecode.instructions.data();
+    const long long* constants = bytecode.constants.data();
+    const DivisionByConstant* divisors = bytecode.divisors.data();
+
+    // The output is flushed only before a division that can trap, so the values printed before a crash are not lost
+    bool isOutputPending = false;
+
+    int instructionIndex = 0;
+    while (true)
+    {
+        const Instruction& instruction = instructions[instructionIndex++];
+
+        switch (instruction.code)
+        {
+        case OpCode::push_constant:
+            *stackTop++ = constants[instruction.operand];
+            break;
+        case OpCode::load_global:
+            if (!definedGlobals[instruction.operand])
+            {
+                throw std::invalid_argument("Use of undefined variable '" + bytecode.globals[instruction.operand] + "'");
+            }
+            // Falls through to the load without the check
+            [[fallthrough]];
+        case OpCode::load_defined_global:
+            *stackTop++ = globals[instruction.operand];
+            break;
+        case OpCode::load_parameter:
+            *stackTop++ = parameter;
+            break;
+        case OpCode::store_global:
+            globals[instruction.operand] = *--stackTop;
+            definedGlobals[instruction.operand] = 1;
+            break;
+        case OpCode::read_global:
+            globals[instruction.operand] = Executor::readNumber(in);
+            definedGlobals[instruction.operand] = 1;
+            break;
+        case OpCode::print:
+            out << *--stackTop << '\n';
+            isOutputPending = true;
+            break;
+        case OpCode::add:
+            stackTop--;
+            stackTop[-1] = stackTop[-1] + stackTop[0];
+            break;
+        case OpCode::subtract:
+            stackTop--;
+            stackTop[-1] = stackTop[-1] - stackTop[0];
+            break;
+        case OpCode::multiply:
+            stackTop--;
+            stackTop[-1] = stackTop[-1] * stackTop[0];
+            break;
+        case OpCode::divide:
+            if (isOutputPending)
+            {
+                out.flush();
+                isOutputPending = false;
+            }
+            stackTop--;
+            stackTop[-1] = stackTop[-1] / stackTop[0];
+            break;
+        case OpCode::modulo:
+            if (isOutputPending)
+            {
+                out.flush();
+                isOutputPending = false;
+            }
+            stackTop--;
+            stackTop[-1] = stackTop[-1] % stackTop[0];
+            break;
+        case OpCode::divide_constant:
+            stackTop[-1] = divisors[instruction.operand].divide(stackTop[-1]);
+            break;
+        case OpCode::modulo_constant:
+            stackTop[-1] = divisors[instruction.operand].modulo(stackTop[-1]);
+            break;
+        case OpCode::define_function:
+            if (definedFunctions[instruction.operand])
+            {
+                throw std::invalid_argument("Function " + bytecode.functions[instruction.operand].name + " already defined!");
+            }
+            definedFunctions[instruction.operand] = 1;
+            break;
+        case OpCode::call:
+            if (!definedFunctions[instruction.operand])
+            {
+                throw std::invalid_argument("Function " + bytecode.functions[instruction.operand].name + " is not defined!");
+            }
+            // Falls through to the call without the check
+            [[fallthrough]];
+        case OpCode::call_defined:
+        {
+            // Make sure the function body has enough space on the value stack
+            if (stackEnd - stackTop <= bytecode.maxStackDepth)
+            {
+                std::ptrdiff_t stackSize = stackTop - valueStack.data();
+                valueStack.resize(valueStack.size() * 2 + bytecode.maxStackDepth);
+                stackTop = valueStack.data() + stackSize;
+                stackEnd = valueStack.data() + valueStack.size();
+            }
+
+            callStack.push_back(std::pair<int, long long>(instructionIndex, parameter));
+            parameter = *--stackTop;
+            instructionIndex = bytecode.functions[instruction.operand].entry;
+        }
+        break;
+        case OpCode::return_value:
+            instructionIndex = callStack.back().first;
+            parameter = callStack.back().second;
+            callStack.pop_back();
+            break;
+        case OpCode::halt:
+            out.flush();
+            return;
+        }
+    }
+}
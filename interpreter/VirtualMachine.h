@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Bytecode.h"
+#include <iostream>
+
+/// @brief Class with methods that execute bytecode
+class VirtualMachine
+{
+public:
+    /// @brief Executes bytecode using the console output and input streams
+    /// @param bytecode The bytecode to execute
+    static void execute(const Bytecode& bytecode);
+
+    /// @brief Executes bytecode using the given output and input streams
+    /// @param bytecode The bytecode to execute
+    /// @param out The output stream
+    /// @param in The input stream
+    static void execute(const Bytecode& bytecode, std::ostream& out, std::istream& in);
+};